@@ -0,0 +1,77 @@
+/**
+ * Per-event cost of BarBuilder as the number of timeframes grows, over a stream of trades and quotes
+ * at about 20k events a second of market time, so bars close throughout the run.
+ *
+ *   g++ -O2 -std=c++17 bench/BarBuilderBench.cpp -o bar_builder_bench
+ */
+
+#include "../common/BarBuilder.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+namespace {
+
+const size_t NUM_EVENTS = 20000000;
+const size_t NUM_INSTRUMENTS = 64;
+
+double NowSeconds() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+uint64_t NextRandom(uint64_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+}
+
+int main() {
+    // 100ms, 1s, 10s, 60s, then longer frames to fill the builder
+    const int64_t intervals[MAX_BAR_INTERVALS] = {
+        100000LL, 1000000LL, 10000000LL, 60000000LL, 300000000LL, 600000000LL, 1800000000LL, 3600000000LL};
+
+    printf("%10s %12s %12s\n", "intervals", "ns/event", "bars");
+    for (int k = 1; k <= MAX_BAR_INTERVALS; k *= 2) {
+        BarBuilder builder;
+        for (int i = 0; i < k; ++i) {
+            builder.AddInterval(intervals[i]);
+        }
+        builder.Reset(NUM_INSTRUMENTS);
+
+        unsigned long long bars = 0;
+        double vwap_sum = 0;
+        auto on_close = [&bars, &vwap_sum](int, int, const LocalBar& bar) {
+            ++bars;
+            vwap_sum += bar.vwap();
+        };
+
+        uint64_t rng = 88172645463325252ULL;
+        int64_t now = 0;
+        double start = NowSeconds();
+        for (size_t e = 0; e < NUM_EVENTS; ++e) {
+            uint64_t r = NextRandom(&rng);
+            int index = static_cast<int>(r % NUM_INSTRUMENTS);
+            double price = 100.0 + ((r >> 16) % 200) * 0.01;
+            now += 50;
+            if ((r >> 40) % 10 < 3) {
+                builder.OnTrade(index, now, price, 100, on_close);
+            } else {
+                builder.OnQuote(index, now, price, on_close);
+            }
+        }
+        builder.Flush(on_close);
+        double elapsed = NowSeconds() - start;
+
+        printf("%10d %12.2f %12llu\n", k, elapsed * 1e9 / NUM_EVENTS, bars);
+        if (vwap_sum < 0) {
+            printf("unreachable\n");
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,116 @@
+/**
+ * Cost of the signed volume book sums read on each quote: captured from the book and summed every time, versus
+ * kept current by BookFeatureEngine from the depth deltas. The stream is level updates at random depths on books
+ * 16 levels a side, with a quote read after every update or after every fourth; both paths must produce the same
+ * sums bit for bit. The engine pays a little on every update to make the read cheap, so it wins as depth and quote
+ * rate grow.
+ *
+ *   g++ -O2 -std=c++17 -Ireplay/sdk bench/BookFeaturesBench.cpp -o book_features_bench
+ */
+
+#include "../signed_volume_strategy/BookFeatures.h"
+
+#include <MarketModels/Instrument.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <vector>
+
+using MarketModels::AggrOrderBook;
+
+namespace {
+
+const size_t NUM_INSTRUMENTS = 64;
+const size_t NUM_UPDATES = 8000000;
+
+double NowSeconds() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+uint64_t NextRandom(uint64_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+void FillBooks(std::vector<AggrOrderBook>* books) {
+    uint64_t rng = 88172645463325252ULL;
+    for (size_t i = 0; i < books->size(); ++i) {
+        for (int level = 0; level < BOOK_SNAPSHOT_MAX_DEPTH; ++level) {
+            (*books)[i].ApplyDepth(true, MarketModels::DEPTH_UPDATE_TYPE_INSERT, level, 99.99 - 0.01 * level, 1 + NextRandom(&rng) % 900);
+            (*books)[i].ApplyDepth(false, MarketModels::DEPTH_UPDATE_TYPE_INSERT, level, 100.01 + 0.01 * level, 1 + NextRandom(&rng) % 900);
+        }
+    }
+}
+
+/**
+ * Runs the update stream; with engine set the sums come from it, otherwise from a fresh capture. Returns ns per
+ * update including the quote reads, and a checksum of the depth-weighted prices read.
+ */
+double Run(int depth, size_t updates_per_quote, BookFeatureEngine* engine, double* checksum) {
+    std::vector<AggrOrderBook> books(NUM_INSTRUMENTS);
+    FillBooks(&books);
+    if (engine != NULL) {
+        engine->Reset(NUM_INSTRUMENTS, depth);
+        for (size_t i = 0; i < NUM_INSTRUMENTS; ++i) {
+            engine->OnQuote(static_cast<int>(i), books[i]);
+        }
+    }
+
+    BookSnapshot snapshot;
+    uint64_t rng = 0x2545F4914F6CDD1DULL;
+    double sum = 0;
+    double start = NowSeconds();
+    for (size_t n = 0; n < NUM_UPDATES; ++n) {
+        uint64_t r = NextRandom(&rng);
+        int index = static_cast<int>(r % NUM_INSTRUMENTS);
+        bool bid = (r >> 8) & 1;
+        int level = static_cast<int>((r >> 9) % 12);
+        double price = bid ? 99.99 - 0.01 * level : 100.01 + 0.01 * level;
+        int size = 1 + static_cast<int>((r >> 20) % 900);
+        books[index].ApplyDepth(bid, MarketModels::DEPTH_UPDATE_TYPE_UPDATE, level, price, size);
+        if (engine != NULL) {
+            engine->OnDepth(index, books[index], bid, MarketModels::DEPTH_UPDATE_TYPE_UPDATE, level, price, size);
+        }
+
+        if (n % updates_per_quote == 0) {
+            BookSums sums;
+            if (engine != NULL) {
+                engine->OnQuote(index, books[index]);
+                engine->sums(index, &sums);
+            } else {
+                snapshot.Capture(books[index], depth);
+                sums = SumBookLevels(snapshot);
+            }
+            sum += sums.ask_notional / sums.ask_size - sums.bid_notional / sums.bid_size;
+        }
+    }
+    double elapsed = NowSeconds() - start;
+    *checksum = sum;
+    return elapsed * 1e9 / NUM_UPDATES;
+}
+
+}
+
+int main() {
+    const size_t ratios[] = {1, 4};
+    const int depths[] = {1, 3, 5, 10, 16};
+    for (size_t q = 0; q < sizeof(ratios) / sizeof(ratios[0]); ++q) {
+        printf("%sone quote per %zu depth updates\n", q ? "\n" : "", ratios[q]);
+        printf("%8s %18s %18s %10s %8s\n", "depth", "capture ns/update", "engine ns/update", "speedup", "match");
+        for (size_t d = 0; d < sizeof(depths) / sizeof(depths[0]); ++d) {
+            BookFeatureEngine engine;
+            double capture_sum = 0, engine_sum = 0;
+            double capture_ns = Run(depths[d], ratios[q], NULL, &capture_sum);
+            double engine_ns = Run(depths[d], ratios[q], &engine, &engine_sum);
+            bool match = (capture_sum == engine_sum);
+            printf("%8d %18.2f %18.2f %9.2fx %8s\n", depths[d], capture_ns, engine_ns, capture_ns / engine_ns, match ? "yes" : "NO");
+        }
+    }
+    return 0;
+}
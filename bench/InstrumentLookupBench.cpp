@@ -0,0 +1,128 @@
+/**
+ * Per-event instrument state lookup cost versus universe size.
+ *
+ * Compares the lookups SignedVolumeTrade used to make on every OnTrade/OnQuote (three SymbolTag-keyed std::maps
+ * and two pointer-keyed boost::unordered_maps) with a single InstrumentIndex probe into a dense state table.
+ *
+ *   g++ -O2 -std=c++17 -Ireplay/sdk bench/InstrumentLookupBench.cpp -o instrument_lookup_bench
+ */
+
+#include "../common/InstrumentIndex.h"
+
+#include <MarketModels/Instrument.h>
+#include <boost/unordered_map.hpp>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <deque>
+#include <map>
+#include <sstream>
+#include <vector>
+
+using namespace RCM::StrategyStudio;
+using MarketModels::Instrument;
+
+namespace {
+
+const size_t NUM_EVENTS = 4000000;
+
+struct alignas(64) DenseState {
+    const Instrument* instrument;
+    unsigned long long order_id;
+    double last_trade_price;
+    int desired_size;
+};
+
+double NowSeconds() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// xorshift so the event order is random but identical for both layouts
+uint64_t NextRandom(uint64_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+}
+
+int main() {
+    const size_t universe_sizes[] = {1000, 2000, 5000, 10000};
+
+    printf("%10s %16s %16s\n", "symbols", "maps ns/event", "dense ns/event");
+    for (size_t u = 0; u < sizeof(universe_sizes) / sizeof(universe_sizes[0]); ++u) {
+        size_t n = universe_sizes[u];
+
+        std::deque<Instrument> instruments;
+        for (size_t i = 0; i < n; ++i) {
+            std::ostringstream ss;
+            ss << "SYM" << i;
+            instruments.push_back(Instrument(ss.str()));
+        }
+
+        std::vector<const Instrument*> events(NUM_EVENTS);
+        uint64_t rng = 88172645463325252ULL;
+        for (size_t i = 0; i < NUM_EVENTS; ++i) {
+            events[i] = &instruments[NextRandom(&rng) % n];
+        }
+
+        // the layout being replaced
+        std::map<const SymbolTag, const Instrument*> instrument_map;
+        std::map<const SymbolTag, double> price_map;
+        std::map<const SymbolTag, int> size_map;
+        boost::unordered_map<const Instrument*, double> volume_map;
+        boost::unordered_map<const Instrument*, unsigned long long> order_id_map;
+
+        // the dense table
+        std::vector<DenseState> states(n);
+        InstrumentIndex index;
+        index.Reset(n);
+
+        for (size_t i = 0; i < n; ++i) {
+            const Instrument* inst = &instruments[i];
+            instrument_map[inst->symbol()] = inst;
+            price_map[inst->symbol()] = 0;
+            size_map[inst->symbol()] = 0;
+            volume_map[inst] = 0;
+            order_id_map[inst] = 0;
+
+            states[i].instrument = inst;
+            states[i].order_id = 0;
+            states[i].last_trade_price = 0;
+            states[i].desired_size = 0;
+            index.Insert(inst, static_cast<int>(i));
+        }
+
+        double sink = 0;
+
+        double start = NowSeconds();
+        for (size_t i = 0; i < NUM_EVENTS; ++i) {
+            const Instrument* inst = events[i];
+            const SymbolTag& symbol = inst->symbol();
+            price_map[symbol] = static_cast<double>(i);
+            sink += instrument_map[symbol]->top_quote().bid();
+            sink += volume_map.find(inst)->second;
+            sink += size_map[symbol];
+            order_id_map[inst] = i;
+        }
+        double maps_ns = (NowSeconds() - start) * 1e9 / NUM_EVENTS;
+
+        start = NowSeconds();
+        for (size_t i = 0; i < NUM_EVENTS; ++i) {
+            DenseState& state = states[index.Find(events[i])];
+            state.last_trade_price = static_cast<double>(i);
+            sink += state.instrument->top_quote().bid();
+            sink += state.desired_size;
+            state.order_id = i;
+        }
+        double dense_ns = (NowSeconds() - start) * 1e9 / NUM_EVENTS;
+
+        printf("%10zu %16.1f %16.1f%s\n", n, maps_ns, dense_ns, sink == -1 ? " " : "");
+    }
+    return 0;
+}
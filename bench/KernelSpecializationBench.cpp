@@ -0,0 +1,128 @@
+/**
+ * Compile-time specialized strategy kernels versus the generic runtime path.
+ *
+ * SignedVolumeTrade's per-quote signal core (book capture, weighted sums, rolling window) is timed through the
+ * generic kernel and through the FixedSignalKernel for the same depth and window, over a universe of books with
+ * 16 levels a side. LevArbStrategy's bar evaluation is timed through the full-width LegBasket::Evaluate and the
+ * evaluator SelectEvaluator picks for the basket. Both paths must produce the same signals; the bench checks.
+ *
+ *   g++ -O2 -std=c++17 -Ireplay/sdk bench/KernelSpecializationBench.cpp -o kernel_specialization_bench
+ */
+
+#include "../signed_volume_strategy/SignalKernel.h"
+#include "../leverage_arbitrage/LegBasket.h"
+
+#include <MarketModels/Instrument.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <memory>
+#include <sstream>
+#include <vector>
+
+using namespace RCM::StrategyStudio;
+using MarketModels::AggrOrderBook;
+
+namespace {
+
+const size_t NUM_INSTRUMENTS = 256;
+const size_t NUM_QUOTES = 4000000;
+const size_t NUM_BARS = 20000000;
+
+double NowSeconds() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+uint64_t NextRandom(uint64_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+/**
+ * Runs NUM_QUOTES quotes over random instruments; returns ns per quote and a checksum of the sides
+ */
+double TimeSignalKernel(ISignalKernel* kernel, const std::vector<AggrOrderBook>& books, long long* checksum) {
+    uint64_t rng = 0x9E3779B97F4A7C15ULL;
+    long long sum = 0;
+    double start = NowSeconds();
+    for (size_t n = 0; n < NUM_QUOTES; ++n) {
+        int index = static_cast<int>(NextRandom(&rng) % books.size());
+        double last = 100.0 + (NextRandom(&rng) % 5) * 0.01;
+        DesiredPositionSide side;
+        if (kernel->OnQuote(index, books[index], last, 1.0, &side)) {
+            sum = sum * 3 + side;
+        }
+    }
+    double elapsed = NowSeconds() - start;
+    *checksum = sum;
+    return elapsed * 1e9 / NUM_QUOTES;
+}
+
+double TimeEvaluator(LegBasket basket, LegBasketEvaluator evaluate, double* checksum) {
+    uint64_t rng = 0x2545F4914F6CDD1DULL;
+    double sum = 0;
+    double start = NowSeconds();
+    for (size_t n = 0; n < NUM_BARS; ++n) {
+        for (int leg = 0; leg < basket.num_legs; ++leg) {
+            basket.close[leg] = 100.0 + (NextRandom(&rng) % 64) * 0.01;
+        }
+        (basket.*evaluate)(3, 1.001);
+        sum += basket.desired[basket.num_legs - 1];
+    }
+    double elapsed = NowSeconds() - start;
+    *checksum = sum;
+    return elapsed * 1e9 / NUM_BARS;
+}
+
+}
+
+int main() {
+    // every book has 16 levels a side with random sizes around a 100.00 mid
+    uint64_t rng = 88172645463325252ULL;
+    std::vector<AggrOrderBook> books(NUM_INSTRUMENTS);
+    for (size_t i = 0; i < books.size(); ++i) {
+        for (int level = 0; level < BOOK_SNAPSHOT_MAX_DEPTH; ++level) {
+            books[i].ApplyDepth(true, MarketModels::DEPTH_UPDATE_TYPE_INSERT, level, 99.99 - 0.01 * level, 1 + NextRandom(&rng) % 900);
+            books[i].ApplyDepth(false, MarketModels::DEPTH_UPDATE_TYPE_INSERT, level, 100.01 + 0.01 * level, 1 + NextRandom(&rng) % 900);
+        }
+    }
+
+    printf("SignedVolumeTrade signal kernel, %zu instruments\n", NUM_INSTRUMENTS);
+    printf("%8s %8s %16s %16s %10s %8s\n", "depth", "window", "generic ns/quote", "fixed ns/quote", "speedup", "match");
+    const int configs[][2] = {{1, 20}, {3, 20}, {3, 200}, {5, 100}, {10, 20}, {10, 200}};
+    for (size_t c = 0; c < sizeof(configs) / sizeof(configs[0]); ++c) {
+        int depth = configs[c][0];
+        int window = configs[c][1];
+        std::unique_ptr<ISignalKernel> generic(CreateSignalKernel(NUM_INSTRUMENTS, depth, window, false));
+        std::unique_ptr<ISignalKernel> fixed(CreateSignalKernel(NUM_INSTRUMENTS, depth, window, true));
+        long long generic_sum = 0, fixed_sum = 0;
+        double generic_ns = TimeSignalKernel(generic.get(), books, &generic_sum);
+        double fixed_ns = TimeSignalKernel(fixed.get(), books, &fixed_sum);
+        printf("%8d %8d %16.1f %16.1f %9.2fx %8s\n", depth, window, generic_ns, fixed_ns, generic_ns / fixed_ns,
+            generic_sum == fixed_sum ? "yes" : "NO");
+    }
+
+    printf("\nLevArbStrategy bar evaluation\n");
+    printf("%8s %16s %16s %10s %8s\n", "legs", "generic ns/bar", "fixed ns/bar", "speedup", "match");
+    const double ratios[] = {3, 2, -1, -3, 2, -2, 3};
+    const int leg_counts[] = {2, 4, 8};
+    for (size_t c = 0; c < sizeof(leg_counts) / sizeof(leg_counts[0]); ++c) {
+        LegBasket basket;
+        basket.AddLeg(NULL, 1);
+        for (int leg = 1; leg < leg_counts[c]; ++leg) {
+            basket.AddLeg(NULL, ratios[leg - 1]);
+        }
+        double generic_sum = 0, fixed_sum = 0;
+        double generic_ns = TimeEvaluator(basket, SelectEvaluator(basket, false), &generic_sum);
+        double fixed_ns = TimeEvaluator(basket, SelectEvaluator(basket, true), &fixed_sum);
+        printf("%8d %16.2f %16.2f %9.2fx %8s\n", leg_counts[c], generic_ns, fixed_ns, generic_ns / fixed_ns,
+            generic_sum == fixed_sum ? "yes" : "NO");
+    }
+    return 0;
+}
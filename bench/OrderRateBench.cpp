@@ -0,0 +1,89 @@
+/**
+ * Order messages sent per million market events, with and without SignedVolumeTrade's order coalescing.
+ *
+ * Replays the same synthetic day through the strategy library twice: once with coalesce_orders=false, which sends
+ * a new order on every trade as the strategy always has, and once with the default one-working-order-per-instrument
+ * state machine. Messages are new orders, cancels and cancel-replaces as counted by the simulated exchange.
+ *
+ *   g++ -O2 -fPIC -shared -pthread -Ireplay/sdk signed_volume_strategy/signedVolumeStrategy.cpp -o libSignedVolumeTrade.so
+ *   g++ -O2 -std=c++17 -Ireplay/sdk bench/OrderRateBench.cpp replay/ReplayHost.cpp replay/SimExchange.cpp \
+ *       replay/EventLog.cpp replay/AllocationCounter.cpp -o order_rate_bench -ldl
+ *   ./order_rate_bench ./libSignedVolumeTrade.so [events] [symbols]
+ */
+
+#include "SyntheticTicks.h"
+#include "../replay/ReplayHost.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <exception>
+
+using namespace Replay;
+
+namespace {
+
+struct RunResult {
+    SimExchange::Counters counters;
+    unsigned long long events;
+    double pnl;
+};
+
+RunResult RunOnce(const StrategyLibrary& library, const TickStream& stream, bool coalesce) {
+    ReplayOptions options;
+    options.timing = false;
+    options.date = TimeFromNanos(stream.records.front().timestamp).date();
+    options.params.push_back(std::make_pair(std::string("coalesce_orders"), std::string(coalesce ? "true" : "false")));
+
+    ReplayHost host(library.Create(library.type(), 1, library.type(), "bench"), stream.symbols, options);
+    host.Run(stream.records.data(), stream.records.data() + stream.records.size());
+    host.Finish();
+
+    RunResult result;
+    result.counters = host.exchange().counters();
+    result.events = host.events();
+    result.pnl = host.strategy().portfolio().total_pnl();
+    return result;
+}
+
+void Print(const char* name, const RunResult& r) {
+    printf("%-10s %10llu %10llu %10llu %10llu %10llu %14.0f %12.2f\n", name,
+        r.counters.newOrders, r.counters.cancels, r.counters.replaces, r.counters.messages(), r.counters.fills,
+        r.events ? r.counters.messages() * 1e6 / r.events : 0.0, r.pnl);
+}
+
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: order_rate_bench <libSignedVolumeTrade.so> [events] [symbols]\n");
+        return 2;
+    }
+
+    SyntheticTickSpec spec;
+    if (argc > 2)
+        spec.num_events = strtoul(argv[2], NULL, 10);
+    if (argc > 3)
+        spec.num_symbols = atoi(argv[3]);
+
+    try {
+        StrategyLibrary library(argv[1]);
+        TickStream stream;
+        GenerateSyntheticTicks(spec, &stream);
+
+        printf("%zu events, %d symbols\n\n", stream.records.size(), spec.num_symbols);
+        printf("%-10s %10s %10s %10s %10s %10s %14s %12s\n", "mode", "new", "cancel", "replace", "messages", "fills", "msgs/1M evts", "pnl");
+        RunResult before = RunOnce(library, stream, false);
+        Print("per-trade", before);
+        RunResult after = RunOnce(library, stream, true);
+        Print("coalesced", after);
+
+        if (after.counters.messages() > 0) {
+            printf("\nreduction  %.1fx\n", static_cast<double>(before.counters.messages()) / after.counters.messages());
+        }
+    } catch (const std::exception& e) {
+        fprintf(stderr, "order_rate_bench: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
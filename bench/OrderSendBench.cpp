@@ -0,0 +1,143 @@
+/**
+ * Cost of building one order on the send path: OrderParams rebuilt per call from the instrument's quote
+ * and type, against a prebuilt OrderTemplate that only has price and size patched in. Orders go to a
+ * trade-actions sink that just assigns ids, so what is timed is the construction plus one virtual call.
+ *
+ *   g++ -O2 -std=c++17 -Ireplay/sdk bench/OrderSendBench.cpp -o order_send_bench
+ */
+
+#include "../common/OrderTemplate.h"
+
+#include <Strategy.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <string>
+#include <vector>
+
+namespace {
+
+const size_t NUM_ORDERS = 50000000;
+
+double NowSeconds() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+uint64_t NextRandom(uint64_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+class SinkTradeActions : public ITradeActions {
+public:
+    SinkTradeActions(): m_next_id(1), m_checksum(0) {}
+
+    TradeActionResult SendNewOrder(OrderParams& params) {
+        params.order_id = m_next_id++;
+        m_checksum += params.quantity + params.price + params.market_center + params.order_side + params.order_type;
+        return TRADE_ACTION_RESULT_SUCCESSFUL;
+    }
+    TradeActionResult SendCancelOrder(OrderID) { return TRADE_ACTION_RESULT_SUCCESSFUL; }
+    TradeActionResult SendCancelReplaceOrder(OrderID, const OrderParams&) { return TRADE_ACTION_RESULT_SUCCESSFUL; }
+    TradeActionResult SendCancelAll() { return TRADE_ACTION_RESULT_SUCCESSFUL; }
+
+    double checksum() const { return m_checksum; }
+
+private:
+    OrderID m_next_id;
+    double m_checksum;
+};
+
+// the sink is only reached through this pointer, so the send stays a real virtual call
+ITradeActions* volatile g_trade_actions = NULL;
+
+struct CachedQuote {
+    double bid;
+    double ask;
+};
+
+/**
+ * The send path as the strategies wrote it before templates: quote and venue looked up per order
+ */
+double RunRebuild(const std::vector<MarketModels::Instrument*>& instruments) {
+    ITradeActions* actions = g_trade_actions;
+    uint64_t rng = 88172645463325252ULL;
+    double start = NowSeconds();
+    for (size_t i = 0; i < NUM_ORDERS; ++i) {
+        uint64_t r = NextRandom(&rng);
+        const MarketModels::Instrument* instrument = instruments[r % instruments.size()];
+        int trade_size = static_cast<int>((r >> 32) % 200) - 100;
+        OrderParams params(*instrument,
+            abs(trade_size),
+            trade_size > 0 ? instrument->top_quote().bid() + 0.01 : instrument->top_quote().ask() - 0.01,
+            (instrument->type() == MarketModels::INSTRUMENT_TYPE_EQUITY) ? MARKET_CENTER_ID_NASDAQ :
+                ((instrument->type() == MarketModels::INSTRUMENT_TYPE_OPTION) ? MARKET_CENTER_ID_CBOE_OPTIONS : MARKET_CENTER_ID_CME_GLOBEX),
+            (trade_size > 0) ? ORDER_SIDE_BUY : ORDER_SIDE_SELL,
+            ORDER_TIF_DAY,
+            ORDER_TYPE_LIMIT);
+        actions->SendNewOrder(params);
+    }
+    return NowSeconds() - start;
+}
+
+/**
+ * The send path with a template and quote cached per instrument at registration
+ */
+double RunTemplate(std::vector<OrderTemplate>& templates, const std::vector<CachedQuote>& quotes) {
+    ITradeActions* actions = g_trade_actions;
+    uint64_t rng = 88172645463325252ULL;
+    double start = NowSeconds();
+    for (size_t i = 0; i < NUM_ORDERS; ++i) {
+        uint64_t r = NextRandom(&rng);
+        size_t index = r % templates.size();
+        int trade_size = static_cast<int>((r >> 32) % 200) - 100;
+        const CachedQuote& quote = quotes[index];
+        actions->SendNewOrder(templates[index].Patch(trade_size, trade_size > 0 ? quote.bid + 0.01 : quote.ask - 0.01));
+    }
+    return NowSeconds() - start;
+}
+
+}
+
+int main() {
+    const size_t universe_sizes[] = {2, 64, 1000, 10000};
+    const MarketModels::InstrumentType types[] = {
+        MarketModels::INSTRUMENT_TYPE_EQUITY, MarketModels::INSTRUMENT_TYPE_OPTION, MarketModels::INSTRUMENT_TYPE_FUTURE};
+
+    SinkTradeActions sink;
+    g_trade_actions = &sink;
+
+    printf("%10s %14s %14s %10s\n", "symbols", "rebuild ns", "template ns", "speedup");
+    for (size_t u = 0; u < sizeof(universe_sizes) / sizeof(universe_sizes[0]); ++u) {
+        size_t n = universe_sizes[u];
+
+        std::vector<MarketModels::Instrument*> instruments;
+        std::vector<OrderTemplate> templates(n);
+        std::vector<CachedQuote> quotes(n);
+        for (size_t i = 0; i < n; ++i) {
+            MarketModels::Instrument* instrument = new MarketModels::Instrument("SYM" + std::to_string(i), types[i % 3]);
+            double mid = 50.0 + i % 100;
+            instrument->mutable_top_quote().set(mid - 0.01, 100, mid + 0.01, 100);
+            instruments.push_back(instrument);
+            templates[i].Build(*instrument, ORDER_TYPE_LIMIT);
+            quotes[i].bid = mid - 0.01;
+            quotes[i].ask = mid + 0.01;
+        }
+
+        double rebuild = RunRebuild(instruments);
+        double patched = RunTemplate(templates, quotes);
+        printf("%10zu %14.2f %14.2f %9.2fx\n", n, rebuild * 1e9 / NUM_ORDERS, patched * 1e9 / NUM_ORDERS, rebuild / patched);
+
+        for (size_t i = 0; i < n; ++i) {
+            delete instruments[i];
+        }
+    }
+    printf("checksum %.0f\n", sink.checksum());
+    return 0;
+}
@@ -0,0 +1,157 @@
+/**
+ * Size and read speed of a synthetic day as a text tick file, a flat archive and a packed archive. The flat archive
+ * is read straight from its mapping; the packed one is decoded a block at a time into a reused buffer, which is
+ * what a replay does. Both reads checksum the same fields so the scans cannot be optimized away, and the sums must
+ * agree. Decoding writes every 56 byte record it produces, so it is bounded by store bandwidth as much as by the
+ * varint parsing.
+ *
+ *   g++ -O2 -std=c++17 -Ireplay/sdk bench/PackedTicksBench.cpp replay/TickArchive.cpp replay/PackedTicks.cpp \
+ *       -o packed_ticks_bench
+ *   ./packed_ticks_bench [events] [symbols]
+ */
+
+#include "SyntheticTicks.h"
+#include "../replay/PackedTicks.h"
+#include "../replay/TickArchive.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <exception>
+#include <string>
+#include <vector>
+
+using namespace Replay;
+
+namespace {
+
+const int PASSES = 5;
+
+double NowSeconds() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+size_t FileBytes(const std::string& path) {
+    struct stat st;
+    return (stat(path.c_str(), &st) == 0) ? static_cast<size_t>(st.st_size) : 0;
+}
+
+/**
+ * Bytes the stream takes as a text tick file, formatted the way recorded feeds are
+ */
+size_t TextBytes(const TickStream& stream) {
+    size_t bytes = 0;
+    char line[256];
+    for (size_t i = 0; i < stream.records.size(); ++i) {
+        const TickRecord& r = stream.records[i];
+        const char* symbol = stream.symbols[r.instrument].c_str();
+        long long ts = static_cast<long long>(r.timestamp);
+        if (r.type == TICK_TYPE_TRADE)
+            bytes += snprintf(line, sizeof(line), "T,%lld,%s,%.2f,%u\n", ts, symbol, r.price[0], r.size[0]);
+        else if (r.type == TICK_TYPE_QUOTE)
+            bytes += snprintf(line, sizeof(line), "Q,%lld,%s,%.2f,%u,%.2f,%u\n", ts, symbol, r.price[0], r.size[0], r.price[1], r.size[1]);
+        else
+            bytes += snprintf(line, sizeof(line), "D,%lld,%s,%c,%c,%d,%.2f,%u\n", ts, symbol, r.side, r.action, r.level, r.price[0], r.size[0]);
+    }
+    return bytes;
+}
+
+uint64_t Checksum(const TickRecord* begin, const TickRecord* end) {
+    uint64_t sum = 0;
+    for (const TickRecord* r = begin; r != end; ++r) {
+        uint64_t price;
+        memcpy(&price, &r->price[0], sizeof(price));
+        sum += price ^ r->size[0] ^ r->timestamp;
+    }
+    return sum;
+}
+
+/**
+ * Best events/s over the passes of a scan of the flat archive's mapping
+ */
+double ScanFlat(const TickArchive& archive, uint64_t* checksum) {
+    double best = 0;
+    for (int pass = 0; pass < PASSES; ++pass) {
+        double start = NowSeconds();
+        *checksum = Checksum(archive.begin(), archive.end());
+        double elapsed = NowSeconds() - start;
+        best = std::max(best, (archive.end() - archive.begin()) / elapsed);
+    }
+    return best;
+}
+
+double ScanPacked(const PackedTicks& packed, uint64_t* checksum) {
+    std::vector<TickRecord> batch(PACKED_TICKS_BLOCK_RECORDS);
+    double best = 0;
+    for (int pass = 0; pass < PASSES; ++pass) {
+        double start = NowSeconds();
+        PackedTickDecoder decoder(packed, 0, packed.num_blocks());
+        uint64_t sum = 0;
+        for (size_t n = decoder.Next(&batch[0]); n != 0; n = decoder.Next(&batch[0]))
+            sum += Checksum(&batch[0], &batch[0] + n);
+        double elapsed = NowSeconds() - start;
+        *checksum = sum;
+        best = std::max(best, packed.num_records() / elapsed);
+    }
+    return best;
+}
+
+}
+
+int main(int argc, char** argv) {
+    SyntheticTickSpec spec;
+    spec.num_events = (argc > 1) ? strtoull(argv[1], NULL, 10) : 5000000;
+    spec.num_symbols = (argc > 2) ? atoi(argv[2]) : 4;
+
+    try {
+        TickStream stream;
+        GenerateSyntheticTicks(spec, &stream);
+        // the generator offsets quote and depth prices in floating point; snap them to the cent a recorded feed
+        // would carry
+        for (size_t i = 0; i < stream.records.size(); ++i) {
+            for (int p = 0; p < 2; ++p)
+                stream.records[i].price[p] = llround(stream.records[i].price[p] * 100) / 100.0;
+        }
+
+        std::string flatPath = "/tmp/packed_ticks_bench_" + std::to_string(getpid()) + ".bin";
+        std::string packedPath = "/tmp/packed_ticks_bench_" + std::to_string(getpid()) + ".pk";
+        WriteTickArchive(flatPath, stream);
+        WritePackedTicks(packedPath, stream);
+
+        double n = static_cast<double>(stream.records.size());
+        printf("%zu events, %d symbols\n\n", stream.records.size(), spec.num_symbols);
+        printf("%-8s %14s %14s\n", "format", "bytes", "bytes/event");
+        size_t text = TextBytes(stream);
+        size_t flat = FileBytes(flatPath);
+        size_t packed = FileBytes(packedPath);
+        printf("%-8s %14zu %14.2f\n", "text", text, text / n);
+        printf("%-8s %14zu %14.2f\n", "flat", flat, flat / n);
+        printf("%-8s %14zu %14.2f\n", "packed", packed, packed / n);
+
+        TickArchive archive(flatPath);
+        PackedTicks packedTicks(packedPath);
+        uint64_t flatSum = 0, packedSum = 0;
+        double flatRate = ScanFlat(archive, &flatSum);
+        double packedRate = ScanPacked(packedTicks, &packedSum);
+        printf("\n%-8s %14s %14s\n", "read", "Mevents/s", "GB/s of file");
+        printf("%-8s %14.1f %14.2f\n", "flat", flatRate / 1e6, flatRate * flat / n / 1e9);
+        printf("%-8s %14.1f %14.2f\n", "packed", packedRate / 1e6, packedRate * packed / n / 1e9);
+        printf("\nchecksums %s\n", flatSum == packedSum ? "match" : "DIFFER");
+
+        unlink(flatPath.c_str());
+        unlink(packedPath.c_str());
+        return flatSum == packedSum ? 0 : 1;
+    } catch (const std::exception& e) {
+        fprintf(stderr, "packed_ticks_bench: %s\n", e.what());
+        return 1;
+    }
+}
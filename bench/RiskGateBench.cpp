@@ -0,0 +1,71 @@
+/**
+ * Cost of one RiskGate::Check with every limit enabled, over a universe of instruments with open positions.
+ *
+ *   g++ -O2 -std=c++17 bench/RiskGateBench.cpp -o risk_gate_bench
+ */
+
+#include "../common/RiskGate.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+namespace {
+
+const size_t NUM_CHECKS = 50000000;
+
+double NowSeconds() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+uint64_t NextRandom(uint64_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+}
+
+int main() {
+    const size_t universe_sizes[] = {2, 64, 1000, 10000};
+
+    printf("%10s %12s %12s\n", "symbols", "ns/check", "passed");
+    for (size_t u = 0; u < sizeof(universe_sizes) / sizeof(universe_sizes[0]); ++u) {
+        size_t n = universe_sizes[u];
+
+        RiskLimits limits;
+        limits.max_order_size = 1000;
+        limits.max_instrument_notional = 500000;
+        limits.max_strategy_notional = 5000000;
+        limits.max_orders_per_second = 1000;
+        limits.max_net_exposure = 250000;
+
+        RiskGate gate;
+        gate.set_limits(&limits);
+        gate.Reset(n);
+        uint64_t rng = 88172645463325252ULL;
+        for (size_t i = 0; i < n; ++i) {
+            gate.set_weight(static_cast<int>(i), (i % 2) ? 3 : 1);
+            gate.OnFill(static_cast<int>(i), static_cast<int>(NextRandom(&rng) % 2000) - 1000, 100.0);
+        }
+
+        int64_t now = 0;
+        double start = NowSeconds();
+        for (size_t c = 0; c < NUM_CHECKS; ++c) {
+            int index = static_cast<int>(NextRandom(&rng) % n);
+            int quantity = static_cast<int>(NextRandom(&rng) % 400) - 200;
+            now += 50;
+            gate.set_time(now);
+            if (gate.Check(index, quantity, 100.0) == RISK_CHECK_OK) {
+                gate.OnOrderSent();
+            }
+        }
+        double elapsed = NowSeconds() - start;
+
+        printf("%10zu %12.2f %11.1f%%\n", n, elapsed * 1e9 / NUM_CHECKS, 100.0 * gate.checks(RISK_CHECK_OK) / NUM_CHECKS);
+    }
+    return 0;
+}
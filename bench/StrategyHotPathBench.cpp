@@ -0,0 +1,425 @@
+/**
+ * Hot path suite for both strategies over synthetic days, swept across symbol counts, book depths and window sizes,
+ * with the results as a table and optionally as JSON for tracking regressions between builds.
+ *
+ *   SignedVolume::Update               direct, one signal per symbol, random symbol per update
+ *   SignedVolumeTrade::OnQuote/OnTrade through ReplayHost, timed by the host around each callback
+ *   SignedVolumeTrade::SendOrder       the signal->order stage of the strategy's own latency tracker (p50); this
+ *                                      is where OnTrade sizes and sends, AdjustPortfolio having no callers
+ *   LevArbStrategy::OnBar              through ReplayHost, on the host's 10 second bars
+ *   LevArbStrategy::AdjustPortfolio    the signal->order stage of the strategy's latency tracker (p50)
+ *   <strategy> replay                  the whole run per event: every callback plus the host's book keeping
+ *
+ * ns/op is a mean unless the row says p50; callback means include the host's two clock reads. Allocations per op
+ * are counted by AllocationCounter after the first tenth of the events. Cache misses come from perf_event_open
+ * and are counted over a whole loop, so only the direct and whole-replay rows carry them; where the kernel offers
+ * no hardware counter (as in most VMs) they are null and the JSON says why.
+ *
+ *   g++ -O2 -fPIC -shared -pthread -Ireplay/sdk signed_volume_strategy/signedVolumeStrategy.cpp -o libSignedVolumeTrade.so
+ *   g++ -O2 -fPIC -shared -pthread -Ireplay/sdk leverage_arbitrage/lev_arb.cpp -o libLevArb.so
+ *   g++ -O2 -std=c++17 -Ireplay/sdk bench/StrategyHotPathBench.cpp replay/ReplayHost.cpp replay/SimExchange.cpp \
+ *       replay/EventLog.cpp replay/AllocationCounter.cpp -o strategy_hot_path_bench -ldl
+ *   ./strategy_hot_path_bench ./libSignedVolumeTrade.so ./libLevArb.so [--events n] [--json results.json]
+ */
+
+#include "SyntheticTicks.h"
+#include "../replay/AllocationCounter.h"
+#include "../replay/ReplayHost.h"
+#include "../signed_volume_strategy/SignedVolume.h"
+
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <exception>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace Replay;
+
+namespace {
+
+const size_t NUM_UPDATES = 10000000;
+
+// a sweep value that does not apply to the row
+const int NOT_APPLICABLE = -1;
+
+// where the direct loops leave their results, so the updates cannot be optimized away
+volatile long long g_sink;
+
+double NowSeconds() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * User-space cache misses of the calling thread through perf_event_open; unavailable when the kernel or the
+ * hypervisor does not expose the hardware counter
+ */
+class CacheMissCounter {
+public:
+    CacheMissCounter(): m_fd(-1) {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        m_fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        if (m_fd < 0) {
+            m_error = std::string("perf_event_open: ") + strerror(errno);
+        }
+    }
+
+    ~CacheMissCounter() {
+        if (m_fd >= 0) {
+            close(m_fd);
+        }
+    }
+
+    bool available() const { return m_fd >= 0; }
+    const std::string& error() const { return m_error; }
+
+    void Start() {
+        if (m_fd >= 0) {
+            ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    /**
+     * Misses since Start(), or -1 without a counter
+     */
+    double Stop() {
+        if (m_fd < 0) {
+            return -1;
+        }
+        ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+        uint64_t count = 0;
+        if (read(m_fd, &count, sizeof(count)) != static_cast<ssize_t>(sizeof(count))) {
+            return -1;
+        }
+        return static_cast<double>(count);
+    }
+
+private:
+    CacheMissCounter(const CacheMissCounter&);
+    CacheMissCounter& operator=(const CacheMissCounter&);
+
+    int m_fd;
+    std::string m_error;
+};
+
+/**
+ * One measurement; negative metrics and sweep values are reported as null
+ */
+struct Row {
+    std::string name;
+    int symbols;
+    int depth;
+    int window;
+    unsigned long long ops;
+    const char* stat;
+    double ns_per_op;
+    double allocations_per_op;
+    double cache_misses_per_op;
+};
+
+Row MakeRow(const std::string& name, int symbols, int depth, int window) {
+    Row row;
+    row.name = name;
+    row.symbols = symbols;
+    row.depth = depth;
+    row.window = window;
+    row.ops = 0;
+    row.stat = "mean";
+    row.ns_per_op = -1;
+    row.allocations_per_op = -1;
+    row.cache_misses_per_op = -1;
+    return row;
+}
+
+Row CallbackRow(const std::string& name, int symbols, int depth, int window, const CallbackStats& stats) {
+    Row row = MakeRow(name, symbols, depth, window);
+    row.ops = stats.calls;
+    row.ns_per_op = stats.mean_nanos();
+    row.allocations_per_op = stats.calls ? static_cast<double>(stats.allocations) / stats.calls : 0.0;
+    return row;
+}
+
+/**
+ * The signal->order p50 from a LatencyTracker dump in the strategy's log
+ */
+Row SignalToOrderRow(const std::string& name, int symbols, int depth, int window, const std::string& log) {
+    Row row = MakeRow(name, symbols, depth, window);
+    row.stat = "p50";
+    size_t at = log.rfind("signal->order count ");
+    unsigned long long count = 0;
+    double p50 = 0;
+    if (at != std::string::npos && sscanf(log.c_str() + at, "signal->order count %llu p50 %lf", &count, &p50) == 2) {
+        row.ops = count;
+        row.ns_per_op = count ? p50 : -1;
+    }
+    return row;
+}
+
+void RunSignedVolumeUpdate(int symbols, int window, CacheMissCounter* misses, std::vector<Row>* rows) {
+    std::vector<SignedVolume> signals(symbols, SignedVolume(window));
+    uint64_t rng = 0x2545F4914F6CDD1DULL;
+    long long checksum = 0;
+
+    unsigned long long allocations = ThreadAllocations();
+    misses->Start();
+    double start = NowSeconds();
+    for (size_t n = 0; n < NUM_UPDATES; ++n) {
+        uint64_t r = SyntheticRandom(&rng);
+        double value = static_cast<double>(static_cast<int>(r >> 40) % 2001 - 1000);
+        checksum += signals[r % symbols].Update(value, 1.0);
+    }
+    double elapsed = NowSeconds() - start;
+    double missCount = misses->Stop();
+    allocations = ThreadAllocations() - allocations;
+
+    Row row = MakeRow("SignedVolume::Update", symbols, NOT_APPLICABLE, window);
+    row.ops = NUM_UPDATES;
+    row.ns_per_op = elapsed * 1e9 / NUM_UPDATES;
+    row.allocations_per_op = static_cast<double>(allocations) / NUM_UPDATES;
+    row.cache_misses_per_op = (missCount < 0) ? -1 : missCount / NUM_UPDATES;
+    rows->push_back(row);
+    g_sink = checksum;
+}
+
+/**
+ * Replays the stream through a fresh instance and returns the host's per-callback stats; fills the whole-run row
+ */
+void ReplayStream(const StrategyLibrary& library, const TickStream& stream, const std::vector<std::pair<std::string, std::string> >& params,
+                  int dumpCommand, CacheMissCounter* misses, Row* replayRow, std::vector<CallbackStats>* stats, std::string* log) {
+    std::ostringstream sink;
+    ReplayOptions options;
+    options.date = TimeFromNanos(stream.records.front().timestamp).date();
+    options.params = params;
+    options.log = &sink;
+    options.checkAllocations = true;
+    options.allocationWarmup = stream.records.size() / 10;
+
+    ReplayHost host(library.Create(library.type(), 1, library.type(), "bench"), stream.symbols, options);
+    misses->Start();
+    double start = NowSeconds();
+    host.Run(stream.records.data(), stream.records.data() + stream.records.size());
+    double elapsed = NowSeconds() - start;
+    double missCount = misses->Stop();
+    host.Finish();
+    host.SendCommand(dumpCommand);
+
+    replayRow->ops = host.events();
+    replayRow->ns_per_op = host.events() ? elapsed * 1e9 / host.events() : -1;
+    replayRow->allocations_per_op = host.events() ? static_cast<double>(host.hot_allocations()) / host.events() : 0.0;
+    replayRow->cache_misses_per_op = (missCount < 0 || host.events() == 0) ? -1 : missCount / host.events();
+
+    stats->clear();
+    for (int i = 0; i < NUM_CALLBACKS; ++i) {
+        stats->push_back(host.stats(static_cast<Callback>(i)));
+    }
+    *log = sink.str();
+}
+
+void RunSignedVolumeTrade(const StrategyLibrary& library, size_t events, int symbols, int depth, int window,
+                          CacheMissCounter* misses, std::vector<Row>* rows) {
+    SyntheticTickSpec spec;
+    spec.num_events = events;
+    spec.num_symbols = symbols;
+    spec.depth = depth;
+    TickStream stream;
+    GenerateSyntheticTicks(spec, &stream);
+
+    std::vector<std::pair<std::string, std::string> > params;
+    params.push_back(std::make_pair(std::string("book_depth"), std::to_string(depth)));
+    params.push_back(std::make_pair(std::string("super_long_window_size"), std::to_string(window)));
+
+    Row replay = MakeRow("SignedVolumeTrade replay", symbols, depth, window);
+    std::vector<CallbackStats> stats;
+    std::string log;
+    ReplayStream(library, stream, params, 3, misses, &replay, &stats, &log);
+
+    rows->push_back(CallbackRow("SignedVolumeTrade::OnQuote", symbols, depth, window, stats[CALLBACK_QUOTE]));
+    rows->push_back(CallbackRow("SignedVolumeTrade::OnTrade", symbols, depth, window, stats[CALLBACK_TRADE]));
+    rows->push_back(SignalToOrderRow("SignedVolumeTrade::SendOrder", symbols, depth, window, log));
+    rows->push_back(replay);
+}
+
+void RunLevArb(const StrategyLibrary& library, size_t events, int symbols, int halflife, CacheMissCounter* misses, std::vector<Row>* rows) {
+    SyntheticTickSpec spec;
+    spec.num_events = events;
+    spec.num_symbols = symbols;
+    TickStream stream;
+    GenerateSyntheticTicks(spec, &stream);
+
+    std::vector<std::pair<std::string, std::string> > params;
+    params.push_back(std::make_pair(std::string("hedge_halflife"), std::to_string(halflife)));
+
+    Row replay = MakeRow("LevArbStrategy replay", symbols, NOT_APPLICABLE, halflife);
+    std::vector<CallbackStats> stats;
+    std::string log;
+    ReplayStream(library, stream, params, 1, misses, &replay, &stats, &log);
+
+    rows->push_back(CallbackRow("LevArbStrategy::OnBar", symbols, NOT_APPLICABLE, halflife, stats[CALLBACK_BAR]));
+    rows->push_back(SignalToOrderRow("LevArbStrategy::AdjustPortfolio", symbols, NOT_APPLICABLE, halflife, log));
+    rows->push_back(replay);
+}
+
+void PrintMetric(double value, int width, int precision) {
+    if (value < 0) {
+        printf(" %*s", width, "-");
+    } else {
+        printf(" %*.*f", width, precision, value);
+    }
+}
+
+void PrintTable(const std::vector<Row>& rows) {
+    printf("%-34s %7s %5s %6s %10s %5s %10s %10s %10s\n", "benchmark", "symbols", "depth", "window", "ops", "stat", "ns/op",
+        "allocs/op", "misses/op");
+    for (size_t i = 0; i < rows.size(); ++i) {
+        const Row& r = rows[i];
+        printf("%-34s %7d", r.name.c_str(), r.symbols);
+        if (r.depth < 0) {
+            printf(" %5s", "-");
+        } else {
+            printf(" %5d", r.depth);
+        }
+        printf(" %6d %10llu %5s", r.window, r.ops, r.stat);
+        PrintMetric(r.ns_per_op, 10, 1);
+        PrintMetric(r.allocations_per_op, 10, 4);
+        PrintMetric(r.cache_misses_per_op, 10, 3);
+        printf("\n");
+    }
+}
+
+void WriteJsonNumber(FILE* out, double value) {
+    if (value < 0) {
+        fprintf(out, "null");
+    } else {
+        fprintf(out, "%.6g", value);
+    }
+}
+
+void WriteJsonString(FILE* out, const std::string& s) {
+    fputc('"', out);
+    for (size_t i = 0; i < s.size(); ++i) {
+        if (s[i] == '"' || s[i] == '\\') {
+            fputc('\\', out);
+        }
+        fputc(s[i], out);
+    }
+    fputc('"', out);
+}
+
+bool WriteJson(const std::string& path, size_t events, const CacheMissCounter& misses, const std::vector<Row>& rows) {
+    FILE* out = fopen(path.c_str(), "w");
+    if (out == NULL) {
+        return false;
+    }
+    fprintf(out, "{\n  \"suite\": \"strategy_hot_path\",\n  \"compiler\": ");
+    WriteJsonString(out, __VERSION__);
+    fprintf(out, ",\n  \"events\": %zu,\n  \"cache_misses\": ", events);
+    WriteJsonString(out, misses.available() ? "perf_event_open PERF_COUNT_HW_CACHE_MISSES, user space" : misses.error());
+    fprintf(out, ",\n  \"results\": [\n");
+    for (size_t i = 0; i < rows.size(); ++i) {
+        const Row& r = rows[i];
+        fprintf(out, "    {\"name\": ");
+        WriteJsonString(out, r.name);
+        fprintf(out, ", \"symbols\": %d, \"depth\": ", r.symbols);
+        WriteJsonNumber(out, r.depth);
+        fprintf(out, ", \"window\": %d, \"ops\": %llu, \"stat\": \"%s\", \"ns_per_op\": ", r.window, r.ops, r.stat);
+        WriteJsonNumber(out, r.ns_per_op);
+        fprintf(out, ", \"allocations_per_op\": ");
+        WriteJsonNumber(out, r.allocations_per_op);
+        fprintf(out, ", \"cache_misses_per_op\": ");
+        WriteJsonNumber(out, r.cache_misses_per_op);
+        fprintf(out, "}%s\n", (i + 1 < rows.size()) ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+    return fclose(out) == 0;
+}
+
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        fprintf(stderr, "usage: strategy_hot_path_bench <libSignedVolumeTrade.so> <libLevArb.so> [--events n] [--json path]\n");
+        return 2;
+    }
+    size_t events = 500000;
+    std::string jsonPath;
+    for (int i = 3; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--events" && i + 1 < argc) {
+            events = strtoull(argv[++i], NULL, 10);
+        } else if (arg == "--json" && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else {
+            fprintf(stderr, "strategy_hot_path_bench: unknown argument %s\n", arg.c_str());
+            return 2;
+        }
+    }
+
+    const int updateSymbols[] = {4, 64, 1024};
+    const int updateWindows[] = {20, 200, 2000};
+    const int svSymbols[] = {4, 16, 64};
+    const int svDepths[] = {1, 5, 10};
+    const int svWindows[] = {20, 200};
+    const int levSymbols[] = {2, 4, 8};
+    const int levHalflives[] = {0, 20, 200};
+
+    try {
+        StrategyLibrary signedVolume(argv[1]);
+        StrategyLibrary levArb(argv[2]);
+        CacheMissCounter misses;
+        std::vector<Row> rows;
+
+        for (size_t s = 0; s < sizeof(updateSymbols) / sizeof(updateSymbols[0]); ++s) {
+            for (size_t w = 0; w < sizeof(updateWindows) / sizeof(updateWindows[0]); ++w) {
+                RunSignedVolumeUpdate(updateSymbols[s], updateWindows[w], &misses, &rows);
+            }
+        }
+        for (size_t s = 0; s < sizeof(svSymbols) / sizeof(svSymbols[0]); ++s) {
+            for (size_t d = 0; d < sizeof(svDepths) / sizeof(svDepths[0]); ++d) {
+                for (size_t w = 0; w < sizeof(svWindows) / sizeof(svWindows[0]); ++w) {
+                    RunSignedVolumeTrade(signedVolume, events, svSymbols[s], svDepths[d], svWindows[w], &misses, &rows);
+                }
+            }
+        }
+        // bars close every 10 seconds of market time, so LevArb needs a longer day for a useful number of OnBar calls
+        for (size_t s = 0; s < sizeof(levSymbols) / sizeof(levSymbols[0]); ++s) {
+            for (size_t h = 0; h < sizeof(levHalflives) / sizeof(levHalflives[0]); ++h) {
+                RunLevArb(levArb, events * 4, levSymbols[s], levHalflives[h], &misses, &rows);
+            }
+        }
+
+        PrintTable(rows);
+        if (!misses.available()) {
+            printf("\ncache misses unavailable: %s\n", misses.error().c_str());
+        }
+        if (!jsonPath.empty()) {
+            if (!WriteJson(jsonPath, events, misses, rows)) {
+                fprintf(stderr, "strategy_hot_path_bench: cannot write %s\n", jsonPath.c_str());
+                return 1;
+            }
+            printf("\nwrote %zu results to %s\n", rows.size(), jsonPath.c_str());
+        }
+    } catch (const std::exception& e) {
+        fprintf(stderr, "strategy_hot_path_bench: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#ifndef _STRATEGY_STUDIO_LIB_EXAMPLES_SYNTHETIC_TICKS_H_
+#define _STRATEGY_STUDIO_LIB_EXAMPLES_SYNTHETIC_TICKS_H_
+
+#include "../replay/TickRecord.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+/**
+ * A reproducible day of market data for the benchmarks: every symbol random-walks in cent steps from its own
+ * starting price, and each event is a trade (30%), a top quote (30%) or a depth level update (40%) on one
+ * random symbol. The same seed always produces the same stream.
+ */
+struct SyntheticTickSpec {
+    SyntheticTickSpec(): num_events(1000000), num_symbols(4), depth(10), seed(88172645463325252ULL) {}
+
+    size_t num_events;
+    int num_symbols;
+    int depth;
+    uint64_t seed;
+};
+
+inline uint64_t SyntheticRandom(uint64_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+inline void GenerateSyntheticTicks(const SyntheticTickSpec& spec, Replay::TickStream* stream) {
+    uint64_t rng = spec.seed;
+    std::vector<double> prices(spec.num_symbols);
+
+    stream->symbols.clear();
+    stream->records.clear();
+    stream->records.reserve(spec.num_events);
+    for (int i = 0; i < spec.num_symbols; ++i) {
+        char symbol[16];
+        snprintf(symbol, sizeof(symbol), "SYM%d", i);
+        stream->symbols.push_back(symbol);
+        prices[i] = 100.0 + 10 * i;
+    }
+
+    // 14:00 UTC on 2017-07-14
+    int64_t now = 1500000000LL * 1000000000LL + 14LL * 3600 * 1000000000LL;
+    for (size_t n = 0; n < spec.num_events; ++n) {
+        now += 1000 + static_cast<int64_t>(SyntheticRandom(&rng) % 2000000);
+        uint32_t instrument = static_cast<uint32_t>(SyntheticRandom(&rng) % spec.num_symbols);
+        // whole cents, so the walk never accumulates rounding error
+        double price = prices[instrument] = (static_cast<int64_t>(prices[instrument] * 100 + 0.5) + static_cast<int64_t>(SyntheticRandom(&rng) % 3) - 1) / 100.0;
+
+        Replay::TickRecord record = Replay::TickRecord();
+        record.timestamp = now;
+        record.instrument = instrument;
+
+        unsigned kind = SyntheticRandom(&rng) % 10;
+        if (kind < 3) {
+            record.type = Replay::TICK_TYPE_TRADE;
+            record.price[0] = price;
+            record.size[0] = 1 + SyntheticRandom(&rng) % 500;
+        } else if (kind < 6) {
+            record.type = Replay::TICK_TYPE_QUOTE;
+            record.price[0] = price - 0.01;
+            record.price[1] = price + 0.01;
+            record.size[0] = 1 + SyntheticRandom(&rng) % 900;
+            record.size[1] = 1 + SyntheticRandom(&rng) % 900;
+        } else {
+            bool bid = SyntheticRandom(&rng) & 1;
+            int level = static_cast<int>(SyntheticRandom(&rng) % spec.depth);
+            record.type = Replay::TICK_TYPE_DEPTH;
+            record.side = bid ? Replay::TICK_SIDE_BID : Replay::TICK_SIDE_ASK;
+            record.action = Replay::TICK_DEPTH_UPDATE;
+            record.level = static_cast<uint8_t>(level);
+            record.price[0] = bid ? price - 0.01 * (level + 1) : price + 0.01 * (level + 1);
+            record.size[0] = 1 + SyntheticRandom(&rng) % 900;
+        }
+        stream->records.push_back(record);
+    }
+}
+
+#endif
@@ -0,0 +1,256 @@
+#pragma once
+
+#ifndef _STRATEGY_STUDIO_LIB_EXAMPLES_ASYNC_JOURNAL_H_
+#define _STRATEGY_STUDIO_LIB_EXAMPLES_ASYNC_JOURNAL_H_
+
+#include "SpscRing.h"
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+enum JournalRecordType {
+    JOURNAL_RECORD_PNL = 0,
+    JOURNAL_RECORD_POSITION = 1,
+    JOURNAL_RECORD_ORDER = 2,
+    JOURNAL_RECORD_BAR = 3
+};
+
+/**
+ * One fixed-size journal entry; the strategy thread fills it with plain stores and the writer thread
+ * turns it into text. Symbols longer than 15 characters are truncated.
+ */
+struct JournalRecord {
+    int64_t time_micros;    // microseconds since the unix epoch
+    uint32_t type;
+    int32_t quantity;       // position, order quantity (negative for sells) or bar volume
+    char symbol[16];
+    double value[4];        // pnl; order price; bar open, high, low, close
+};
+
+/**
+ * Microseconds since the unix epoch for an SDK timestamp
+ */
+inline int64_t JournalTime(const boost::posix_time::ptime& t) {
+    static const boost::posix_time::ptime epoch(boost::gregorian::date(1970, 1, 1));
+    return (t - epoch).total_microseconds();
+}
+
+/**
+ * Off-thread journal for strategy diagnostics and PnL.
+ *
+ * Log* calls copy a record into a lock-free ring and return; they never allocate, lock or touch a
+ * file, and drop the record (counting it) if the writer has fallen a full ring behind. A background
+ * thread drains the ring, formats each record and appends it to the journal file, rotating it to
+ * <path>.1 ... <path>.N when it grows past the size limit. PnL records also refresh the latest
+ * snapshot file if one is configured.
+ */
+class AsyncJournal {
+public:
+    static const size_t RING_CAPACITY = 16384;
+    static const int MAX_ROTATED_FILES = 4;
+
+    AsyncJournal(): m_file(NULL), m_bytesWritten(0), m_maxBytes(0), m_running(false), m_dropped(0) {}
+
+    ~AsyncJournal() {
+        Close();
+    }
+
+    /**
+     * Starts the writer thread appending to path. An empty snapshot_path disables the snapshot file.
+     */
+    bool Open(const std::string& path, const std::string& snapshot_path, size_t max_bytes = 64 << 20) {
+        Close();
+        m_file = fopen(path.c_str(), "a");
+        if (m_file == NULL) {
+            return false;
+        }
+        fseek(m_file, 0, SEEK_END);
+        m_bytesWritten = ftell(m_file);
+        m_path = path;
+        m_snapshotPath = snapshot_path;
+        m_maxBytes = max_bytes;
+        m_dropped.store(0, std::memory_order_relaxed);
+        m_running.store(true, std::memory_order_release);
+        m_writer = std::thread(&AsyncJournal::WriterLoop, this);
+        return true;
+    }
+
+    /**
+     * Drains everything still queued, then stops the writer and closes the file
+     */
+    void Close() {
+        if (!m_writer.joinable()) {
+            return;
+        }
+        m_running.store(false, std::memory_order_release);
+        m_writer.join();
+        if (m_file != NULL) {
+            fclose(m_file);
+            m_file = NULL;
+        }
+    }
+
+    bool is_open() const { return m_writer.joinable(); }
+    uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    void LogPnl(int64_t time_micros, double pnl) {
+        JournalRecord rec = MakeRecord(JOURNAL_RECORD_PNL, time_micros, NULL, 0);
+        rec.value[0] = pnl;
+        Push(rec);
+    }
+
+    void LogPosition(int64_t time_micros, const std::string& symbol, int position) {
+        Push(MakeRecord(JOURNAL_RECORD_POSITION, time_micros, &symbol, position));
+    }
+
+    void LogOrder(int64_t time_micros, const std::string& symbol, int signed_quantity, double price) {
+        JournalRecord rec = MakeRecord(JOURNAL_RECORD_ORDER, time_micros, &symbol, signed_quantity);
+        rec.value[0] = price;
+        Push(rec);
+    }
+
+    void LogBar(int64_t time_micros, const std::string& symbol, double open, double high, double low, double close, int volume) {
+        JournalRecord rec = MakeRecord(JOURNAL_RECORD_BAR, time_micros, &symbol, volume);
+        rec.value[0] = open;
+        rec.value[1] = high;
+        rec.value[2] = low;
+        rec.value[3] = close;
+        Push(rec);
+    }
+
+private:
+    AsyncJournal(const AsyncJournal&);
+    AsyncJournal& operator=(const AsyncJournal&);
+
+    static JournalRecord MakeRecord(JournalRecordType type, int64_t time_micros, const std::string* symbol, int quantity) {
+        JournalRecord rec;
+        rec.time_micros = time_micros;
+        rec.type = type;
+        rec.quantity = quantity;
+        rec.symbol[0] = '\0';
+        if (symbol != NULL) {
+            size_t n = symbol->size() < sizeof(rec.symbol) - 1 ? symbol->size() : sizeof(rec.symbol) - 1;
+            memcpy(rec.symbol, symbol->data(), n);
+            rec.symbol[n] = '\0';
+        }
+        rec.value[0] = rec.value[1] = rec.value[2] = rec.value[3] = 0;
+        return rec;
+    }
+
+    void Push(const JournalRecord& rec) {
+        if (!is_open() || !m_ring.TryPush(rec)) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void WriterLoop() {
+        JournalRecord rec;
+        for (;;) {
+            bool running = m_running.load(std::memory_order_acquire);
+            bool wrote = false;
+            while (m_ring.TryPop(&rec)) {
+                Write(rec);
+                wrote = true;
+            }
+            if (wrote && m_file != NULL) {
+                fflush(m_file);
+            } else if (!running) {
+                break;
+            } else {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+        uint64_t dropped = m_dropped.load(std::memory_order_relaxed);
+        if (dropped > 0 && m_file != NULL) {
+            fprintf(m_file, "journal dropped %llu records\n", static_cast<unsigned long long>(dropped));
+        }
+    }
+
+    void Write(const JournalRecord& rec) {
+        char stamp[40];
+        FormatTime(rec.time_micros, stamp, sizeof(stamp));
+
+        char line[256];
+        int n = 0;
+        switch (rec.type) {
+            case JOURNAL_RECORD_PNL:
+                n = snprintf(line, sizeof(line), "%s PnL %.2f\n", stamp, rec.value[0]);
+                WriteSnapshot(rec);
+                break;
+            case JOURNAL_RECORD_POSITION:
+                n = snprintf(line, sizeof(line), "%s Symbol %s Position %d\n", stamp, rec.symbol, rec.quantity);
+                break;
+            case JOURNAL_RECORD_ORDER:
+                n = snprintf(line, sizeof(line), "%s Sending %s order for %s at price %.4f and quantity %d\n", stamp,
+                             rec.quantity >= 0 ? "buy" : "sell", rec.symbol, rec.value[0], rec.quantity >= 0 ? rec.quantity : -rec.quantity);
+                break;
+            case JOURNAL_RECORD_BAR:
+                n = snprintf(line, sizeof(line), "%s %s: O %.4f H %.4f L %.4f C %.4f V %d\n", stamp, rec.symbol,
+                             rec.value[0], rec.value[1], rec.value[2], rec.value[3], rec.quantity);
+                break;
+        }
+        if (n <= 0 || m_file == NULL) {
+            return;
+        }
+        if (m_bytesWritten + n > m_maxBytes && m_bytesWritten > 0) {
+            Rotate();
+        }
+        fwrite(line, 1, n, m_file);
+        m_bytesWritten += n;
+    }
+
+    void WriteSnapshot(const JournalRecord& rec) {
+        if (m_snapshotPath.empty()) {
+            return;
+        }
+        // same content as the account.txt the strategy used to rewrite on every bar
+        std::ofstream out(m_snapshotPath.c_str(), std::ios::trunc);
+        out << boost::posix_time::from_time_t(rec.time_micros / 1000000) + boost::posix_time::microseconds(rec.time_micros % 1000000);
+        out << rec.value[0];
+    }
+
+    void Rotate() {
+        fclose(m_file);
+        for (int i = MAX_ROTATED_FILES - 1; i >= 1; --i) {
+            std::ostringstream from, to;
+            from << m_path << "." << i;
+            to << m_path << "." << i + 1;
+            rename(from.str().c_str(), to.str().c_str());
+        }
+        rename(m_path.c_str(), (m_path + ".1").c_str());
+        m_file = fopen(m_path.c_str(), "w");
+        m_bytesWritten = 0;
+    }
+
+    static void FormatTime(int64_t time_micros, char* buf, size_t len) {
+        time_t secs = static_cast<time_t>(time_micros / 1000000);
+        struct tm parts;
+        gmtime_r(&secs, &parts);
+        size_t n = strftime(buf, len, "%Y-%m-%d %H:%M:%S", &parts);
+        snprintf(buf + n, len - n, ".%06d", static_cast<int>(time_micros % 1000000));
+    }
+
+private:
+    SpscRing<JournalRecord, RING_CAPACITY> m_ring;
+    std::thread m_writer;
+    FILE* m_file;
+    std::string m_path;
+    std::string m_snapshotPath;
+    size_t m_bytesWritten;
+    size_t m_maxBytes;
+    std::atomic<bool> m_running;
+    std::atomic<uint64_t> m_dropped;
+};
+
+#endif
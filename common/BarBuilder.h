@@ -0,0 +1,208 @@
+#pragma once
+
+#ifndef _STRATEGY_STUDIO_LIB_EXAMPLES_BAR_BUILDER_H_
+#define _STRATEGY_STUDIO_LIB_EXAMPLES_BAR_BUILDER_H_
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+/**
+ * Most timeframes one BarBuilder keeps at once
+ */
+const int MAX_BAR_INTERVALS = 8;
+
+/**
+ * One time bar built from trades. Times are microseconds since the epoch, as JournalTime gives them;
+ * close_time is the end of the interval. mid is the last quote midpoint seen before the bar closed,
+ * or 0 if the instrument has not been quoted.
+ */
+struct LocalBar {
+    LocalBar() {
+        Clear();
+    }
+
+    void Clear() {
+        close_time = 0;
+        open = 0;
+        high = 0;
+        low = 0;
+        close = 0;
+        mid = 0;
+        volume = 0;
+        notional = 0;
+        trades = 0;
+    }
+
+    double vwap() const {
+        return (volume > 0) ? notional / volume : close;
+    }
+
+    int64_t close_time;
+    double open;
+    double high;
+    double low;
+    double close;
+    double mid;
+    long long volume;
+    double notional;
+    int trades;
+};
+
+/**
+ * Builds OHLCV/VWAP time bars for several intervals at once inside the strategy, from the trades and
+ * quotes it already receives, instead of one server bar subscription per timeframe.
+ *
+ * The bars follow the server's rules: a bar opens on an instrument's first trade in an interval,
+ * intervals without trades produce no bar, and a bar closes as soon as any event arrives at or past
+ * its close time. A trade updates each interval's open bar in place, so it costs a few compares
+ * per interval; quotes only record the midpoint and move the clock. Closing is one compare per
+ * event against the earliest open close time, with a sweep only when a boundary has been crossed.
+ * Storage is one open and one completed bar per instrument and interval, fixed by Reset.
+ *
+ * Closed bars are handed to a callback, called as on_close(index, interval, bar) in instrument then
+ * interval order, before the event that closed them is applied.
+ */
+class BarBuilder {
+public:
+    BarBuilder(): m_num_intervals(0), m_next_close(std::numeric_limits<int64_t>::max()) {}
+
+    /**
+     * Adds a timeframe and returns its interval id, or -1 if all MAX_BAR_INTERVALS are taken.
+     * Intervals are added before Reset.
+     */
+    int AddInterval(int64_t interval_micros) {
+        if (m_num_intervals == MAX_BAR_INTERVALS || interval_micros <= 0) {
+            return -1;
+        }
+        m_interval_micros[m_num_intervals] = interval_micros;
+        return m_num_intervals++;
+    }
+
+    void ClearIntervals() {
+        m_num_intervals = 0;
+        m_slots.clear();
+        m_last_mid.clear();
+    }
+
+    /**
+     * Sizes the builder for the given number of instruments and drops every bar
+     */
+    void Reset(size_t num_instruments) {
+        m_slots.assign(num_instruments * m_num_intervals, Slot());
+        m_last_mid.assign(num_instruments, 0.0);
+        m_next_close = std::numeric_limits<int64_t>::max();
+    }
+
+    template <typename OnClose>
+    void Advance(int64_t now, OnClose on_close) {
+        if (now >= m_next_close) {
+            CloseBars(now, on_close);
+        }
+    }
+
+    template <typename OnClose>
+    void OnTrade(int index, int64_t now, double price, long long size, OnClose on_close) {
+        Advance(now, on_close);
+
+        Slot* slots = &m_slots[index * m_num_intervals];
+        for (int i = 0; i < m_num_intervals; ++i) {
+            Slot& slot = slots[i];
+            LocalBar& bar = slot.current;
+            if (!slot.open) {
+                slot.open = true;
+                bar.close_time = (now / m_interval_micros[i] + 1) * m_interval_micros[i];
+                bar.open = bar.high = bar.low = price;
+                bar.volume = 0;
+                bar.notional = 0;
+                bar.trades = 0;
+                m_next_close = std::min(m_next_close, bar.close_time);
+            }
+            bar.high = std::max(bar.high, price);
+            bar.low = std::min(bar.low, price);
+            bar.close = price;
+            bar.volume += size;
+            bar.notional += price * size;
+            ++bar.trades;
+        }
+    }
+
+    template <typename OnClose>
+    void OnQuote(int index, int64_t now, double mid, OnClose on_close) {
+        Advance(now, on_close);
+        m_last_mid[index] = mid;
+    }
+
+    /**
+     * Closes every open bar now, whatever its close time; for the end of a session, when no later
+     * event will arrive to close them
+     */
+    template <typename OnClose>
+    void Flush(OnClose on_close) {
+        CloseBars(std::numeric_limits<int64_t>::max(), on_close);
+    }
+
+    /**
+     * The instrument's most recent completed bar for the interval; trades == 0 until one has closed
+     */
+    const LocalBar& last_bar(int index, int interval) const {
+        return m_slots[index * m_num_intervals + interval].last;
+    }
+
+    /**
+     * The bar still being built, valid while has_open_bar is true
+     */
+    const LocalBar& current_bar(int index, int interval) const {
+        return m_slots[index * m_num_intervals + interval].current;
+    }
+
+    bool has_open_bar(int index, int interval) const {
+        return m_slots[index * m_num_intervals + interval].open;
+    }
+
+    int num_intervals() const { return m_num_intervals; }
+    int64_t interval_micros(int interval) const { return m_interval_micros[interval]; }
+
+private:
+    struct Slot {
+        Slot(): open(false) {}
+
+        bool open;
+        LocalBar current;
+        LocalBar last;
+    };
+
+    template <typename OnClose>
+    void CloseBars(int64_t now, OnClose on_close) {
+        m_next_close = std::numeric_limits<int64_t>::max();
+        size_t num_instruments = m_last_mid.size();
+        for (size_t index = 0; index < num_instruments; ++index) {
+            Slot* slots = &m_slots[index * m_num_intervals];
+            for (int i = 0; i < m_num_intervals; ++i) {
+                Slot& slot = slots[i];
+                if (!slot.open) {
+                    continue;
+                }
+                if (slot.current.close_time > now) {
+                    m_next_close = std::min(m_next_close, slot.current.close_time);
+                    continue;
+                }
+                slot.open = false;
+                slot.current.mid = m_last_mid[index];
+                slot.last = slot.current;
+                on_close(static_cast<int>(index), i, slot.last);
+            }
+        }
+    }
+
+private:
+    int m_num_intervals;
+    int64_t m_interval_micros[MAX_BAR_INTERVALS];
+    int64_t m_next_close;
+    std::vector<Slot> m_slots;
+    std::vector<double> m_last_mid;
+};
+
+#endif
@@ -0,0 +1,78 @@
+#pragma once
+
+#ifndef _STRATEGY_STUDIO_LIB_EXAMPLES_CONFIG_SNAPSHOT_H_
+#define _STRATEGY_STUDIO_LIB_EXAMPLES_CONFIG_SNAPSHOT_H_
+
+#include <assert.h>
+
+#include <atomic>
+#include <thread>
+
+/**
+ * A strategy's runtime params as one immutable value, republished whole whenever a param changes.
+ *
+ * Readers take the current version with a single acquire load and read every field from that one
+ * copy, so a callback never sees half of an update or a value another code path overwrote midway.
+ * The writer (OnParamChanged) copies the current version, edits the copy and publishes it with a
+ * release store into the next of three slots, so a version a caller still holds a reference to
+ * survives the next two publishes. There is no lock and no allocation on either side.
+ *
+ * The slots are reused without tracking who still reads them, so publishing and reading must happen
+ * on one thread, as Strategy Studio delivers every callback of a strategy instance, OnParamChanged
+ * included, on that instance's thread. The first Publish binds the snapshot to its thread; Publish
+ * refuses to run anywhere else, and get() checks the thread in debug builds. Reads before the first
+ * Publish, e.g. from the constructor, are not checked. Config must be copyable and default construct
+ * to the param defaults.
+ */
+template <typename Config>
+class ConfigSnapshot {
+public:
+    ConfigSnapshot(): m_owner(std::thread::id()), m_slot(0) {
+        m_current.store(&m_versions[0], std::memory_order_release);
+    }
+
+    /**
+     * The current version; hold it for the length of one callback at most
+     */
+    const Config& get() const {
+        assert(OnOwnerThread());
+        return *m_current.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Makes config the current version. Returns false without publishing when called from a thread
+     * other than the one that published first.
+     */
+    bool Publish(const Config& config) {
+        std::thread::id self = std::this_thread::get_id();
+        std::thread::id unbound;
+        if (!m_owner.compare_exchange_strong(unbound, self, std::memory_order_relaxed) && unbound != self) {
+            return false;
+        }
+        m_slot = (m_slot + 1) % NUM_VERSIONS;
+        m_versions[m_slot] = config;
+        m_current.store(&m_versions[m_slot], std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * True on the thread the snapshot is bound to, and anywhere before it is bound
+     */
+    bool OnOwnerThread() const {
+        std::thread::id owner = m_owner.load(std::memory_order_relaxed);
+        return owner == std::thread::id() || owner == std::this_thread::get_id();
+    }
+
+private:
+    ConfigSnapshot(const ConfigSnapshot&);
+    ConfigSnapshot& operator=(const ConfigSnapshot&);
+
+    static const int NUM_VERSIONS = 3;
+
+    std::atomic<const Config*> m_current;
+    std::atomic<std::thread::id> m_owner;
+    int m_slot;
+    Config m_versions[NUM_VERSIONS];
+};
+
+#endif
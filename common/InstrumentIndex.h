@@ -0,0 +1,82 @@
+#pragma once
+
+#ifndef _STRATEGY_STUDIO_LIB_EXAMPLES_INSTRUMENT_INDEX_H_
+#define _STRATEGY_STUDIO_LIB_EXAMPLES_INSTRUMENT_INDEX_H_
+
+#include <MarketModels/Instrument.h>
+
+#include <stdint.h>
+#include <vector>
+
+using namespace RCM::StrategyStudio;
+
+/**
+ * Maps the server's Instrument pointers to the small dense indices a strategy assigns in
+ * RegisterForStrategyEvents. Open addressing over a power-of-two table that is at most half full,
+ * so a lookup is one multiply and, almost always, a single probe regardless of universe size.
+ */
+class InstrumentIndex {
+public:
+    InstrumentIndex(): m_shift(63) {}
+
+    /**
+     * Clears the index and sizes it for the given number of instruments
+     */
+    void Reset(size_t num_instruments) {
+        size_t capacity = 2;
+        m_shift = 63;
+        while (capacity < 2 * num_instruments) {
+            capacity <<= 1;
+            --m_shift;
+        }
+        m_slots.assign(capacity, Slot());
+    }
+
+    void Insert(const MarketModels::Instrument* instrument, int index) {
+        size_t mask = m_slots.size() - 1;
+        for (size_t i = Hash(instrument); ; i = (i + 1) & mask) {
+            if (m_slots[i].instrument == NULL || m_slots[i].instrument == instrument) {
+                m_slots[i].instrument = instrument;
+                m_slots[i].index = index;
+                return;
+            }
+        }
+    }
+
+    /**
+     * Returns the instrument's index, or -1 if it was never inserted
+     */
+    int Find(const MarketModels::Instrument* instrument) const {
+        if (m_slots.empty()) {
+            return -1;
+        }
+        size_t mask = m_slots.size() - 1;
+        for (size_t i = Hash(instrument); ; i = (i + 1) & mask) {
+            const Slot& slot = m_slots[i];
+            if (slot.instrument == instrument) {
+                return slot.index;
+            }
+            if (slot.instrument == NULL) {
+                return -1;
+            }
+        }
+    }
+
+private:
+    struct Slot {
+        Slot(): instrument(NULL), index(-1) {}
+
+        const MarketModels::Instrument* instrument;
+        int index;
+    };
+
+    size_t Hash(const MarketModels::Instrument* instrument) const {
+        // fibonacci hashing; the top bits of the product are well mixed even for aligned pointers
+        return static_cast<size_t>((reinterpret_cast<uintptr_t>(instrument) * 0x9E3779B97F4A7C15ULL) >> m_shift);
+    }
+
+    std::vector<Slot> m_slots;
+    unsigned m_shift;
+};
+
+#endif
@@ -0,0 +1,188 @@
+#pragma once
+
+#ifndef _STRATEGY_STUDIO_LIB_EXAMPLES_LATENCY_HISTOGRAM_H_
+#define _STRATEGY_STUDIO_LIB_EXAMPLES_LATENCY_HISTOGRAM_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include <iomanip>
+#include <ostream>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+#endif
+
+/**
+ * Cheapest available monotonic tick source: the TSC on x86, the monotonic clock in ns elsewhere
+ */
+struct CycleClock {
+    static uint64_t Now() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return WallNanos();
+#endif
+    }
+
+    static uint64_t WallNanos() {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+    }
+};
+
+/**
+ * HDR-style log-linear histogram of tick counts. Each power of two is split into 2^SUB_BITS
+ * equal sub-buckets, so any recorded value is reported within about 3%. Recording is a couple of
+ * bit operations and an increment into a fixed array: no locks, no allocation.
+ */
+class LatencyHistogram {
+public:
+    static const int SUB_BITS = 5;
+    static const int SUB_BUCKETS = 1 << SUB_BITS;
+    static const int NUM_BUCKETS = (64 - SUB_BITS + 1) * SUB_BUCKETS;
+
+    LatencyHistogram() {
+        Reset();
+    }
+
+    void Reset() {
+        memset(m_counts, 0, sizeof(m_counts));
+        m_total = 0;
+        m_max = 0;
+    }
+
+    void Record(uint64_t value) {
+        ++m_counts[BucketIndex(value)];
+        ++m_total;
+        if (value > m_max) {
+            m_max = value;
+        }
+    }
+
+    uint64_t count() const { return m_total; }
+    uint64_t max() const { return m_max; }
+
+    /**
+     * Lower bound of the bucket holding the given quantile (0..1)
+     */
+    uint64_t ValueAtQuantile(double quantile) const {
+        if (m_total == 0) {
+            return 0;
+        }
+        uint64_t rank = static_cast<uint64_t>(quantile * m_total);
+        if (rank >= m_total) {
+            rank = m_total - 1;
+        }
+        uint64_t seen = 0;
+        for (int i = 0; i < NUM_BUCKETS; ++i) {
+            seen += m_counts[i];
+            if (seen > rank) {
+                return BucketValue(i);
+            }
+        }
+        return m_max;
+    }
+
+private:
+    static int BucketIndex(uint64_t value) {
+        if (value < static_cast<uint64_t>(SUB_BUCKETS)) {
+            return static_cast<int>(value);
+        }
+        int msb = 63 - __builtin_clzll(value);
+        int shift = msb - SUB_BITS;
+        return (shift + 1) * SUB_BUCKETS + static_cast<int>((value >> shift) - SUB_BUCKETS);
+    }
+
+    static uint64_t BucketValue(int index) {
+        if (index < SUB_BUCKETS) {
+            return index;
+        }
+        int shift = index / SUB_BUCKETS - 1;
+        return static_cast<uint64_t>(index % SUB_BUCKETS + SUB_BUCKETS) << shift;
+    }
+
+    uint64_t m_counts[NUM_BUCKETS];
+    uint64_t m_total;
+    uint64_t m_max;
+};
+
+/**
+ * Tick-to-order latency for a strategy's market data path. Call Begin() on callback entry,
+ * Signal() once the trading signal is computed and OrderSent() after each SendNewOrder; every
+ * call is one cycle-counter read. Stages that were not reached in a callback are not recorded.
+ */
+class LatencyTracker {
+public:
+    enum Stage {
+        STAGE_ENTRY_TO_SIGNAL = 0,
+        STAGE_SIGNAL_TO_ORDER,
+        STAGE_ENTRY_TO_ORDER,
+        NUM_STAGES
+    };
+
+    LatencyTracker(): m_entry(0), m_signal(0) {
+        Reset();
+    }
+
+    void Reset() {
+        for (int i = 0; i < NUM_STAGES; ++i) {
+            m_histograms[i].Reset();
+        }
+        m_calibrationTicks = CycleClock::Now();
+        m_calibrationNanos = CycleClock::WallNanos();
+    }
+
+    void Begin() {
+        m_entry = CycleClock::Now();
+        m_signal = 0;
+    }
+
+    void Signal() {
+        m_signal = CycleClock::Now();
+        m_histograms[STAGE_ENTRY_TO_SIGNAL].Record(m_signal - m_entry);
+    }
+
+    void OrderSent() {
+        uint64_t now = CycleClock::Now();
+        if (m_signal != 0) {
+            m_histograms[STAGE_SIGNAL_TO_ORDER].Record(now - m_signal);
+        }
+        m_histograms[STAGE_ENTRY_TO_ORDER].Record(now - m_entry);
+    }
+
+    const LatencyHistogram& histogram(Stage stage) const { return m_histograms[stage]; }
+
+    /**
+     * Writes one line per stage with count, p50, p99, p99.9 and max in nanoseconds. The tick rate is
+     * calibrated against the wall clock over the interval since the last Reset().
+     */
+    void Dump(std::ostream& os) const {
+        static const char* names[NUM_STAGES] = {"entry->signal", "signal->order", "entry->order"};
+
+        uint64_t ticks = CycleClock::Now() - m_calibrationTicks;
+        uint64_t nanos = CycleClock::WallNanos() - m_calibrationNanos;
+        double nanosPerTick = (ticks > 0 && nanos > 0) ? static_cast<double>(nanos) / ticks : 1.0;
+
+        os << std::fixed << std::setprecision(0);
+        for (int i = 0; i < NUM_STAGES; ++i) {
+            const LatencyHistogram& h = m_histograms[i];
+            os << names[i] << " count " << h.count()
+               << " p50 " << h.ValueAtQuantile(0.5) * nanosPerTick
+               << " p99 " << h.ValueAtQuantile(0.99) * nanosPerTick
+               << " p99.9 " << h.ValueAtQuantile(0.999) * nanosPerTick
+               << " max " << h.max() * nanosPerTick << " ns\n";
+        }
+    }
+
+private:
+    LatencyHistogram m_histograms[NUM_STAGES];
+    uint64_t m_entry;
+    uint64_t m_signal;
+    uint64_t m_calibrationTicks;
+    uint64_t m_calibrationNanos;
+};
+
+#endif
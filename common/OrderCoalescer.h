@@ -0,0 +1,228 @@
+#pragma once
+
+#ifndef _STRATEGY_STUDIO_LIB_EXAMPLES_ORDER_COALESCER_H_
+#define _STRATEGY_STUDIO_LIB_EXAMPLES_ORDER_COALESCER_H_
+
+#include <Strategy.h>
+#include <MarketModels/Instrument.h>
+
+#include "OrderTemplate.h"
+#include "RiskGate.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+using namespace RCM::StrategyStudio;
+
+enum OrderSlotState {
+    ORDER_SLOT_IDLE = 0,
+    ORDER_SLOT_PENDING_NEW,
+    ORDER_SLOT_WORKING,
+    ORDER_SLOT_PENDING_REPLACE,
+    ORDER_SLOT_PENDING_CANCEL
+};
+
+/**
+ * The one order a strategy keeps per instrument: what it wants (desired), what the market has
+ * (working) and, while a replace is in flight, what the replace asked for (pending); the pending
+ * values become the working ones only when the replace is acknowledged. Quantities are signed,
+ * positive to buy. index is the strategy's dense instrument
+ * index, which the risk gate is addressed by, and order_template holds the instrument's prebuilt
+ * limit orders; Reset leaves both alone.
+ */
+struct OrderSlot {
+    OrderSlot(): index(-1) {
+        Reset();
+    }
+
+    void Reset() {
+        state = ORDER_SLOT_IDLE;
+        order_id = 0;
+        working_quantity = 0;
+        working_price = 0;
+        pending_quantity = 0;
+        pending_price = 0;
+        filled_quantity = 0;
+        desired_quantity = 0;
+        desired_price = 0;
+    }
+
+    int index;
+    OrderTemplate order_template;
+    OrderSlotState state;
+    OrderID order_id;
+    int working_quantity;
+    double working_price;
+    int pending_quantity;
+    double pending_price;
+    int filled_quantity;
+    int desired_quantity;
+    double desired_price;
+};
+
+/**
+ * Turns a stream of per-instrument order intents into the fewest order messages.
+ *
+ * SetIntent only records what the strategy wants. If nothing is in flight it sends the single
+ * message that moves the working order there: a new order, a cancel-replace for a new price or size
+ * on the same side, or a cancel when the intent goes flat or flips side. While a message is in
+ * flight further intents just overwrite the desired order; OnOrderUpdate settles the slot when the
+ * server answers and follows up with the latest intent. Fills use up the intent they fill, and
+ * unchanged intents send nothing. A rejected replace leaves the order as it was: the slot goes back
+ * to working at the old price and size and, as after a rejected new order, waits for the intent to
+ * change rather than resending what was just refused. A rejected cancel likewise returns the slot
+ * to working; the order is usually about to fill, and the next intent sends the cancel again if it
+ * is still wanted. Counters count only the messages the server accepted.
+ */
+class OrderCoalescer {
+public:
+    struct Counters {
+        Counters(): new_orders(0), replaces(0), cancels(0) {}
+
+        unsigned long long messages() const { return new_orders + replaces + cancels; }
+
+        unsigned long long new_orders;
+        unsigned long long replaces;
+        unsigned long long cancels;
+    };
+
+public:
+    OrderCoalescer(): m_strategy(NULL), m_risk_gate(NULL) {}
+
+    /**
+     * With a risk gate, every new order and every replace that grows an order must pass its checks
+     */
+    void Attach(Strategy* strategy, RiskGate* risk_gate = NULL) {
+        m_strategy = strategy;
+        m_risk_gate = risk_gate;
+    }
+
+    void SetIntent(OrderSlot& slot, int desired_quantity, double desired_price) {
+        slot.desired_quantity = desired_quantity;
+        slot.desired_price = desired_price;
+        Reconcile(slot);
+    }
+
+    /**
+     * Applies an update for one of the slot's orders; updates for other orders are ignored
+     */
+    void OnOrderUpdate(OrderSlot& slot, const OrderUpdateEventMsg& msg) {
+        if (msg.order().order_id() != slot.order_id) {
+            return;
+        }
+
+        if (msg.fill_occurred()) {
+            // a fill consumes that much of the intent; the strategy re-arms it on its next signal
+            int filled = msg.fill()->fill_size();
+            slot.working_quantity -= filled;
+            slot.pending_quantity -= (slot.state == ORDER_SLOT_PENDING_REPLACE) ? filled : 0;
+            slot.filled_quantity += abs(filled);
+            if ((slot.desired_quantity > 0) == (filled > 0)) {
+                slot.desired_quantity = (abs(slot.desired_quantity) > abs(filled)) ? slot.desired_quantity - filled : 0;
+            }
+        }
+
+        if (msg.completes_order()) {
+            slot.state = ORDER_SLOT_IDLE;
+            slot.order_id = 0;
+            slot.working_quantity = 0;
+            slot.filled_quantity = 0;
+            if (msg.update_type() == ORDER_UPDATE_TYPE_REJECT) {
+                // don't resubmit the same rejected order; wait for the intent to change
+                slot.desired_quantity = 0;
+            }
+        } else if (slot.state == ORDER_SLOT_PENDING_REPLACE && msg.update_type() == ORDER_UPDATE_TYPE_REPLACE_REJECT) {
+            slot.state = ORDER_SLOT_WORKING;
+            slot.desired_quantity = slot.working_quantity;
+            slot.desired_price = slot.working_price;
+        } else if (slot.state == ORDER_SLOT_PENDING_REPLACE && msg.update_type() == ORDER_UPDATE_TYPE_MODIFY) {
+            slot.state = ORDER_SLOT_WORKING;
+            slot.working_quantity = slot.pending_quantity;
+            slot.working_price = slot.pending_price;
+        } else if (slot.state == ORDER_SLOT_PENDING_CANCEL && msg.update_type() == ORDER_UPDATE_TYPE_CANCEL_REJECT) {
+            // not retried from the reject itself; the next intent cancels again if it still wants to
+            slot.state = ORDER_SLOT_WORKING;
+            return;
+        } else if (slot.state == ORDER_SLOT_PENDING_NEW) {
+            slot.state = ORDER_SLOT_WORKING;
+        }
+        Reconcile(slot);
+    }
+
+    const Counters& counters() const { return m_counters; }
+
+private:
+    static bool SamePrice(double a, double b) {
+        return fabs(a - b) < 1e-9;
+    }
+
+    void Reconcile(OrderSlot& slot) {
+        switch (slot.state) {
+            case ORDER_SLOT_IDLE:
+                if (slot.desired_quantity != 0) {
+                    SendNew(slot);
+                }
+                break;
+            case ORDER_SLOT_WORKING:
+                if (slot.desired_quantity == 0 || (slot.desired_quantity > 0) != (slot.working_quantity > 0)) {
+                    if (m_strategy->trade_actions()->SendCancelOrder(slot.order_id) == TRADE_ACTION_RESULT_SUCCESSFUL) {
+                        ++m_counters.cancels;
+                        slot.state = ORDER_SLOT_PENDING_CANCEL;
+                    }
+                } else if (slot.desired_quantity != slot.working_quantity || !SamePrice(slot.desired_price, slot.working_price)) {
+                    SendReplace(slot);
+                }
+                break;
+            case ORDER_SLOT_PENDING_NEW:
+            case ORDER_SLOT_PENDING_REPLACE:
+            case ORDER_SLOT_PENDING_CANCEL:
+                // one message in flight at a time; the update that settles it reconciles again
+                break;
+        }
+    }
+
+    /**
+     * A replace restates the order's total size, so what already filled is added back on
+     */
+    static OrderParams& MakeParams(OrderSlot& slot) {
+        return slot.order_template.Patch(slot.desired_quantity > 0, abs(slot.desired_quantity) + slot.filled_quantity, slot.desired_price);
+    }
+
+    void SendNew(OrderSlot& slot) {
+        if (m_risk_gate != NULL && m_risk_gate->Check(slot.index, slot.desired_quantity, slot.desired_price) != RISK_CHECK_OK) {
+            return;
+        }
+        OrderParams& params = MakeParams(slot);
+        if (m_strategy->trade_actions()->SendNewOrder(params) == TRADE_ACTION_RESULT_SUCCESSFUL) {
+            ++m_counters.new_orders;
+            if (m_risk_gate != NULL) {
+                m_risk_gate->OnOrderSent();
+            }
+            slot.state = ORDER_SLOT_PENDING_NEW;
+            slot.order_id = params.order_id;
+            slot.working_quantity = slot.desired_quantity;
+            slot.working_price = slot.desired_price;
+        }
+    }
+
+    void SendReplace(OrderSlot& slot) {
+        if (m_risk_gate != NULL && abs(slot.desired_quantity) > abs(slot.working_quantity)
+            && m_risk_gate->Check(slot.index, slot.desired_quantity, slot.desired_price) != RISK_CHECK_OK) {
+            return;
+        }
+        OrderParams& params = MakeParams(slot);
+        if (m_strategy->trade_actions()->SendCancelReplaceOrder(slot.order_id, params) == TRADE_ACTION_RESULT_SUCCESSFUL) {
+            ++m_counters.replaces;
+            slot.state = ORDER_SLOT_PENDING_REPLACE;
+            slot.pending_quantity = slot.desired_quantity;
+            slot.pending_price = slot.desired_price;
+        }
+    }
+
+private:
+    Strategy* m_strategy;
+    RiskGate* m_risk_gate;
+    Counters m_counters;
+};
+
+#endif
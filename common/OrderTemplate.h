@@ -0,0 +1,65 @@
+#pragma once
+
+#ifndef _STRATEGY_STUDIO_LIB_EXAMPLES_ORDER_TEMPLATE_H_
+#define _STRATEGY_STUDIO_LIB_EXAMPLES_ORDER_TEMPLATE_H_
+
+#include <ExecutionTypes.h>
+#include <MarketModels/Instrument.h>
+
+#include "VenueRouting.h"
+
+#include <stdlib.h>
+
+using namespace RCM::StrategyStudio;
+
+/**
+ * A buy and a sell OrderParams for one instrument, with venue, TIF and order type resolved once
+ * when the instrument is registered. Sending an order only patches price and quantity into the
+ * side's prebuilt params, so the send path neither constructs params nor branches on instrument
+ * type.
+ */
+class OrderTemplate {
+public:
+    OrderTemplate() {}
+
+    OrderTemplate(const MarketModels::Instrument& instrument, OrderType type, OrderTIF tif = ORDER_TIF_DAY) {
+        Build(instrument, type, tif);
+    }
+
+    void Build(const MarketModels::Instrument& instrument, OrderType type, OrderTIF tif = ORDER_TIF_DAY) {
+        MarketCenterID market_center = RouteForInstrument(instrument.type());
+        m_params[0] = OrderParams(instrument, 0, 0, market_center, ORDER_SIDE_BUY, tif, type);
+        m_params[1] = OrderParams(instrument, 0, 0, market_center, ORDER_SIDE_SELL, tif, type);
+    }
+
+    /**
+     * The side's params for a signed quantity, positive to buy and anything else to sell, as the
+     * strategies always picked the side. The reference stays valid until the next Patch for the
+     * same side, which is long enough for SendNewOrder to fill in order_id.
+     */
+    OrderParams& Patch(int signed_quantity, double price) {
+        OrderParams& params = m_params[signed_quantity <= 0];
+        params.quantity = abs(signed_quantity);
+        params.price = price;
+        params.order_id = 0;
+        return params;
+    }
+
+    /**
+     * As Patch, for a side already known and an unsigned quantity
+     */
+    OrderParams& Patch(bool buy, unsigned quantity, double price) {
+        OrderParams& params = m_params[!buy];
+        params.quantity = quantity;
+        params.price = price;
+        params.order_id = 0;
+        return params;
+    }
+
+    const MarketModels::Instrument* instrument() const { return m_params[0].instrument; }
+
+private:
+    OrderParams m_params[2];
+};
+
+#endif
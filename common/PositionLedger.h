@@ -0,0 +1,81 @@
+#pragma once
+
+#ifndef _STRATEGY_STUDIO_LIB_EXAMPLES_POSITION_LEDGER_H_
+#define _STRATEGY_STUDIO_LIB_EXAMPLES_POSITION_LEDGER_H_
+
+#include <Strategy.h>
+
+#include <vector>
+
+using namespace RCM::StrategyStudio;
+
+/**
+ * A strategy's own running count of what it holds and what it has in flight, per instrument.
+ *
+ * position is the sum of the fills seen in OnOrderUpdate; pending is the signed unfilled quantity
+ * of every order sent and not yet completed. Sizing off position + pending lets a strategy send the
+ * next order while earlier ones are still working without sending the same quantity twice, and
+ * without asking the portfolio model for positions on every decision. Quantities are signed,
+ * positive for buys; instruments are addressed by the strategy's dense instrument index.
+ */
+class PositionLedger {
+public:
+    struct Entry {
+        Entry(): position(0), pending(0) {}
+
+        int position;
+        int pending;
+    };
+
+public:
+    void Reset(size_t num_instruments) {
+        m_entries.assign(num_instruments, Entry());
+    }
+
+    /**
+     * Starts an instrument from a position already held, e.g. one the portfolio carried in
+     */
+    void set_position(int index, int position) {
+        m_entries[index].position = position;
+    }
+
+    /**
+     * Call when SendNewOrder succeeds
+     */
+    void OnOrderSent(int index, int signed_quantity) {
+        m_entries[index].pending += signed_quantity;
+    }
+
+    /**
+     * Moves fills from pending into position, and drops whatever an order left unfilled when it
+     * completes. Fills for an order are delivered before the update that completes it, so the
+     * order's leaves quantity is final by then.
+     */
+    void OnOrderUpdate(int index, const OrderUpdateEventMsg& msg) {
+        Entry& entry = m_entries[index];
+        if (msg.fill_occurred()) {
+            int filled = msg.fill()->fill_size();
+            entry.position += filled;
+            entry.pending -= filled;
+        }
+        if (msg.completes_order()) {
+            int leaves = static_cast<int>(msg.order().leaves_quantity());
+            entry.pending -= IsBuySide(msg.order().order_side()) ? leaves : -leaves;
+        }
+    }
+
+    int position(int index) const { return m_entries[index].position; }
+    int pending(int index) const { return m_entries[index].pending; }
+
+    /**
+     * Where the position ends up once everything in flight fills
+     */
+    int expected_position(int index) const { return m_entries[index].position + m_entries[index].pending; }
+
+    size_t size() const { return m_entries.size(); }
+
+private:
+    std::vector<Entry> m_entries;
+};
+
+#endif
@@ -0,0 +1,215 @@
+#pragma once
+
+#ifndef _STRATEGY_STUDIO_LIB_EXAMPLES_RISK_GATE_H_
+#define _STRATEGY_STUDIO_LIB_EXAMPLES_RISK_GATE_H_
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <vector>
+
+/**
+ * Send time that is always more than a second before any event time
+ */
+const int64_t RISK_GATE_NEVER = INT64_MIN / 2;
+
+enum RiskCheckResult {
+    RISK_CHECK_OK = 0,
+    RISK_CHECK_ORDER_SIZE,
+    RISK_CHECK_INSTRUMENT_NOTIONAL,
+    RISK_CHECK_STRATEGY_NOTIONAL,
+    RISK_CHECK_ORDER_RATE,
+    RISK_CHECK_NET_EXPOSURE,
+    NUM_RISK_CHECK_RESULTS
+};
+
+inline const char* RiskCheckName(RiskCheckResult result) {
+    static const char* names[NUM_RISK_CHECK_RESULTS] = {
+        "ok", "order size", "instrument notional", "strategy notional", "order rate", "net exposure"
+    };
+    return names[result];
+}
+
+/**
+ * Pre-trade limits. Zero disables a limit.
+ */
+struct RiskLimits {
+    RiskLimits():
+        max_order_size(0),
+        max_instrument_notional(0),
+        max_strategy_notional(0),
+        max_orders_per_second(0),
+        max_net_exposure(0)
+    {
+    }
+
+    int max_order_size;                 // shares per order
+    double max_instrument_notional;     // |position after the order| x price, per instrument
+    double max_strategy_notional;       // sum over instruments of |position| x last price
+    int max_orders_per_second;          // new orders in any one second of event time
+    double max_net_exposure;            // |sum of weight x position x price|; for hedged baskets
+};
+
+/**
+ * Pre-trade risk checks in front of a strategy's SendNewOrder calls.
+ *
+ * Everything is answered from local state: positions come from the fills the strategy feeds in,
+ * gross and weighted net notional are kept as running sums, and the order rate is a ring of the
+ * last max_orders_per_second send times. A check is a handful of multiplies and compares, with no
+ * calls back into the server. Instruments are addressed by the strategy's dense instrument index.
+ *
+ * The net exposure check is for baskets meant to stay hedged (a leveraged product against its
+ * underlying): each instrument carries a weight, and an order is refused only if it would push the
+ * weighted net notional past the limit and further from zero, so hedging legs always go through.
+ *
+ * The gate does not keep a copy of the limits: it reads them through a pointer into the strategy's
+ * published config (see ConfigSnapshot), repointed after every publish, so there is one source of
+ * truth for them.
+ */
+class RiskGate {
+public:
+    RiskGate(): m_limits(&m_no_limits), m_now(0), m_gross_notional(0), m_net_notional(0), m_rate_head(0) {
+        for (int i = 0; i < NUM_RISK_CHECK_RESULTS; ++i) {
+            m_checks[i] = 0;
+        }
+    }
+
+    /**
+     * Points the gate at the limits to enforce, which must stay valid until the next call. The order
+     * rate ring is rebuilt only when max_orders_per_second changes, so the send times of the last
+     * second survive edits to the other limits.
+     */
+    void set_limits(const RiskLimits* limits) {
+        size_t rate = limits->max_orders_per_second > 0 ? limits->max_orders_per_second : 0;
+        m_limits = limits;
+        if (rate != m_send_times.size()) {
+            m_send_times.assign(rate, RISK_GATE_NEVER);
+            m_rate_head = 0;
+        }
+    }
+
+    const RiskLimits& limits() const { return *m_limits; }
+
+    /**
+     * Sizes the ledger for num_instruments and zeroes every position
+     */
+    void Reset(size_t num_instruments) {
+        m_slots.assign(num_instruments, Slot());
+        m_gross_notional = 0;
+        m_net_notional = 0;
+        m_send_times.assign(m_send_times.size(), RISK_GATE_NEVER);
+        m_rate_head = 0;
+    }
+
+    /**
+     * Weight of an instrument in the net exposure sum, e.g. its leverage; 0 leaves it out
+     */
+    void set_weight(int index, double weight) {
+        Slot& slot = m_slots[index];
+        m_net_notional -= slot.weight * slot.position * slot.mark;
+        slot.weight = weight;
+        m_net_notional += slot.weight * slot.position * slot.mark;
+    }
+
+    /**
+     * Event time in microseconds, used by the order rate limit
+     */
+    void set_time(int64_t now_micros) { m_now = now_micros; }
+
+    /**
+     * Whether a new order for signed_quantity (positive to buy) at price may go out now
+     */
+    RiskCheckResult Check(int index, int signed_quantity, double price) {
+        RiskCheckResult result = Evaluate(index, signed_quantity, price);
+        ++m_checks[result];
+        return result;
+    }
+
+    /**
+     * Records an order that passed Check and was sent
+     */
+    void OnOrderSent() {
+        if (!m_send_times.empty()) {
+            m_send_times[m_rate_head] = m_now;
+            if (++m_rate_head == m_send_times.size()) {
+                m_rate_head = 0;
+            }
+        }
+    }
+
+    void OnFill(int index, int signed_quantity, double price) {
+        Slot& slot = m_slots[index];
+        m_gross_notional -= fabs(slot.position * slot.mark);
+        m_net_notional -= slot.weight * slot.position * slot.mark;
+        slot.position += signed_quantity;
+        slot.mark = price;
+        m_gross_notional += fabs(slot.position * slot.mark);
+        m_net_notional += slot.weight * slot.position * slot.mark;
+    }
+
+    int position(int index) const { return m_slots[index].position; }
+    double gross_notional() const { return m_gross_notional; }
+    double net_notional() const { return m_net_notional; }
+
+    /**
+     * Orders refused for a reason since construction; RISK_CHECK_OK counts the orders let through
+     */
+    unsigned long long checks(RiskCheckResult result) const { return m_checks[result]; }
+
+private:
+    struct Slot {
+        Slot(): position(0), mark(0), weight(0) {}
+
+        int position;
+        double mark;
+        double weight;
+    };
+
+    RiskCheckResult Evaluate(int index, int signed_quantity, double price) const {
+        const Slot& slot = m_slots[index];
+
+        if (m_limits->max_order_size > 0 && abs(signed_quantity) > m_limits->max_order_size) {
+            return RISK_CHECK_ORDER_SIZE;
+        }
+
+        // orders that shrink the position are never held back by the notional caps
+        bool increases = abs(slot.position + signed_quantity) > abs(slot.position);
+        double after = fabs((slot.position + signed_quantity) * price);
+        if (increases && m_limits->max_instrument_notional > 0 && after >= m_limits->max_instrument_notional) {
+            return RISK_CHECK_INSTRUMENT_NOTIONAL;
+        }
+
+        if (increases && m_limits->max_strategy_notional > 0
+            && m_gross_notional - fabs(slot.position * slot.mark) + after > m_limits->max_strategy_notional) {
+            return RISK_CHECK_STRATEGY_NOTIONAL;
+        }
+
+        if (m_limits->max_net_exposure > 0 && slot.weight != 0) {
+            double net = m_net_notional + slot.weight * signed_quantity * price;
+            if (fabs(net) > m_limits->max_net_exposure && fabs(net) > fabs(m_net_notional)) {
+                return RISK_CHECK_NET_EXPOSURE;
+            }
+        }
+
+        // the oldest of the last max_orders_per_second sends must be at least a second old
+        if (!m_send_times.empty() && m_now - m_send_times[m_rate_head] < 1000000) {
+            return RISK_CHECK_ORDER_RATE;
+        }
+
+        return RISK_CHECK_OK;
+    }
+
+private:
+    RiskLimits m_no_limits;
+    const RiskLimits* m_limits;
+    std::vector<Slot> m_slots;
+    std::vector<int64_t> m_send_times;  // ring of the last max_orders_per_second send times
+    int64_t m_now;
+    double m_gross_notional;
+    double m_net_notional;
+    size_t m_rate_head;
+    unsigned long long m_checks[NUM_RISK_CHECK_RESULTS];
+};
+
+#endif
@@ -0,0 +1,204 @@
+#pragma once
+
+#ifndef _STRATEGY_STUDIO_LIB_EXAMPLES_ROLLING_STATS_H_
+#define _STRATEGY_STUDIO_LIB_EXAMPLES_ROLLING_STATS_H_
+
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+
+#include <vector>
+
+/**
+ * Everything a RollingStats holds besides its values, as a warm-start snapshot stores it
+ */
+struct RollingStatsState {
+    int32_t window;
+    int32_t size;
+    double mean;
+    double m2;
+    double ewma;
+    double last;
+};
+
+/**
+ * Capacity of a RollingStats whose ring is allocated once, at construction, to exactly the window
+ */
+const int ROLLING_STATS_DYNAMIC = 0;
+
+/**
+ * The ring of a RollingStats: inline when the capacity is fixed at compile time, on the heap and
+ * as long as the window when it is ROLLING_STATS_DYNAMIC
+ */
+template <int Capacity>
+struct RollingStatsRing {
+    explicit RollingStatsRing(int) {}
+
+    double& operator[](int i) { return values[i]; }
+    double operator[](int i) const { return values[i]; }
+
+    double values[Capacity];
+};
+
+template <>
+struct RollingStatsRing<ROLLING_STATS_DYNAMIC> {
+    explicit RollingStatsRing(int window): values(window) {}
+
+    double& operator[](int i) { return values[i]; }
+    double operator[](int i) const { return values[i]; }
+
+    std::vector<double> values;
+};
+
+/**
+ * Rolling mean, variance, z-score and EWMA over the last `window` values, updated in constant time.
+ *
+ * Values live in a ring buffer that is never rescanned: each push adds the new value and retires
+ * the oldest with Welford's sliding-window update, which stays stable where running sums of squares
+ * would not. With a compile-time Capacity the ring is inline and the window may be anything up to
+ * it; with ROLLING_STATS_DYNAMIC the ring is allocated to the window at construction. Either way
+ * nothing allocates after construction. Callers validate the window (see valid_window): an out of
+ * range window is a programming error, asserted in debug builds and clamped otherwise.
+ */
+template <int Capacity>
+class RollingStats {
+public:
+    static_assert(Capacity >= 0, "RollingStats needs a positive capacity or ROLLING_STATS_DYNAMIC");
+
+    explicit RollingStats(int window = (Capacity > 0) ? Capacity : 1):
+        m_values(Clamp(window))
+    {
+        assert(valid_window(window));
+        m_window = Clamp(window);
+        m_alpha = 2.0 / (m_window + 1);
+        Reset();
+    }
+
+    /**
+     * Whether a window of this length fits the ring
+     */
+    static bool valid_window(int window) {
+        return window >= 1 && (Capacity == ROLLING_STATS_DYNAMIC || window <= Capacity);
+    }
+
+    void Reset() {
+        m_head = 0;
+        m_size = 0;
+        m_mean = 0;
+        m_m2 = 0;
+        m_ewma = 0;
+        m_last = 0;
+    }
+
+    void Push(double x) {
+        if (m_size < m_window) {
+            ++m_size;
+            double delta = x - m_mean;
+            m_mean += delta / m_size;
+            m_m2 += delta * (x - m_mean);
+            m_ewma = (m_size == 1) ? x : m_ewma + m_alpha * (x - m_ewma);
+        } else {
+            double old = m_values[m_head];
+            double old_mean = m_mean;
+            m_mean += (x - old) / m_size;
+            m_m2 += (x - old) * (x - m_mean + old - old_mean);
+            if (m_m2 < 0) {
+                m_m2 = 0;
+            }
+            m_ewma += m_alpha * (x - m_ewma);
+        }
+
+        m_values[m_head] = x;
+        if (++m_head == m_window) {
+            m_head = 0;
+        }
+        m_last = x;
+    }
+
+    int window() const { return m_window; }
+    int size() const { return m_size; }
+    bool full() const { return m_size == m_window; }
+
+    double last() const { return m_last; }
+    double mean() const { return m_mean; }
+    double ewma() const { return m_ewma; }
+
+    /**
+     * Sample variance of the values in the window
+     */
+    double variance() const { return (m_size > 1) ? m_m2 / (m_size - 1) : 0.0; }
+    double stddev() const { return sqrt(variance()); }
+
+    /**
+     * Distance of x from the window mean in standard deviations; 0 while the window has no spread
+     */
+    double zscore(double x) const {
+        double sd = stddev();
+        return (sd > 0) ? (x - m_mean) / sd : 0.0;
+    }
+
+    RollingStatsState state() const {
+        RollingStatsState s;
+        s.window = m_window;
+        s.size = m_size;
+        s.mean = m_mean;
+        s.m2 = m_m2;
+        s.ewma = m_ewma;
+        s.last = m_last;
+        return s;
+    }
+
+    /**
+     * Copies the values in the window to out, oldest first; returns size()
+     */
+    int CopyValues(double* out) const {
+        int oldest = full() ? m_head : 0;
+        for (int i = 0; i < m_size; ++i) {
+            int slot = oldest + i;
+            out[i] = m_values[(slot < m_window) ? slot : slot - m_window];
+        }
+        return m_size;
+    }
+
+    /**
+     * Picks up from a saved state and its values, oldest first. With the same window the statistics
+     * continue exactly as if no restart happened; with a different one the newest values that fit
+     * are pushed again, which rebuilds the mean and variance but restarts the EWMA from them.
+     */
+    void Restore(const RollingStatsState& s, const double* values) {
+        Reset();
+        if (s.window == m_window && s.size >= 0 && s.size <= m_window) {
+            for (int i = 0; i < s.size; ++i) {
+                m_values[i] = values[i];
+            }
+            m_size = s.size;
+            m_head = (s.size == m_window) ? 0 : s.size;
+            m_mean = s.mean;
+            m_m2 = s.m2;
+            m_ewma = s.ewma;
+            m_last = s.last;
+            return;
+        }
+        int first = (s.size > m_window) ? s.size - m_window : 0;
+        for (int i = first; i < s.size; ++i) {
+            Push(values[i]);
+        }
+    }
+
+private:
+    static int Clamp(int window) {
+        return (window < 1) ? 1 : ((Capacity != ROLLING_STATS_DYNAMIC && window > Capacity) ? Capacity : window);
+    }
+
+    RollingStatsRing<Capacity> m_values;
+    int m_window;
+    int m_head;
+    int m_size;
+    double m_alpha;
+    double m_mean;
+    double m_m2;
+    double m_ewma;
+    double m_last;
+};
+
+#endif
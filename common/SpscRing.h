@@ -0,0 +1,68 @@
+#pragma once
+
+#ifndef _STRATEGY_STUDIO_LIB_EXAMPLES_SPSC_RING_H_
+#define _STRATEGY_STUDIO_LIB_EXAMPLES_SPSC_RING_H_
+
+#include <atomic>
+#include <stddef.h>
+
+/**
+ * Bounded lock-free single-producer/single-consumer ring of trivially copyable records.
+ *
+ * The producer and consumer indices sit on separate cache lines and each side keeps a cached copy
+ * of the other's index, so in the common case a push or pop touches no shared line. The producer
+ * never blocks: TryPush returns false when the ring is full.
+ */
+template <typename T, size_t Capacity>
+class SpscRing {
+public:
+    static_assert((Capacity & (Capacity - 1)) == 0, "SpscRing capacity must be a power of two");
+
+    SpscRing(): m_head(0), m_cachedTail(0), m_tail(0), m_cachedHead(0) {}
+
+    bool TryPush(const T& item) {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_cachedTail == Capacity) {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head - m_cachedTail == Capacity) {
+                return false;
+            }
+        }
+        m_items[head & (Capacity - 1)] = item;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool TryPop(T* item) {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_cachedHead) {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (tail == m_cachedHead) {
+                return false;
+            }
+        }
+        *item = m_items[tail & (Capacity - 1)];
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool Empty() const {
+        return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+    }
+
+private:
+    SpscRing(const SpscRing&);
+    SpscRing& operator=(const SpscRing&);
+
+    // producer side
+    alignas(64) std::atomic<size_t> m_head;
+    size_t m_cachedTail;
+
+    // consumer side
+    alignas(64) std::atomic<size_t> m_tail;
+    size_t m_cachedHead;
+
+    alignas(64) T m_items[Capacity];
+};
+
+#endif
@@ -0,0 +1,48 @@
+#pragma once
+
+#ifndef _STRATEGY_STUDIO_LIB_EXAMPLES_TOKEN_BUCKET_H_
+#define _STRATEGY_STUDIO_LIB_EXAMPLES_TOKEN_BUCKET_H_
+
+#include <stdint.h>
+
+#include <algorithm>
+
+/**
+ * Message rate limiter on event time: tokens accrue at rate per second up to burst, and each
+ * message takes one. Unlike the risk gate's order rate ring it smooths a burst out over time
+ * instead of refusing everything once the window is full. A rate of 0 disables the limit.
+ * Times are microseconds, as JournalTime gives them.
+ *
+ * The bucket holds only its fill level; the rate and burst are passed on every take, straight from
+ * the strategy's published config, so a param change applies to the next take without resetting
+ * the tokens already spent. The bucket starts full.
+ */
+class TokenBucket {
+public:
+    TokenBucket(): m_tokens(-1), m_last(0) {}
+
+    bool TryTake(int64_t now_micros, double rate_per_second, int burst) {
+        if (rate_per_second <= 0) {
+            return true;
+        }
+        double capacity = std::max(1, burst);
+        if (m_tokens < 0) {
+            m_tokens = capacity;
+        } else if (now_micros > m_last) {
+            m_tokens += (now_micros - m_last) * rate_per_second * 1e-6;
+        }
+        m_tokens = std::min(capacity, m_tokens);
+        m_last = std::max(m_last, now_micros);
+        if (m_tokens < 1) {
+            return false;
+        }
+        m_tokens -= 1;
+        return true;
+    }
+
+private:
+    double m_tokens;    // negative until the first take
+    int64_t m_last;
+};
+
+#endif
@@ -0,0 +1,44 @@
+#pragma once
+
+#ifndef _STRATEGY_STUDIO_LIB_EXAMPLES_VENUE_ROUTING_H_
+#define _STRATEGY_STUDIO_LIB_EXAMPLES_VENUE_ROUTING_H_
+
+#include <ExecutionTypes.h>
+#include <MarketModels/Instrument.h>
+
+using namespace RCM::StrategyStudio;
+
+/**
+ * Where orders for each instrument type are routed, as compile-time constants
+ */
+template <MarketModels::InstrumentType Type>
+struct VenueRouting {
+    static const MarketCenterID market_center = MARKET_CENTER_ID_CME_GLOBEX;
+};
+
+template <>
+struct VenueRouting<MarketModels::INSTRUMENT_TYPE_EQUITY> {
+    static const MarketCenterID market_center = MARKET_CENTER_ID_NASDAQ;
+};
+
+template <>
+struct VenueRouting<MarketModels::INSTRUMENT_TYPE_OPTION> {
+    static const MarketCenterID market_center = MARKET_CENTER_ID_CBOE_OPTIONS;
+};
+
+/**
+ * The venue for an instrument type known only at runtime. Strategies resolve this once per
+ * instrument at registration rather than on every order.
+ */
+inline MarketCenterID RouteForInstrument(MarketModels::InstrumentType type) {
+    switch (type) {
+        case MarketModels::INSTRUMENT_TYPE_EQUITY:
+            return VenueRouting<MarketModels::INSTRUMENT_TYPE_EQUITY>::market_center;
+        case MarketModels::INSTRUMENT_TYPE_OPTION:
+            return VenueRouting<MarketModels::INSTRUMENT_TYPE_OPTION>::market_center;
+        default:
+            return VenueRouting<MarketModels::INSTRUMENT_TYPE_FUTURE>::market_center;
+    }
+}
+
+#endif
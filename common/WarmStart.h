@@ -0,0 +1,388 @@
+#pragma once
+
+#ifndef _STRATEGY_STUDIO_LIB_EXAMPLES_WARM_START_H_
+#define _STRATEGY_STUDIO_LIB_EXAMPLES_WARM_START_H_
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Binary warm-start snapshot of a strategy's market-derived state, so a restarted strategy picks up
+ * its rolling windows and anchors where it left off instead of warming them up again.
+ *
+ * Little-endian, every entry on an 8 byte boundary:
+ *
+ *   WarmStartHeader
+ *   entries        WarmStartEntry followed by bytes of state, padded to 8
+ *
+ * Entries are keyed by symbol, so a snapshot still restores after the symbol set gains, loses or
+ * reorders instruments; the entry with an empty symbol holds strategy-wide state. What goes in an
+ * entry is up to the strategy, which reads it back in the order it wrote it.
+ */
+const char WARM_START_MAGIC[8] = {'S', 'S', 'W', 'A', 'R', 'M', '0', '1'};
+const uint32_t WARM_START_VERSION = 1;
+const size_t WARM_START_SYMBOL_LEN = 32;
+
+struct WarmStartHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t num_entries;
+    char strategy[24];          // the strategy type that wrote it, NUL padded
+    int64_t time_micros;        // event time the snapshot was taken at
+    uint64_t payload_bytes;     // everything after the header
+    uint64_t checksum;          // FNV-1a of the payload
+};
+
+struct WarmStartEntry {
+    char symbol[WARM_START_SYMBOL_LEN];
+    uint32_t bytes;             // state bytes that follow, before padding
+    uint32_t reserved;
+};
+
+static_assert(sizeof(WarmStartHeader) == 64, "warm start header layout changed; bump WARM_START_VERSION");
+static_assert(sizeof(WarmStartEntry) == 40, "warm start entry layout changed; bump WARM_START_VERSION");
+
+inline uint64_t WarmStartChecksum(const char* data, size_t len) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < len; ++i) {
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+/**
+ * Takes snapshots on the strategy thread and writes them from a background thread.
+ *
+ * The strategy copies its state into a buffer sized once by Open, between Begin and Commit; that is
+ * plain stores with no allocation. Commit hands the buffer to the writer thread, which checksums it
+ * and replaces the file through a temporary and a rename, so a crash mid-write leaves the previous
+ * snapshot intact. While the writer still holds the last snapshot, Begin returns false and the new
+ * one is skipped; a snapshot that outgrows the buffer is dropped at Commit. Both are counted.
+ */
+class WarmStartWriter {
+public:
+    WarmStartWriter(): m_used(0), m_entryStart(0), m_entries(0), m_entry(NULL), m_overflow(false), m_running(false),
+        m_pending(false), m_written(0), m_skipped(0) {}
+
+    ~WarmStartWriter() {
+        Close();
+    }
+
+    /**
+     * Starts the writer thread for snapshots of up to capacity bytes of entries
+     */
+    void Open(const std::string& path, const char* strategy, size_t capacity) {
+        Close();
+        m_path = path;
+        memset(&m_header, 0, sizeof(m_header));
+        memcpy(m_header.magic, WARM_START_MAGIC, sizeof(m_header.magic));
+        m_header.version = WARM_START_VERSION;
+        strncpy(m_header.strategy, strategy, sizeof(m_header.strategy) - 1);
+        m_staging.assign(capacity, 0);
+        m_writing.assign(capacity, 0);
+        m_written.store(0, std::memory_order_relaxed);
+        m_skipped = 0;
+        m_pending.store(false, std::memory_order_release);
+        m_running.store(true, std::memory_order_release);
+        m_writer = std::thread(&WarmStartWriter::WriterLoop, this);
+    }
+
+    /**
+     * Writes out a snapshot still pending, then stops the writer
+     */
+    void Close() {
+        if (!m_writer.joinable()) {
+            return;
+        }
+        m_running.store(false, std::memory_order_release);
+        m_writer.join();
+    }
+
+    bool is_open() const { return m_writer.joinable(); }
+    uint64_t written() const { return m_written.load(std::memory_order_relaxed); }
+    uint64_t skipped() const { return m_skipped; }
+
+    /**
+     * Starts a snapshot; false when the previous one is still being written
+     */
+    bool Begin(int64_t time_micros) {
+        if (!is_open() || m_pending.load(std::memory_order_acquire)) {
+            ++m_skipped;
+            return false;
+        }
+        m_header.time_micros = time_micros;
+        m_used = 0;
+        m_entries = 0;
+        m_entry = NULL;
+        m_overflow = false;
+        return true;
+    }
+
+    /**
+     * Starts the next entry; an empty symbol is the strategy-wide entry. Symbols longer than
+     * WARM_START_SYMBOL_LEN - 1 are truncated.
+     */
+    void BeginEntry(const std::string& symbol) {
+        EndEntry();
+        m_entry = static_cast<WarmStartEntry*>(Reserve(sizeof(WarmStartEntry)));
+        if (m_entry == NULL) {
+            return;
+        }
+        memset(m_entry, 0, sizeof(WarmStartEntry));
+        memcpy(m_entry->symbol, symbol.data(), std::min(symbol.size(), WARM_START_SYMBOL_LEN - 1));
+        m_entryStart = m_used;
+        ++m_entries;
+    }
+
+    template <typename T>
+    void Put(const T& value) {
+        PutBytes(&value, sizeof(T));
+    }
+
+    void PutArray(const double* values, size_t n) {
+        PutBytes(values, n * sizeof(double));
+    }
+
+    /**
+     * Hands the snapshot to the writer thread
+     */
+    void Commit() {
+        EndEntry();
+        if (m_overflow) {
+            ++m_skipped;
+            return;
+        }
+        m_header.num_entries = m_entries;
+        m_header.payload_bytes = m_used;
+        m_staging.swap(m_writing);
+        m_writingHeader = m_header;
+        m_pending.store(true, std::memory_order_release);
+    }
+
+private:
+    WarmStartWriter(const WarmStartWriter&);
+    WarmStartWriter& operator=(const WarmStartWriter&);
+
+    void* Reserve(size_t bytes) {
+        if (m_overflow || m_used + bytes > m_staging.size()) {
+            m_overflow = true;
+            return NULL;
+        }
+        void* p = &m_staging[m_used];
+        m_used += bytes;
+        return p;
+    }
+
+    void PutBytes(const void* data, size_t bytes) {
+        void* p = Reserve(bytes);
+        if (p != NULL) {
+            memcpy(p, data, bytes);
+        }
+    }
+
+    void EndEntry() {
+        if (m_entry == NULL || m_overflow) {
+            m_entry = NULL;
+            return;
+        }
+        m_entry->bytes = static_cast<uint32_t>(m_used - m_entryStart);
+        size_t padding = (8 - m_used % 8) % 8;
+        if (padding > 0 && Reserve(padding) != NULL) {
+            memset(&m_staging[m_used - padding], 0, padding);
+        }
+        m_entry = NULL;
+    }
+
+    void WriterLoop() {
+        for (;;) {
+            bool running = m_running.load(std::memory_order_acquire);
+            if (m_pending.load(std::memory_order_acquire)) {
+                Write();
+                m_pending.store(false, std::memory_order_release);
+            } else if (!running) {
+                break;
+            } else {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+    }
+
+    void Write() {
+        WarmStartHeader header = m_writingHeader;
+        header.checksum = WarmStartChecksum(&m_writing[0], header.payload_bytes);
+        std::string tmp = m_path + ".tmp";
+        FILE* file = fopen(tmp.c_str(), "wb");
+        if (file == NULL) {
+            return;
+        }
+        bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                  fwrite(&m_writing[0], 1, header.payload_bytes, file) == header.payload_bytes;
+        ok = (fclose(file) == 0) && ok;
+        if (ok && rename(tmp.c_str(), m_path.c_str()) == 0) {
+            m_written.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    std::string m_path;
+    std::vector<char> m_staging;        // strategy thread
+    std::vector<char> m_writing;        // writer thread while pending
+    WarmStartHeader m_header;
+    WarmStartHeader m_writingHeader;
+    size_t m_used;
+    size_t m_entryStart;
+    uint32_t m_entries;
+    WarmStartEntry* m_entry;
+    bool m_overflow;
+    std::thread m_writer;
+    std::atomic<bool> m_running;
+    std::atomic<bool> m_pending;
+    std::atomic<uint64_t> m_written;
+    uint64_t m_skipped;
+};
+
+/**
+ * Reads one entry's state back in the order it was written; every read fails once the entry is used up
+ */
+class WarmStartCursor {
+public:
+    WarmStartCursor(): m_data(NULL), m_left(0) {}
+    WarmStartCursor(const char* data, size_t bytes): m_data(data), m_left(bytes) {}
+
+    template <typename T>
+    bool Get(T* value) {
+        return GetBytes(value, sizeof(T));
+    }
+
+    bool GetArray(double* values, size_t n) {
+        return GetBytes(values, n * sizeof(double));
+    }
+
+private:
+    bool GetBytes(void* out, size_t bytes) {
+        if (bytes > m_left) {
+            m_left = 0;
+            return false;
+        }
+        memcpy(out, m_data, bytes);
+        m_data += bytes;
+        m_left -= bytes;
+        return true;
+    }
+
+    const char* m_data;
+    size_t m_left;
+};
+
+/**
+ * A snapshot file mapped read-only for the length of a restore
+ */
+class WarmStartReader {
+public:
+    WarmStartReader(): m_base(MAP_FAILED), m_length(0), m_header(NULL) {}
+
+    ~WarmStartReader() {
+        Close();
+    }
+
+    /**
+     * Maps path and indexes its entries. False, leaving nothing to restore, when there is no file or
+     * it is not a complete snapshot written by this strategy type.
+     */
+    bool Open(const std::string& path, const char* strategy) {
+        Close();
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(WarmStartHeader)) {
+            close(fd);
+            return false;
+        }
+        m_length = st.st_size;
+        m_base = mmap(NULL, m_length, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (m_base == MAP_FAILED) {
+            return false;
+        }
+
+        const char* base = static_cast<const char*>(m_base);
+        const WarmStartHeader* header = reinterpret_cast<const WarmStartHeader*>(base);
+        const char* payload = base + sizeof(WarmStartHeader);
+        if (memcmp(header->magic, WARM_START_MAGIC, sizeof(header->magic)) != 0 || header->version != WARM_START_VERSION ||
+            strncmp(header->strategy, strategy, sizeof(header->strategy)) != 0 ||
+            header->payload_bytes != m_length - sizeof(WarmStartHeader) ||
+            header->checksum != WarmStartChecksum(payload, header->payload_bytes)) {
+            Close();
+            return false;
+        }
+
+        size_t offset = 0;
+        for (uint32_t i = 0; i < header->num_entries; ++i) {
+            if (offset + sizeof(WarmStartEntry) > header->payload_bytes) {
+                Close();
+                return false;
+            }
+            const WarmStartEntry* entry = reinterpret_cast<const WarmStartEntry*>(payload + offset);
+            offset += sizeof(WarmStartEntry);
+            if (offset + entry->bytes > header->payload_bytes) {
+                Close();
+                return false;
+            }
+            std::string symbol(entry->symbol, strnlen(entry->symbol, WARM_START_SYMBOL_LEN));
+            m_entries[symbol] = entry;
+            offset += (entry->bytes + 7) / 8 * 8;
+        }
+        m_header = header;
+        return true;
+    }
+
+    void Close() {
+        if (m_base != MAP_FAILED) {
+            munmap(m_base, m_length);
+            m_base = MAP_FAILED;
+        }
+        m_entries.clear();
+        m_header = NULL;
+    }
+
+    bool is_open() const { return m_header != NULL; }
+    int64_t time_micros() const { return m_header ? m_header->time_micros : 0; }
+
+    /**
+     * The entry for symbol; "" finds the strategy-wide entry
+     */
+    bool Find(const std::string& symbol, WarmStartCursor* cursor) const {
+        std::map<std::string, const WarmStartEntry*>::const_iterator it = m_entries.find(symbol);
+        if (it == m_entries.end()) {
+            return false;
+        }
+        *cursor = WarmStartCursor(reinterpret_cast<const char*>(it->second + 1), it->second->bytes);
+        return true;
+    }
+
+private:
+    WarmStartReader(const WarmStartReader&);
+    WarmStartReader& operator=(const WarmStartReader&);
+
+    void* m_base;
+    size_t m_length;
+    const WarmStartHeader* m_header;
+    std::map<std::string, const WarmStartEntry*> m_entries;
+};
+
+#endif
@@ -0,0 +1,383 @@
+#pragma once
+
+#ifndef _STRATEGY_STUDIO_LIB_EXAMPLES_LEG_BASKET_H_
+#define _STRATEGY_STUDIO_LIB_EXAMPLES_LEG_BASKET_H_
+
+#include <MarketModels/Instrument.h>
+
+#include <math.h>
+#include <stdint.h>
+
+#include <algorithm>
+
+using namespace RCM::StrategyStudio;
+
+/**
+ * Most legs one strategy instance evaluates together. The kernels always run over every lane so
+ * the compiler can vectorize them with a fixed trip count; unused lanes are inert.
+ */
+const int LEV_ARB_MAX_LEGS = 8;
+
+/**
+ * Furthest an estimated hedge ratio may drift from the leg's nominal leverage, as a fraction of it.
+ * Keeps a noisy estimate from ever flipping a leg's sign or zeroing its hedge.
+ */
+const double LEV_ARB_MAX_HEDGE_DRIFT = 0.5;
+
+/**
+ * What a warm-start snapshot keeps of a leg: the previous synchronized close, the tick mode anchor
+ * and the hedge fit
+ */
+struct LegWarmState {
+    double nominal;
+    double close;
+    double last;
+    double change;
+    double inv_anchor;
+    double hedge_sxx;
+    double hedge_sxy;
+    double hedge_weight;
+    int32_t anchored;
+    int32_t reserved;
+};
+
+/**
+ * A family of leveraged products on one underlying, held as flat per-leg arrays.
+ *
+ * Leg 0 is the underlying. Every other leg carries its leverage ratio (3, 2, -1, -3, ...) and is
+ * compared against ratio times the underlying's return each time all legs have closed a bar.
+ *
+ * With hedge estimation on, ratio is the live estimate of each product's beta to the underlying
+ * rather than its nominal leverage; see EnableHedgeEstimation.
+ */
+struct LegBasket {
+    LegBasket() {
+        Clear();
+    }
+
+    void Clear() {
+        for (int i = 0; i < LEV_ARB_MAX_LEGS; ++i) {
+            instrument[i] = NULL;
+            ratio[i] = 0;
+            nominal[i] = 0;
+            active[i] = 0;
+            close[i] = 1;
+            last[i] = 1;
+            change[i] = 0;
+            desired[i] = 0;
+            inv_anchor[i] = 0;
+            hedge_sxx[i] = 0;
+            hedge_sxy[i] = 0;
+            hedge_weight[i] = 0;
+            hedge_lo[i] = 0;
+            hedge_hi[i] = 0;
+        }
+        hedge_forgetting = 0;
+        hedge_warmup = 0;
+        num_legs = 0;
+        anchored_mask = 0;
+        bar_mask = 0;
+        full_mask = 0;
+        primed = false;
+    }
+
+    /**
+     * Appends a leg and returns its index; the first leg added is the underlying
+     */
+    int AddLeg(const MarketModels::Instrument* inst, double leg_ratio) {
+        int leg = num_legs++;
+        instrument[leg] = inst;
+        ratio[leg] = (leg == 0) ? 1 : leg_ratio;
+        nominal[leg] = ratio[leg];
+        active[leg] = (leg == 0) ? 0 : 1;
+        full_mask |= 1u << leg;
+        return leg;
+    }
+
+    /**
+     * Starts estimating every product's hedge ratio online instead of trusting its nominal leverage.
+     *
+     * Each product's ratio is the least squares beta of its returns on the underlying's, fitted with
+     * exponential forgetting: older observations lose half their weight every halflife updates. The
+     * fit is kept as two discounted sums per leg, so an update is a few multiplies with no window to
+     * rescan. Until a leg has halflife updates behind it, or when halflife is 0, it keeps its nominal
+     * ratio; after that the estimate is held within LEV_ARB_MAX_HEDGE_DRIFT of nominal. Call after
+     * the legs are added.
+     */
+    void EnableHedgeEstimation(int halflife) {
+        hedge_forgetting = (halflife > 0) ? pow(0.5, 1.0 / halflife) : 0;
+        hedge_warmup = halflife;
+        for (int i = 0; i < LEV_ARB_MAX_LEGS; ++i) {
+            double a = nominal[i] * (1 - LEV_ARB_MAX_HEDGE_DRIFT);
+            double b = nominal[i] * (1 + LEV_ARB_MAX_HEDGE_DRIFT);
+            hedge_lo[i] = std::min(a, b);
+            hedge_hi[i] = std::max(a, b);
+            hedge_sxx[i] = 0;
+            hedge_sxy[i] = 0;
+            hedge_weight[i] = 0;
+            ratio[i] = nominal[i];
+        }
+    }
+
+    bool estimates_hedge() const { return hedge_forgetting > 0; }
+
+    /**
+     * Records a leg's bar close; returns true once every leg has closed a bar for this interval
+     */
+    bool OnBarClose(int leg, double bar_close) {
+        close[leg] = bar_close;
+        bar_mask |= 1u << leg;
+        if (bar_mask != full_mask) {
+            return false;
+        }
+        bar_mask = 0;
+        return true;
+    }
+
+    /**
+     * Updates every leg's return since the previous synchronized bar and sets its desired units:
+     * short when the leg ran ahead of band times ratio times the underlying, long when it fell behind.
+     */
+    void Evaluate(double trade_size, double band) {
+        EvaluateLanes<LEV_ARB_MAX_LEGS>(trade_size, band);
+    }
+
+    /**
+     * Evaluate over only the first Lanes legs; for a basket of exactly that many legs
+     */
+    template <int Lanes>
+    void EvaluateLanes(double trade_size, double band) {
+        static_assert(Lanes >= 2 && Lanes <= LEV_ARB_MAX_LEGS, "lane count out of range");
+        bool observed = primed;
+        if (primed) {
+            for (int i = 0; i < Lanes; ++i) {
+                change[i] = close[i] / last[i] - 1;
+            }
+        }
+        for (int i = 0; i < Lanes; ++i) {
+            last[i] = close[i];
+        }
+        primed = true;
+
+        double underlying_change = change[0];
+        for (int i = 0; i < Lanes; ++i) {
+            double side = (change[i] > band * ratio[i] * underlying_change) ? -trade_size :
+                          ((change[i] < -band * ratio[i] * underlying_change) ? trade_size : 0.0);
+            desired[i] = active[i] * side;
+        }
+
+        // the bar is judged against the ratios fitted before it, then joins the fit
+        if (observed && estimates_hedge()) {
+            UpdateHedgeLanes<Lanes>();
+        }
+    }
+
+    /**
+     * Evaluate for the classic one-product pair with the product's leverage fixed at compile time
+     */
+    template <int Ratio>
+    void EvaluatePair(double trade_size, double band) {
+        if (primed) {
+            change[0] = close[0] / last[0] - 1;
+            change[1] = close[1] / last[1] - 1;
+        }
+        last[0] = close[0];
+        last[1] = close[1];
+        primed = true;
+
+        double threshold = band * Ratio * change[0];
+        desired[0] = 0;
+        desired[1] = (change[1] > threshold) ? -trade_size : ((change[1] < -threshold) ? trade_size : 0.0);
+    }
+
+    /**
+     * Tick mode: records a leg's mid and its return against the leg's anchor, re-checks the legs the
+     * move can affect (all of them when the underlying moved) and returns true if any leg's desired
+     * units changed. The first quote of a leg becomes its anchor; nothing trades until every leg has one.
+     */
+    bool OnQuote(int leg, double mid, double trade_size, double band) {
+        unsigned bit = 1u << leg;
+        if (!(anchored_mask & bit)) {
+            inv_anchor[leg] = 1 / mid;
+            anchored_mask |= bit;
+        }
+        close[leg] = mid;
+        change[leg] = mid * inv_anchor[leg] - 1;
+        if (anchored_mask != full_mask) {
+            return false;
+        }
+
+        double underlying_change = change[0];
+        if (leg != 0) {
+            double side = (change[leg] > band * ratio[leg] * underlying_change) ? -trade_size :
+                          ((change[leg] < -band * ratio[leg] * underlying_change) ? trade_size : 0.0);
+            side *= active[leg];
+            bool changed = (side != desired[leg]);
+            desired[leg] = side;
+            if (estimates_hedge()) {
+                UpdateHedge(leg);
+            }
+            return changed;
+        }
+
+        int changed = 0;
+        for (int i = 0; i < LEV_ARB_MAX_LEGS; ++i) {
+            double side = (change[i] > band * ratio[i] * underlying_change) ? -trade_size :
+                          ((change[i] < -band * ratio[i] * underlying_change) ? trade_size : 0.0);
+            side *= active[i];
+            changed |= (side != desired[i]);
+            desired[i] = side;
+        }
+        return changed != 0;
+    }
+
+    /**
+     * Tick mode: moves every anchored leg's anchor to its latest mid, restarting the returns from zero
+     */
+    void Reanchor() {
+        for (int i = 0; i < LEV_ARB_MAX_LEGS; ++i) {
+            if (anchored_mask & (1u << i)) {
+                inv_anchor[i] = 1 / close[i];
+                change[i] = 0;
+            }
+        }
+    }
+
+    /**
+     * Tick mode: forgets every anchor so the next quotes set fresh ones
+     */
+    void ClearAnchors() {
+        anchored_mask = 0;
+        for (int i = 0; i < LEV_ARB_MAX_LEGS; ++i) {
+            change[i] = 0;
+            desired[i] = 0;
+        }
+    }
+
+    /**
+     * Folds the latest returns of legs [0, Lanes) into their hedge fits and refreshes their ratios
+     */
+    template <int Lanes>
+    void UpdateHedgeLanes() {
+        double x = change[0];
+        double xx = x * x;
+        for (int i = 0; i < Lanes; ++i) {
+            hedge_sxx[i] = hedge_forgetting * hedge_sxx[i] + xx;
+            hedge_sxy[i] = hedge_forgetting * hedge_sxy[i] + x * change[i];
+            hedge_weight[i] = hedge_forgetting * hedge_weight[i] + 1;
+        }
+        for (int i = 0; i < Lanes; ++i) {
+            ratio[i] = HedgeRatio(i);
+        }
+    }
+
+    /**
+     * Tick mode: folds one product's return against its anchor into its fit
+     */
+    void UpdateHedge(int leg) {
+        double x = change[0];
+        hedge_sxx[leg] = hedge_forgetting * hedge_sxx[leg] + x * x;
+        hedge_sxy[leg] = hedge_forgetting * hedge_sxy[leg] + x * change[leg];
+        hedge_weight[leg] = hedge_forgetting * hedge_weight[leg] + 1;
+        ratio[leg] = HedgeRatio(leg);
+    }
+
+    LegWarmState SaveLeg(int leg) const {
+        LegWarmState s;
+        s.nominal = nominal[leg];
+        s.close = close[leg];
+        s.last = last[leg];
+        s.change = change[leg];
+        s.inv_anchor = inv_anchor[leg];
+        s.hedge_sxx = hedge_sxx[leg];
+        s.hedge_sxy = hedge_sxy[leg];
+        s.hedge_weight = hedge_weight[leg];
+        s.anchored = (anchored_mask >> leg) & 1;
+        s.reserved = 0;
+        return s;
+    }
+
+    /**
+     * Picks a leg up where a snapshot left it; the hedge fit only when it was fitted with the same
+     * forgetting. Returns false, leaving the leg cold, if the leg's nominal leverage changed since.
+     */
+    bool RestoreLeg(int leg, const LegWarmState& s, bool hedge) {
+        if (s.nominal != nominal[leg]) {
+            return false;
+        }
+        close[leg] = s.close;
+        last[leg] = s.last;
+        change[leg] = s.change;
+        if (s.anchored) {
+            inv_anchor[leg] = s.inv_anchor;
+            anchored_mask |= 1u << leg;
+        }
+        if (hedge) {
+            hedge_sxx[leg] = s.hedge_sxx;
+            hedge_sxy[leg] = s.hedge_sxy;
+            hedge_weight[leg] = s.hedge_weight;
+            ratio[leg] = HedgeRatio(leg);
+        }
+        return true;
+    }
+
+    double HedgeRatio(int i) const {
+        // the effective sample count of a fit with forgetting f tends to 1 / (1 - f), about 1.44 x halflife
+        bool fitted = active[i] != 0 && hedge_weight[i] >= hedge_warmup && hedge_sxx[i] > 0;
+        return fitted ? std::min(std::max(hedge_sxy[i] / hedge_sxx[i], hedge_lo[i]), hedge_hi[i]) : nominal[i];
+    }
+
+    const MarketModels::Instrument* instrument[LEV_ARB_MAX_LEGS];
+    alignas(32) double ratio[LEV_ARB_MAX_LEGS];     // the hedge ratio in use: nominal, or the live estimate
+    alignas(32) double nominal[LEV_ARB_MAX_LEGS];   // the leverage the leg was added with
+    alignas(32) double active[LEV_ARB_MAX_LEGS];     // 1 for products, 0 for the underlying and unused lanes
+    alignas(32) double close[LEV_ARB_MAX_LEGS];
+    alignas(32) double last[LEV_ARB_MAX_LEGS];
+    alignas(32) double change[LEV_ARB_MAX_LEGS];
+    alignas(32) double desired[LEV_ARB_MAX_LEGS];
+    alignas(32) double inv_anchor[LEV_ARB_MAX_LEGS];   // tick mode: 1 / anchor mid
+    alignas(32) double hedge_sxx[LEV_ARB_MAX_LEGS];    // discounted sum of underlying return squared
+    alignas(32) double hedge_sxy[LEV_ARB_MAX_LEGS];    // discounted sum of underlying times leg return
+    alignas(32) double hedge_weight[LEV_ARB_MAX_LEGS]; // discounted count of observations
+    alignas(32) double hedge_lo[LEV_ARB_MAX_LEGS];
+    alignas(32) double hedge_hi[LEV_ARB_MAX_LEGS];
+    double hedge_forgetting;                           // 0 when the ratios are fixed at nominal
+    double hedge_warmup;
+    int num_legs;
+    unsigned bar_mask;
+    unsigned full_mask;
+    unsigned anchored_mask;
+    bool primed;
+};
+
+typedef void (LegBasket::*LegBasketEvaluator)(double trade_size, double band);
+
+/**
+ * The bar evaluator for a basket: a compile-time pair for the common leverages, a kernel sized to the
+ * leg count otherwise, and the full-width generic loop when specialized is false. A basket that
+ * estimates its hedge ratios never gets a compile-time pair, since its ratio is not a constant.
+ */
+inline LegBasketEvaluator SelectEvaluator(const LegBasket& basket, bool specialized) {
+    if (!specialized) {
+        return &LegBasket::Evaluate;
+    }
+    if (basket.num_legs == 2 && !basket.estimates_hedge()) {
+        double r = basket.ratio[1];
+        if (r == 3) return &LegBasket::EvaluatePair<3>;
+        if (r == 2) return &LegBasket::EvaluatePair<2>;
+        if (r == -1) return &LegBasket::EvaluatePair<-1>;
+        if (r == -2) return &LegBasket::EvaluatePair<-2>;
+        if (r == -3) return &LegBasket::EvaluatePair<-3>;
+    }
+    switch (basket.num_legs) {
+        case 2: return &LegBasket::EvaluateLanes<2>;
+        case 3: return &LegBasket::EvaluateLanes<3>;
+        case 4: return &LegBasket::EvaluateLanes<4>;
+        case 5: return &LegBasket::EvaluateLanes<5>;
+        case 6: return &LegBasket::EvaluateLanes<6>;
+        case 7: return &LegBasket::EvaluateLanes<7>;
+        default: return &LegBasket::Evaluate;
+    }
+}
+
+#endif
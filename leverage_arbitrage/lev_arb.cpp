@@ -11,7 +11,11 @@
 #include <Utilities/utils.h>
 
 #include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <iostream>
+#include <limits>
+#include <sstream>
 #include <cassert>
 
 using namespace RCM::StrategyStudio;
@@ -23,19 +27,32 @@ using namespace std;
 LevArbStrategy::LevArbStrategy(StrategyID strategyID, const std::string& strategyName, const std::string& groupName):
     Strategy(strategyID, strategyName, groupName),
     m_spState(),
+    m_basket(),
+    m_positions(),
     m_bars(),
-    m_instrumentX(NULL),
-    m_instrumentY(NULL),
-    m_tradeSize(1),
-    m_nOrdersOutstanding(0),
-    m_DebugOn(false),
-	_lev_ratio(3),
-	lastX(0.0),
-	lastY(0.0),
-	changeX(0.0),
-	changeY(0.0) {
+    m_legIndex(),
+    m_legRatios(),
+    m_journal(),
+    m_latency(),
+    m_warmStart(),
+    m_journalPath(),
+    m_warmStartPath(),
+    m_eventTime(0),
+    m_warmStartDue(std::numeric_limits<int64_t>::max()),
+    m_warmStartSeconds(60),
+    m_anchorSeconds(0),
+    m_anchorExpiry(0),
+    m_hedgeHalflife(0),
+    m_tickMode(false),
+    m_localBars(false),
+    m_specializedKernels(true),
+    m_pipelineOrders(true),
+    m_evaluate(&LegBasket::Evaluate),
+    m_riskGate(),
+    m_config() {
 
     m_spState.marketActive = true;
+    m_riskGate.set_limits(&m_config.get().riskLimits);
 
 }
 
@@ -45,18 +62,95 @@ LevArbStrategy::~LevArbStrategy() {
 
 void LevArbStrategy::OnResetStrategyState() {
     m_spState.marketActive = true;
-    m_bars.clear();
+    m_basket.bar_mask = 0;
+    m_basket.ClearAnchors();
+    m_anchorExpiry = 0;
 }
 
 void LevArbStrategy::DefineStrategyParams() {
+    const LevArbConfig& config = m_config.get();
+
     //CreateStrategyParamArgs arg1("z_score", STRATEGY_PARAM_TYPE_RUNTIME, VALUE_TYPE_DOUBLE, m_zScoreThreshold);
     //params().CreateParam(arg1);
 
-    CreateStrategyParamArgs arg2("trade_size", STRATEGY_PARAM_TYPE_RUNTIME, VALUE_TYPE_INT, m_tradeSize);
+    CreateStrategyParamArgs arg2("trade_size", STRATEGY_PARAM_TYPE_RUNTIME, VALUE_TYPE_INT, config.tradeSize);
     params().CreateParam(arg2);
 
-    CreateStrategyParamArgs arg3("debug", STRATEGY_PARAM_TYPE_RUNTIME, VALUE_TYPE_BOOL, m_DebugOn);
+    CreateStrategyParamArgs arg3("debug", STRATEGY_PARAM_TYPE_RUNTIME, VALUE_TYPE_BOOL, config.debugOn);
     params().CreateParam(arg3);
+
+    // comma separated leverage of each product leg in symbol order, e.g. "3,2,-1,-3"; empty means all 3x
+    CreateStrategyParamArgs arg4("leg_ratios", STRATEGY_PARAM_TYPE_STARTUP, VALUE_TYPE_STRING, "");
+    params().CreateParam(arg4);
+
+    // debug output goes here, written by a background thread; empty, the default, disables it
+    CreateStrategyParamArgs arg5("journal_path", STRATEGY_PARAM_TYPE_STARTUP, VALUE_TYPE_STRING, m_journalPath);
+    params().CreateParam(arg5);
+
+    // a leg trades once its return is more than this multiple of ratio times the underlying's return
+    CreateStrategyParamArgs arg6("band_multiplier", STRATEGY_PARAM_TYPE_RUNTIME, VALUE_TYPE_DOUBLE, config.bandMultiplier);
+    params().CreateParam(arg6);
+
+    // evaluate on every top-of-book change instead of on 10 second bars; excludes local_bars
+    CreateStrategyParamArgs arg7("tick_mode", STRATEGY_PARAM_TYPE_STARTUP, VALUE_TYPE_BOOL, m_tickMode);
+    params().CreateParam(arg7);
+
+    // tick mode: returns are measured from each leg's first mid of the session (0), or from anchors
+    // that roll forward to the latest mids every this many seconds
+    CreateStrategyParamArgs arg8("anchor_seconds", STRATEGY_PARAM_TYPE_STARTUP, VALUE_TYPE_INT, m_anchorSeconds);
+    params().CreateParam(arg8);
+
+    // evaluate bars with a kernel compiled for this leg count and leverage when there is one
+    CreateStrategyParamArgs arg9("specialized_kernels", STRATEGY_PARAM_TYPE_STARTUP, VALUE_TYPE_BOOL, m_specializedKernels);
+    params().CreateParam(arg9);
+
+    // pre-trade risk limits checked in front of every new order; 0 disables a limit
+    CreateStrategyParamArgs arg10("max_order_size", STRATEGY_PARAM_TYPE_RUNTIME, VALUE_TYPE_INT, config.riskLimits.max_order_size);
+    params().CreateParam(arg10);
+
+    CreateStrategyParamArgs arg11("max_instrument_notional", STRATEGY_PARAM_TYPE_RUNTIME, VALUE_TYPE_DOUBLE, config.riskLimits.max_instrument_notional);
+    params().CreateParam(arg11);
+
+    CreateStrategyParamArgs arg12("max_strategy_notional", STRATEGY_PARAM_TYPE_RUNTIME, VALUE_TYPE_DOUBLE, config.riskLimits.max_strategy_notional);
+    params().CreateParam(arg12);
+
+    CreateStrategyParamArgs arg13("max_orders_per_second", STRATEGY_PARAM_TYPE_RUNTIME, VALUE_TYPE_INT, config.riskLimits.max_orders_per_second);
+    params().CreateParam(arg13);
+
+    // most the leverage-weighted notional of all legs may drift from neutral before further orders
+    // that widen it are refused; orders that bring the basket back toward neutral always pass
+    CreateStrategyParamArgs arg14("max_net_exposure", STRATEGY_PARAM_TYPE_RUNTIME, VALUE_TYPE_DOUBLE, config.riskLimits.max_net_exposure);
+    params().CreateParam(arg14);
+
+    // size orders off position plus pending and keep sending while orders work; false waits until
+    // every working order is done before sending more
+    CreateStrategyParamArgs arg15("pipeline_orders", STRATEGY_PARAM_TYPE_STARTUP, VALUE_TYPE_BOOL, m_pipelineOrders);
+    params().CreateParam(arg15);
+
+    // build the 10 second bars in the strategy from trades and quotes instead of subscribing to them; excludes tick_mode
+    CreateStrategyParamArgs arg16("local_bars", STRATEGY_PARAM_TYPE_STARTUP, VALUE_TYPE_BOOL, m_localBars);
+    params().CreateParam(arg16);
+
+    // estimate each product's hedge ratio online, with observations losing half their weight every this
+    // many bars (tick mode: quotes of the product); 0 keeps the nominal leverage from leg_ratios
+    CreateStrategyParamArgs arg17("hedge_halflife", STRATEGY_PARAM_TYPE_STARTUP, VALUE_TYPE_INT, m_hedgeHalflife);
+    params().CreateParam(arg17);
+
+    // snapshot the legs' closes, anchors and hedge fits here every warm_start_seconds of event time,
+    // and start from the last snapshot instead of cold; empty disables warm start
+    CreateStrategyParamArgs arg18("warm_start_path", STRATEGY_PARAM_TYPE_STARTUP, VALUE_TYPE_STRING, m_warmStartPath);
+    params().CreateParam(arg18);
+
+    CreateStrategyParamArgs arg19("warm_start_seconds", STRATEGY_PARAM_TYPE_STARTUP, VALUE_TYPE_INT, m_warmStartSeconds);
+    params().CreateParam(arg19);
+}
+
+void LevArbStrategy::DefineStrategyCommands() {
+    StrategyCommand command1(1, "Dump Latency Histograms");
+    commands().AddCommand(command1);
+
+    StrategyCommand command2(2, "Reset Latency Histograms");
+    commands().AddCommand(command2);
 }
 
 void LevArbStrategy::DefineStrategyGraphs() {
@@ -65,150 +159,445 @@ void LevArbStrategy::DefineStrategyGraphs() {
 }
 
 void LevArbStrategy::RegisterForStrategyEvents(StrategyEventRegister* eventRegister, DateType currDate) {    
-    int count = 0;
+    int numSymbols = std::distance(symbols_begin(), symbols_end());
+    if (numSymbols > LEV_ARB_MAX_LEGS) {
+        throw StrategyStudioException("LevArbStrategy supports at most 8 legs");
+    }
+    if (!m_legRatios.empty() && static_cast<int>(m_legRatios.size()) != numSymbols - 1) {
+        throw StrategyStudioException("leg_ratios needs one ratio per product leg");
+    }
+    if (m_tickMode && m_localBars) {
+        // both would drive the basket, one per quote and one per closed bar
+        throw StrategyStudioException("tick_mode and local_bars cannot both be on");
+    }
 
+    if (!m_journal.is_open() && !m_journalPath.empty()) {
+        m_journal.Open(m_journalPath, "");
+    }
+
+    std::vector<const Instrument*> instruments;
     for (SymbolSetConstIter it = symbols_begin(); it != symbols_end(); ++it) {
-        EventInstrumentPair retVal = eventRegister->RegisterForBars(*it, BAR_TYPE_TIME, 10);    
-        
-        if (count == 0) {
-            m_instrumentX = retVal.second;
-        } else if (count == 1) {
-            m_instrumentY = retVal.second;
+        EventInstrumentPair retVal = (m_tickMode || m_localBars) ? eventRegister->RegisterForMarketData(*it) : eventRegister->RegisterForBars(*it, BAR_TYPE_TIME, LEV_ARB_BAR_SECONDS);
+        if (!retVal.first || retVal.second == NULL) {
+            // legs are positional, so a missing symbol would shift every leg after it
+            throw StrategyStudioException("LevArbStrategy could not register for " + *it);
         }
-    
-        ++count;
+        instruments.push_back(retVal.second);
+    }
+
+    // the underlying (last symbol) becomes leg 0, the products follow in symbol order
+    m_basket.Clear();
+    m_legIndex.Reset(numSymbols);
+    if (numSymbols == 0) {
+        return;
+    }
+    m_legIndex.Insert(instruments.back(), m_basket.AddLeg(instruments.back(), 1));
+    for (int i = 0; i < numSymbols - 1; ++i) {
+        double ratio = m_legRatios.empty() ? LEV_ARB_DEFAULT_LEG_RATIO : m_legRatios[i];
+        m_legIndex.Insert(instruments[i], m_basket.AddLeg(instruments[i], ratio));
+    }
+
+    m_basket.EnableHedgeEstimation(m_hedgeHalflife);
+
+    // the legs and their leverage are fixed from here on, so the bar kernel can be chosen once
+    m_evaluate = SelectEvaluator(m_basket, m_specializedKernels);
+
+    // every leg trades at market on a day order, so only price and size are left for the send path;
+    // the ledger starts from whatever the portfolio already holds and is kept from fills after that
+    m_positions.Reset(m_basket.num_legs);
+    for (int leg = 0; leg < m_basket.num_legs; ++leg) {
+        m_legOrders[leg].Build(*m_basket.instrument[leg], ORDER_TYPE_MARKET);
+        m_positions.set_position(leg, portfolio().position(m_basket.instrument[leg]));
+    }
+
+    // with local bars the 10 second bars are built here from the legs' trades instead of by the server
+    m_bars.ClearIntervals();
+    m_bars.AddInterval(LEV_ARB_BAR_SECONDS * 1000000LL);
+    m_bars.Reset(m_basket.num_legs);
+
+    // net exposure weighs each leg by its leverage, so a hedged basket nets to zero
+    m_riskGate.Reset(m_basket.num_legs);
+    for (int leg = 0; leg < m_basket.num_legs; ++leg) {
+        m_riskGate.set_weight(leg, m_basket.ratio[leg]);
+    }
+
+    m_warmStart.Close();
+    m_warmStartDue = std::numeric_limits<int64_t>::max();
+    if (!m_warmStartPath.empty()) {
+        RestoreWarmStart();
+        m_warmStart.Open(m_warmStartPath, GetType(), (LEV_ARB_MAX_LEGS + 1) * (sizeof(WarmStartEntry) + sizeof(LegWarmState) + 16));
+        m_warmStartDue = 0;
     }
 }
 
-void LevArbStrategy::OnTrade(const TradeDataEventMsg& msg) {
+void LevArbStrategy::SaveWarmStart(int64_t now) {
+    if (!m_warmStart.Begin(now)) {
+        return;
+    }
+    m_warmStart.BeginEntry("");
+    m_warmStart.Put(static_cast<int32_t>(m_basket.primed));
+    m_warmStart.Put(m_basket.hedge_forgetting);
+    for (int leg = 0; leg < m_basket.num_legs; ++leg) {
+        m_warmStart.BeginEntry(m_basket.instrument[leg]->symbol());
+        m_warmStart.Put(m_basket.SaveLeg(leg));
+    }
+    m_warmStart.Commit();
+}
 
+void LevArbStrategy::RestoreWarmStart() {
+    WarmStartReader reader;
+    if (!reader.Open(m_warmStartPath, GetType())) {
+        return;
+    }
+    WarmStartCursor cursor;
+    int32_t primed = 0;
+    double forgetting = 0;
+    if (!reader.Find("", &cursor) || !cursor.Get(&primed) || !cursor.Get(&forgetting)) {
+        return;
+    }
+
+    // a leg is restored only if its leverage is unchanged, and the bar returns pick up only if every leg was
+    bool hedge = m_basket.estimates_hedge() && forgetting == m_basket.hedge_forgetting;
+    int restored = 0;
+    for (int leg = 0; leg < m_basket.num_legs; ++leg) {
+        LegWarmState warm;
+        if (reader.Find(m_basket.instrument[leg]->symbol(), &cursor) && cursor.Get(&warm) && m_basket.RestoreLeg(leg, warm, hedge)) {
+            ++restored;
+        }
+    }
+    m_basket.primed = (primed != 0 && restored == m_basket.num_legs);
+    if (hedge) {
+        UpdateRiskWeights();
+    }
+
+    std::ostringstream ss;
+    ss << "LevArbStrategy warm start restored " << restored << " of " << m_basket.num_legs << " legs from " << m_warmStartPath;
+    logger().LogToClient(LOGLEVEL_INFO, ss.str());
+}
+
+void LevArbStrategy::OnTrade(const TradeDataEventMsg& msg) {
+    if (!m_localBars) {
+        return;
+    }
+    m_latency.Begin();
+    int leg = m_legIndex.Find(&msg.instrument());
+    if (leg < 0) {
+        return;
+    }
+    const LevArbConfig& config = m_config.get();
+    m_bars.OnTrade(leg, JournalTime(msg.event_time()), msg.trade().price(), msg.trade().size(),
+        [this, &config](int closedLeg, int, const LocalBar& bar) { OnLegBar(closedLeg, bar, config); });
 }
 
 void LevArbStrategy::OnTopQuote(const QuoteEventMsg& msg) {
+    if (!m_tickMode && !m_localBars) {
+        return;
+    }
+    m_latency.Begin();
+    int leg = m_legIndex.Find(&msg.instrument());
+    if (leg < 0 || m_basket.num_legs < 2) {
+        return;
+    }
+    const Quote& quote = msg.quote();
+    const LevArbConfig& config = m_config.get();
+    if (m_localBars) {
+        // quotes move the bar clock, so a quiet leg's bar still closes on time
+        m_bars.OnQuote(leg, JournalTime(msg.event_time()), quote.mid_price(),
+            [this, &config](int closedLeg, int, const LocalBar& bar) { OnLegBar(closedLeg, bar, config); });
+        return;
+    }
+    if (quote.bid() <= 0 || quote.ask() <= 0) {
+        return;
+    }
+
+    if (m_anchorSeconds > 0 || config.debugOn || config.riskLimits.max_orders_per_second > 0) {
+        m_eventTime = JournalTime(msg.event_time());
+        m_riskGate.set_time(m_eventTime);
+        if (m_anchorSeconds > 0 && m_eventTime >= m_anchorExpiry) {
+            if (m_anchorExpiry != 0) {
+                m_basket.Reanchor();
+            }
+            m_anchorExpiry = m_eventTime + m_anchorSeconds * 1000000LL;
+        }
+    }
+
+    if (m_warmStart.is_open()) {
+        MaybeSaveWarmStart(JournalTime(msg.event_time()));
+    }
+
+    // a multiply and two compares per quote; orders go out only when a leg's side actually flips
+    bool changed = m_basket.OnQuote(leg, quote.mid_price(), config.tradeSize, config.bandMultiplier);
+    if (m_basket.estimates_hedge()) {
+        UpdateRiskWeights();
+    }
+    if (!changed) {
+        return;
+    }
+    m_latency.Signal();
 
+    if (m_spState.marketActive) {
+        AdjustPortfolio(config);
+    }
 }
 
 void LevArbStrategy::OnBar(const BarEventMsg& msg) {
-     if (m_DebugOn) {
-        ostringstream str;
-        str << msg.instrument().symbol() << ": "<< msg.bar();
-        logger().LogToClient(LOGLEVEL_DEBUG, str.str().c_str());
-     }
+    m_latency.Begin();
+    int leg = m_legIndex.Find(&msg.instrument());
+    if (leg < 0) {
+        return;
+    }
+
+    const Bar& serverBar = msg.bar();
+    LocalBar bar;
+    bar.close_time = JournalTime(msg.bar_time());
+    bar.open = serverBar.open();
+    bar.high = serverBar.high();
+    bar.low = serverBar.low();
+    bar.close = serverBar.close();
+    bar.volume = serverBar.volume();
+    OnLegBar(leg, bar, m_config.get());
+}
 
-    // update our bars collection
-    m_bars[&msg.instrument()] = msg.bar();
+void LevArbStrategy::OnLegBar(int leg, const LocalBar& bar, const LevArbConfig& config) {
+    m_eventTime = bar.close_time;
+    m_riskGate.set_time(m_eventTime);
+    MaybeSaveWarmStart(m_eventTime);
+    if (config.debugOn) {
+        m_journal.LogBar(m_eventTime, m_basket.instrument[leg]->symbol(), bar.open, bar.high, bar.low, bar.close, bar.volume);
+    }
 
-    if (m_bars.size() < 2) {
-	    //wait until we have bars for both pairs
+    if (m_basket.num_legs < 2) {
         return;
     }
 
-    assert(m_bars.size() == 2);
+    if (!m_basket.OnBarClose(leg, bar.close)) {
+	    //wait until we have bars for every leg
+        return;
+    }
 
-    if (lastX != 0 && lastY != 0) {
-    	changeX = m_bars[m_instrumentX].close() / lastX - 1;
-    	changeY = m_bars[m_instrumentY].close() / lastY - 1;
-    } 
-    lastX = m_bars[m_instrumentX].close();
-    lastY = m_bars[m_instrumentY].close();
-    
-    // sell X and buy Y when changeX and changeY widens 
-    if (changeX > 1.001 * _lev_ratio * changeY) {
-        m_spState.unitsDesired = -m_tradeSize;
-    } else if (changeX < -1.001 * _lev_ratio * changeY) {
-        m_spState.unitsDesired = m_tradeSize;
-    } else {
-        m_spState.unitsDesired = 0;
+    // one pass over all legs: sell a product that ran ahead of its ratio, buy one that lagged
+    (m_basket.*m_evaluate)(config.tradeSize, config.bandMultiplier);
+    m_latency.Signal();
+    if (m_basket.estimates_hedge()) {
+        UpdateRiskWeights();
     }
 
     if (m_spState.marketActive) {
-        AdjustPortfolio();
+        AdjustPortfolio(config);
     }
-    
-    m_bars.clear();
 }
 
-void LevArbStrategy::AdjustPortfolio() {
-    // wait until orders are filled before we send out more orders
-    if (orders().num_working_orders() > 0) { //|| abs(_lev_ratio * portfolio().position(m_instrumentX) * m_bars[m_instrumentX].close() + 
+void LevArbStrategy::AdjustPortfolio(const LevArbConfig& config) {
+    // sizing is off position plus what is still in flight, so new orders can go out while earlier
+    // ones work; the legacy mode still waits until every order is filled
+    if (!m_pipelineOrders && orders().num_working_orders() > 0) { //|| abs(_lev_ratio * portfolio().position(m_instrumentX) * m_bars[m_instrumentX].close() + 
     		//portfolio().position(m_instrumentY) * m_bars[m_instrumentY].close() ) > 2) {
         return;
     }
 
-    int sharesX = m_spState.unitsDesired * m_bars[m_instrumentY].close() - portfolio().position(m_instrumentX);
-    int sharesY = m_spState.unitsDesired * _lev_ratio * m_bars[m_instrumentX].close() - portfolio().position(m_instrumentY);
+    const LegBasket& b = m_basket;
+    double underlyingUnits = 0;
+
+    for (int leg = 1; leg < b.num_legs; ++leg) {
+        int shares = b.desired[leg] * b.close[0] - m_positions.expected_position(leg);
+        underlyingUnits += b.desired[leg] * b.ratio[leg] * b.close[leg];
 
-    if (sharesX > 0) {
-        SendBuyOrder(m_instrumentX, sharesX);
-    } else if (sharesX < 0) {
-        SendSellOrder(m_instrumentX, -sharesX);
+        if (shares > 0) {
+            SendBuyOrder(leg, shares, config);
+        } else if (shares < 0) {
+            SendSellOrder(leg, -shares, config);
+        }
     }
-    if (sharesY > 0) {
-        SendBuyOrder(m_instrumentY, sharesY);
-    } else if (sharesY < 0) {
-        SendSellOrder(m_instrumentY, -sharesY);
+
+    int sharesUnderlying = underlyingUnits - m_positions.expected_position(0);
+    if (sharesUnderlying > 0) {
+        SendBuyOrder(0, sharesUnderlying, config);
+    } else if (sharesUnderlying < 0) {
+        SendSellOrder(0, -sharesUnderlying, config);
     }
 }
 
-void LevArbStrategy::SendBuyOrder(const Instrument* instrument, int unitsNeeded) {
-    if (m_DebugOn) {
-        std::stringstream ss;
-        ss << "Sending buy order for " << instrument->symbol() << " at price " << instrument->top_quote().ask() << " and quantity " << unitsNeeded;   
-        logger().LogToClient(LOGLEVEL_DEBUG, ss.str());
+void LevArbStrategy::SendBuyOrder(int leg, int unitsNeeded, const LevArbConfig& config) {
+    const Instrument* instrument = m_basket.instrument[leg];
+    double ask = instrument->top_quote().ask();
+    if (config.debugOn) {
+        m_journal.LogOrder(m_eventTime, instrument->symbol(), unitsNeeded, ask);
     }
 
-    OrderParams params(*instrument, 
-        unitsNeeded,
-        (instrument->top_quote().ask() != 0) ? instrument->top_quote().ask() : instrument->last_trade().price(), 
-        (instrument->type() == INSTRUMENT_TYPE_EQUITY) ? MARKET_CENTER_ID_NASDAQ : ((instrument->type() == INSTRUMENT_TYPE_OPTION) ? MARKET_CENTER_ID_CBOE_OPTIONS : MARKET_CENTER_ID_CME_GLOBEX),
-        ORDER_SIDE_BUY,
-        ORDER_TIF_DAY,
-        ORDER_TYPE_MARKET);
-
-    trade_actions()->SendNewOrder(params);
+    double price = (ask != 0) ? ask : instrument->last_trade().price();
+    if (!PassesRiskChecks(leg, unitsNeeded, price, config)) {
+        return;
+    }
+    if (trade_actions()->SendNewOrder(m_legOrders[leg].Patch(true, unitsNeeded, price)) == TRADE_ACTION_RESULT_SUCCESSFUL) {
+        m_positions.OnOrderSent(leg, unitsNeeded);
+        m_riskGate.OnOrderSent();
+        m_latency.OrderSent();
+    }
 }
     
-void LevArbStrategy::SendSellOrder(const Instrument* instrument, int unitsNeeded) {
-    if (m_DebugOn) {
-        std::stringstream ss;
-        ss << "Sending sell order for " << instrument->symbol() << " at price " << instrument->top_quote().bid() << " and quantity " << unitsNeeded;   
-        logger().LogToClient(LOGLEVEL_DEBUG, ss.str());
+void LevArbStrategy::SendSellOrder(int leg, int unitsNeeded, const LevArbConfig& config) {
+    const Instrument* instrument = m_basket.instrument[leg];
+    double bid = instrument->top_quote().bid();
+    if (config.debugOn) {
+        m_journal.LogOrder(m_eventTime, instrument->symbol(), -unitsNeeded, bid);
+    }
+
+    double price = (bid != 0) ? bid : instrument->last_trade().price();
+    if (!PassesRiskChecks(leg, -unitsNeeded, price, config)) {
+        return;
     }
+    if (trade_actions()->SendNewOrder(m_legOrders[leg].Patch(false, unitsNeeded, price)) == TRADE_ACTION_RESULT_SUCCESSFUL) {
+        m_positions.OnOrderSent(leg, -unitsNeeded);
+        m_riskGate.OnOrderSent();
+        m_latency.OrderSent();
+    }
+}
 
-    OrderParams params(*instrument, 
-        unitsNeeded,
-        (instrument->top_quote().bid() != 0) ? instrument->top_quote().bid() : instrument->last_trade().price(), 
-        (instrument->type() == INSTRUMENT_TYPE_EQUITY) ? MARKET_CENTER_ID_NASDAQ : ((instrument->type() == INSTRUMENT_TYPE_OPTION) ? MARKET_CENTER_ID_CBOE_OPTIONS : MARKET_CENTER_ID_CME_GLOBEX),
-        ORDER_SIDE_SELL,
-        ORDER_TIF_DAY,
-        ORDER_TYPE_MARKET);
+void LevArbStrategy::UpdateRiskWeights() {
+    // net exposure follows the live hedge ratios, the same ones AdjustPortfolio sizes the underlying by
+    for (int leg = 1; leg < m_basket.num_legs; ++leg) {
+        m_riskGate.set_weight(leg, m_basket.ratio[leg]);
+    }
+}
 
-    trade_actions()->SendNewOrder(params);
+bool LevArbStrategy::PassesRiskChecks(int leg, int signedUnits, double price, const LevArbConfig& config) {
+    RiskCheckResult result = m_riskGate.Check(leg, signedUnits, price);
+    if (result != RISK_CHECK_OK && config.debugOn) {
+        // formatted on the stack: refusals come in bursts, and the hot path does not allocate
+        char message[128];
+        snprintf(message, sizeof(message), "Order for %s refused: %s", m_basket.instrument[leg]->symbol().c_str(), RiskCheckName(result));
+        logger().LogToClient(LOGLEVEL_DEBUG, message);
+    }
+    return result == RISK_CHECK_OK;
 }
 
 void LevArbStrategy::OnMarketState(const MarketStateEventMsg& msg) {
-
+    if (m_localBars) {
+        const LevArbConfig& config = m_config.get();
+        m_bars.Flush([this, &config](int leg, int, const LocalBar& bar) { OnLegBar(leg, bar, config); });
+    }
+    if (m_warmStart.is_open()) {
+        SaveWarmStart(JournalTime(msg.event_time()));
+    }
 }
 
 void LevArbStrategy::OnOrderUpdate(const OrderUpdateEventMsg& msg) {
-
+    int leg = m_legIndex.Find(msg.order().instrument());
+    if (leg < 0) {
+        return;
+    }
+    m_positions.OnOrderUpdate(leg, msg);
+    if (msg.fill_occurred()) {
+        m_riskGate.OnFill(leg, msg.fill()->fill_size(), msg.fill()->fill_price());
+    }
 }
 
 void LevArbStrategy::OnAppStateChange(const AppStateEventMsg& msg) {
 
 }
 
+void LevArbStrategy::OnStrategyCommand(const StrategyCommandEventMsg& msg) {
+    switch (msg.command_id()) {
+        case 1: {
+            std::ostringstream ss;
+            m_latency.Dump(ss);
+            logger().LogToClient(LOGLEVEL_INFO, ss.str());
+            break;
+        }
+        case 2:
+            m_latency.Reset();
+            break;
+        default:
+            logger().LogToClient(LOGLEVEL_DEBUG, "Unknown strategy command received");
+            break;
+    }
+}
+
 void LevArbStrategy::OnParamChanged(StrategyParam& param) {    
     //if (param.param_name() == "z_score") {
     //    if (!param.Get(&m_zScoreThreshold))
     //       throw StrategyStudioException("Could not get zscore threshold");
     //} else 
+    if (param.param_name() == "specialized_kernels") {
+        if (!param.Get(&m_specializedKernels))
+            throw StrategyStudioException("Could not get specialized kernels");
+    } else if (param.param_name() == "pipeline_orders") {
+        if (!param.Get(&m_pipelineOrders))
+            throw StrategyStudioException("Could not get pipeline orders");
+    } else if (param.param_name() == "local_bars") {
+        if (!param.Get(&m_localBars))
+            throw StrategyStudioException("Could not get local bars");
+    } else if (param.param_name() == "hedge_halflife") {
+        if (!param.Get(&m_hedgeHalflife))
+            throw StrategyStudioException("Could not get hedge halflife");
+    } else if (param.param_name() == "tick_mode") {
+        if (!param.Get(&m_tickMode))
+            throw StrategyStudioException("Could not get tick mode");
+    } else if (param.param_name() == "anchor_seconds") {
+        if (!param.Get(&m_anchorSeconds))
+            throw StrategyStudioException("Could not get anchor seconds");
+    } else if (param.param_name() == "journal_path") {
+        if (!param.Get(&m_journalPath))
+            throw StrategyStudioException("Could not get journal path");
+    } else if (param.param_name() == "warm_start_path") {
+        if (!param.Get(&m_warmStartPath))
+            throw StrategyStudioException("Could not get warm start path");
+    } else if (param.param_name() == "warm_start_seconds") {
+        if (!param.Get(&m_warmStartSeconds))
+            throw StrategyStudioException("Could not get warm start seconds");
+        m_warmStartSeconds = max(1, m_warmStartSeconds);
+    } else if (param.param_name() == "leg_ratios") {
+        std::string ratios;
+        if (!param.Get(&ratios))
+            throw StrategyStudioException("Could not get leg ratios");
+
+        m_legRatios.clear();
+        std::stringstream ss(ratios);
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            char* end = NULL;
+            double ratio = strtod(item.c_str(), &end);
+            if (end == item.c_str() || ratio == 0)
+                throw StrategyStudioException("Could not parse leg ratios");
+            m_legRatios.push_back(ratio);
+        }
+    } else {
+        SetRuntimeParam(param);
+    }
+}
+
+void LevArbStrategy::SetRuntimeParam(StrategyParam& param) {
+    // edit a copy of the current config and publish it whole; callbacks never see a partial change
+    LevArbConfig config = m_config.get();
     if (param.param_name() == "trade_size") {
-        if (!param.Get(&m_tradeSize))
+        if (!param.Get(&config.tradeSize))
             throw StrategyStudioException("Could not get trade size");
     } else if (param.param_name() == "debug") {
-        if (!param.Get(&m_DebugOn))
-            throw StrategyStudioException("Could not get trade size");
-    }        
+        if (!param.Get(&config.debugOn))
+            throw StrategyStudioException("Could not get debug");
+    } else if (param.param_name() == "band_multiplier") {
+        if (!param.Get(&config.bandMultiplier))
+            throw StrategyStudioException("Could not get band multiplier");
+    } else if (param.param_name() == "max_order_size") {
+        if (!param.Get(&config.riskLimits.max_order_size))
+            throw StrategyStudioException("Could not get max order size");
+    } else if (param.param_name() == "max_instrument_notional") {
+        if (!param.Get(&config.riskLimits.max_instrument_notional))
+            throw StrategyStudioException("Could not get max instrument notional");
+    } else if (param.param_name() == "max_strategy_notional") {
+        if (!param.Get(&config.riskLimits.max_strategy_notional))
+            throw StrategyStudioException("Could not get max strategy notional");
+    } else if (param.param_name() == "max_orders_per_second") {
+        if (!param.Get(&config.riskLimits.max_orders_per_second))
+            throw StrategyStudioException("Could not get max orders per second");
+    } else if (param.param_name() == "max_net_exposure") {
+        if (!param.Get(&config.riskLimits.max_net_exposure))
+            throw StrategyStudioException("Could not get max net exposure");
+    } else {
+        return;
+    }
+    if (!m_config.Publish(config))
+        throw StrategyStudioException("Could not publish params from outside the strategy thread");
+    m_riskGate.set_limits(&m_config.get().riskLimits);
 }
 
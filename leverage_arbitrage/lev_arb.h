@@ -17,6 +17,17 @@
 #include <MarketModels/Instrument.h>
 #include <Utilities/ParseConfig.h>
 
+#include "LegBasket.h"
+#include "../common/AsyncJournal.h"
+#include "../common/BarBuilder.h"
+#include "../common/ConfigSnapshot.h"
+#include "../common/InstrumentIndex.h"
+#include "../common/LatencyHistogram.h"
+#include "../common/OrderTemplate.h"
+#include "../common/PositionLedger.h"
+#include "../common/RiskGate.h"
+#include "../common/WarmStart.h"
+
 #include <vector>
 #include <map>
 #include <iostream>
@@ -36,12 +47,41 @@ struct StrategyLogicState {
     int unitsDesired;    
 };
 
-class LevArbStrategy : public Strategy {
-public:
-    typedef std::map<const Instrument*, Bar> Bars; 
-    typedef Bars::iterator BarsIter;
-    typedef Bars::const_iterator BarsConstIter;
+/**
+ * Length of the bars legs are compared on outside tick mode
+ */
+const int LEV_ARB_BAR_SECONDS = 10;
+
+/**
+ * Leverage of every product leg when the leg_ratios param is left empty
+ */
+const double LEV_ARB_DEFAULT_LEG_RATIO = 3;
+
+/**
+ * LevArbStrategy's runtime params, published as one snapshot by OnParamChanged. Each callback
+ * reads a single snapshot and hands it down, so every leg it sizes sees the same values.
+ */
+struct LevArbConfig {
+    LevArbConfig(): riskLimits(), tradeSize(1), bandMultiplier(1.001), debugOn(false) {}
+
+    RiskLimits riskLimits;
+    int tradeSize;
+    double bandMultiplier;
+    bool debugOn;
+};
 
+/**
+ * Trades a family of leveraged products against their underlying. The last symbol in the symbol
+ * set is the underlying; the others are the products, with leverage given in order by the
+ * leg_ratios param (every product defaults to 3x). With hedge_halflife set, that leverage is only
+ * the starting point: each product's ratio to the underlying is re-estimated as the bars or quotes
+ * arrive, and both the trade trigger and the underlying hedge size use the estimate.
+ *
+ * By default legs are compared on synchronized 10 second bars, subscribed from the server or, with
+ * local_bars set, built in the strategy from the legs' trades. With tick_mode set they are compared
+ * on every top quote, each leg's mid measured against a session or rolling anchor.
+ */
+class LevArbStrategy : public Strategy {
 public:
     LevArbStrategy(StrategyID strategyID, const std::string& strategyName, const std::string& groupName);
     ~LevArbStrategy();
@@ -107,6 +147,11 @@ public: /* from IEventCallback */
      */ 
     virtual void OnAppStateChange(const AppStateEventMsg& msg);
 
+    /**
+     * This event triggers whenever a custom strategy command is sent from the client
+     */ 
+    void OnStrategyCommand(const StrategyCommandEventMsg& msg);
+
     /**
     *  Perform additional reset for strategy state 
     */
@@ -122,9 +167,22 @@ public: /* from IEventCallback */
     void OnParamChanged(StrategyParam& param);
 
 private: // Helper functions specific to this strategy
-    void AdjustPortfolio();
-    void SendBuyOrder(const Instrument* instrument, int unitsNeeded);
-    void SendSellOrder(const Instrument* instrument, int unitsNeeded);
+    void OnLegBar(int leg, const LocalBar& bar, const LevArbConfig& config);
+    void AdjustPortfolio(const LevArbConfig& config);
+    void SendBuyOrder(int leg, int unitsNeeded, const LevArbConfig& config);
+    void SendSellOrder(int leg, int unitsNeeded, const LevArbConfig& config);
+    bool PassesRiskChecks(int leg, int signedUnits, double price, const LevArbConfig& config);
+    void SetRuntimeParam(StrategyParam& param);
+    void UpdateRiskWeights();
+    void SaveWarmStart(int64_t now);
+    void RestoreWarmStart();
+
+    void MaybeSaveWarmStart(int64_t now) {
+        if (now >= m_warmStartDue) {
+            m_warmStartDue = now + m_warmStartSeconds * 1000000LL;
+            SaveWarmStart(now);
+        }
+    }
 
 private: /* from Strategy */
     
@@ -135,6 +193,11 @@ private: /* from Strategy */
      */     
     virtual void DefineStrategyParams();
 
+    /**
+     * Define any strategy commands for use by the strategy
+     */ 
+    virtual void DefineStrategyCommands();
+
     /**
      * Provides an ideal place during strategy initialization to define custom strategy graphs using graphs().series().add(...) 
      */ 
@@ -142,17 +205,33 @@ private: /* from Strategy */
 
 private:
     StrategyLogicState m_spState;
-    Bars m_bars;
-    const MarketModels::Instrument* m_instrumentX;    
-    const MarketModels::Instrument* m_instrumentY;
+    LegBasket m_basket;
+    OrderTemplate m_legOrders[LEV_ARB_MAX_LEGS];
+    PositionLedger m_positions;
+    BarBuilder m_bars;
+    InstrumentIndex m_legIndex;
+    std::vector<double> m_legRatios;
+    AsyncJournal m_journal;
+    LatencyTracker m_latency;
+    WarmStartWriter m_warmStart;
+    std::string m_journalPath;
+    std::string m_warmStartPath;
+    int64_t m_eventTime;
+    int64_t m_warmStartDue;
+    int m_warmStartSeconds;
     //Analytics::ScalarRollingWindow<double> m_rollingWindow;
     //double m_zScore;
     //double m_zScoreThreshold;
-    int m_tradeSize;
-    int m_nOrdersOutstanding;
-    bool m_DebugOn;
-    double lastX, lastY, changeX, changeY;
-    double _lev_ratio;
+    int m_anchorSeconds;
+    int64_t m_anchorExpiry;
+    int m_hedgeHalflife;
+    bool m_tickMode;
+    bool m_localBars;
+    bool m_specializedKernels;
+    bool m_pipelineOrders;
+    LegBasketEvaluator m_evaluate;
+    RiskGate m_riskGate;
+    ConfigSnapshot<LevArbConfig> m_config;
 };
 
 extern "C" {
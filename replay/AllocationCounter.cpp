@@ -0,0 +1,100 @@
+#include "AllocationCounter.h"
+
+#include <stdlib.h>
+
+#include <new>
+
+namespace Replay {
+
+namespace {
+
+thread_local unsigned long long t_allocations = 0;
+thread_local int t_paused = 0;
+
+inline void* Allocate(size_t size)
+{
+    if (t_paused == 0)
+        ++t_allocations;
+    void* p = malloc(size ? size : 1);
+    if (p == NULL)
+        throw std::bad_alloc();
+    return p;
+}
+
+inline void* AllocateAligned(size_t size, size_t alignment)
+{
+    if (t_paused == 0)
+        ++t_allocations;
+    void* p = NULL;
+    if (posix_memalign(&p, alignment < sizeof(void*) ? sizeof(void*) : alignment, size ? size : 1) != 0)
+        throw std::bad_alloc();
+    return p;
+}
+
+} // namespace
+
+unsigned long long ThreadAllocations()
+{
+    return t_allocations;
+}
+
+AllocationPause::AllocationPause()
+{
+    ++t_paused;
+}
+
+AllocationPause::~AllocationPause()
+{
+    --t_paused;
+}
+
+} // namespace Replay
+
+void* operator new(size_t size)
+{
+    return Replay::Allocate(size);
+}
+
+void* operator new[](size_t size)
+{
+    return Replay::Allocate(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    try {
+        return Replay::Allocate(size);
+    } catch (const std::bad_alloc&) {
+        return NULL;
+    }
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    try {
+        return Replay::Allocate(size);
+    } catch (const std::bad_alloc&) {
+        return NULL;
+    }
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    return Replay::AllocateAligned(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+    return Replay::AllocateAligned(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { free(p); }
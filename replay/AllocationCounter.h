@@ -0,0 +1,34 @@
+#pragma once
+
+#ifndef _STRATEGY_STUDIO_REPLAY_ALLOCATION_COUNTER_H_
+#define _STRATEGY_STUDIO_REPLAY_ALLOCATION_COUNTER_H_
+
+namespace Replay {
+
+/**
+ * Heap allocations made so far on the calling thread through operator new, not counting those made under an
+ * AllocationPause.
+ *
+ * AllocationCounter.cpp replaces the global operator new and delete of the binary it is linked into; a strategy
+ * library loaded with dlopen binds to the same operators, so its allocations are counted too. Only the calling
+ * thread's count is kept, which leaves journal writer and worker threads out of a callback's count.
+ */
+unsigned long long ThreadAllocations();
+
+/**
+ * Stops counting the calling thread's allocations while in scope, for work done on the strategy's behalf by the
+ * stand-in server, such as the simulated exchange booking an order. Nests.
+ */
+class AllocationPause {
+public:
+    AllocationPause();
+    ~AllocationPause();
+
+private:
+    AllocationPause(const AllocationPause&);
+    AllocationPause& operator=(const AllocationPause&);
+};
+
+} // namespace Replay
+
+#endif
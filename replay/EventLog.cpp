@@ -0,0 +1,278 @@
+#include "EventLog.h"
+
+#include "AllocationCounter.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <stdexcept>
+
+namespace Replay {
+
+namespace {
+
+uint64_t AlignUp(uint64_t offset)
+{
+    return (offset + 63) & ~static_cast<uint64_t>(63);
+}
+
+void WritePadding(std::ofstream& out, uint64_t offset)
+{
+    static const char zeros[64] = {0};
+    uint64_t pos = static_cast<uint64_t>(out.tellp());
+    out.write(zeros, offset - pos);
+}
+
+void ThrowLogError(const std::string& path, const std::string& what)
+{
+    throw std::runtime_error(path + ": " + what);
+}
+
+bool SameAction(const EventLogRecord& a, const EventLogRecord& b)
+{
+    // prices are compared exactly: the same build on the same ticks computes the same doubles
+    return a.kind == b.kind && a.sequence == b.sequence && a.instrument == b.instrument && a.detail == b.detail
+        && a.quantity == b.quantity && a.price == b.price && a.order_id == b.order_id && a.result == b.result
+        && a.attributes == b.attributes;
+}
+
+void PrintAction(std::ostream& os, const EventLog& log, const EventLogRecord& record)
+{
+    os << "event " << record.sequence << " " << EventLogKindName(record.kind);
+    if (record.instrument < log.symbols.size())
+        os << " " << log.symbols[record.instrument];
+    if (record.kind == EVENT_LOG_NEW_ORDER || record.kind == EVENT_LOG_REPLACE) {
+        os << " " << (IsBuySide(static_cast<OrderSide>(record.detail)) ? "buy" : "sell") << " " << record.quantity
+           << " @ " << std::setprecision(4) << record.price << " type " << (record.attributes & 0xFF)
+           << " tif " << ((record.attributes >> 8) & 0xFF) << " venue " << (record.attributes >> 16);
+    }
+    if (record.order_id != 0)
+        os << " id " << record.order_id;
+    if (record.result != TRADE_ACTION_RESULT_SUCCESSFUL)
+        os << " result " << record.result;
+}
+
+} // namespace
+
+const char* EventLogKindName(uint8_t kind)
+{
+    switch (kind) {
+        case EVENT_LOG_TRADE: return "trade";
+        case EVENT_LOG_QUOTE: return "quote";
+        case EVENT_LOG_DEPTH: return "depth";
+        case EVENT_LOG_BAR: return "bar";
+        case EVENT_LOG_ORDER_UPDATE: return "order update";
+        case EVENT_LOG_COMMAND: return "command";
+        case EVENT_LOG_MARKET_STATE: return "market state";
+        case EVENT_LOG_NEW_ORDER: return "new";
+        case EVENT_LOG_CANCEL: return "cancel";
+        case EVENT_LOG_REPLACE: return "replace";
+        case EVENT_LOG_CANCEL_ALL: return "cancel all";
+    }
+    return "unknown";
+}
+
+EventRecorder::EventRecorder():
+    m_now(0),
+    m_inbound(0)
+{
+}
+
+void EventRecorder::AddInstrument(const Instrument* instrument)
+{
+    m_instruments[instrument] = static_cast<uint16_t>(m_log.symbols.size());
+    m_log.symbols.push_back(instrument->symbol());
+}
+
+uint16_t EventRecorder::InstrumentIndex(const Instrument* instrument) const
+{
+    boost::unordered_map<const Instrument*, uint16_t>::const_iterator it = m_instruments.find(instrument);
+    return (it != m_instruments.end()) ? it->second : EVENT_LOG_NO_INSTRUMENT;
+}
+
+void EventRecorder::Inbound(EventLogKind kind, int64_t timestamp, const Instrument* instrument, double price, uint32_t quantity,
+                            uint8_t detail, OrderID orderID)
+{
+    m_now = timestamp;
+    EventLogRecord record = EventLogRecord();
+    record.timestamp = timestamp;
+    record.sequence = ++m_inbound;
+    record.order_id = orderID;
+    record.price = price;
+    record.quantity = quantity;
+    record.instrument = InstrumentIndex(instrument);
+    record.kind = static_cast<uint8_t>(kind);
+    record.detail = detail;
+    m_log.records.push_back(record);
+}
+
+void EventRecorder::Action(EventLogKind kind, const OrderParams* params, OrderID orderID, TradeActionResult result)
+{
+    EventLogRecord record = EventLogRecord();
+    record.timestamp = m_now;
+    record.sequence = m_inbound;
+    record.order_id = orderID;
+    record.instrument = EVENT_LOG_NO_INSTRUMENT;
+    record.kind = static_cast<uint8_t>(kind);
+    record.result = static_cast<uint32_t>(result);
+    if (params != NULL) {
+        record.price = params->price;
+        record.quantity = params->quantity;
+        record.instrument = InstrumentIndex(params->instrument);
+        record.detail = static_cast<uint8_t>(params->order_side);
+        record.attributes = static_cast<uint32_t>(params->order_type) | (static_cast<uint32_t>(params->tif) << 8)
+            | (static_cast<uint32_t>(params->market_center) << 16);
+    }
+    m_log.records.push_back(record);
+}
+
+void EventRecorder::Save(const std::string& path) const
+{
+    EventLogHeader header = EventLogHeader();
+    memcpy(header.magic, EVENT_LOG_MAGIC, sizeof(header.magic));
+    header.version = EVENT_LOG_VERSION;
+    header.record_size = sizeof(EventLogRecord);
+    header.num_symbols = static_cast<uint32_t>(m_log.symbols.size());
+    header.num_records = m_log.records.size();
+    header.symbols_offset = AlignUp(sizeof(header));
+    header.records_offset = AlignUp(header.symbols_offset + header.num_symbols * EVENT_LOG_SYMBOL_LEN);
+
+    std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+    if (!out)
+        ThrowLogError(path, "cannot create event log");
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    WritePadding(out, header.symbols_offset);
+    for (size_t i = 0; i < m_log.symbols.size(); ++i) {
+        char entry[EVENT_LOG_SYMBOL_LEN] = {0};
+        if (m_log.symbols[i].size() >= EVENT_LOG_SYMBOL_LEN)
+            ThrowLogError(path, "symbol too long for the dictionary: " + m_log.symbols[i]);
+        memcpy(entry, m_log.symbols[i].data(), m_log.symbols[i].size());
+        out.write(entry, sizeof(entry));
+    }
+    WritePadding(out, header.records_offset);
+    if (!m_log.records.empty())
+        out.write(reinterpret_cast<const char*>(m_log.records.data()), m_log.records.size() * sizeof(EventLogRecord));
+
+    out.close();
+    if (!out)
+        ThrowLogError(path, "write failed");
+}
+
+void ReadEventLog(const std::string& path, EventLog* log)
+{
+    std::ifstream in(path.c_str(), std::ios::binary);
+    if (!in)
+        ThrowLogError(path, "cannot open event log");
+
+    EventLogHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) || memcmp(header.magic, EVENT_LOG_MAGIC, sizeof(header.magic)) != 0)
+        ThrowLogError(path, "not an event log");
+    if (header.version != EVENT_LOG_VERSION || header.record_size != sizeof(EventLogRecord))
+        ThrowLogError(path, "event log version or record layout does not match this build");
+
+    log->symbols.clear();
+    in.seekg(header.symbols_offset);
+    for (uint32_t i = 0; i < header.num_symbols; ++i) {
+        char entry[EVENT_LOG_SYMBOL_LEN];
+        if (!in.read(entry, sizeof(entry)))
+            ThrowLogError(path, "event log is truncated");
+        log->symbols.push_back(std::string(entry, strnlen(entry, EVENT_LOG_SYMBOL_LEN)));
+    }
+
+    log->records.resize(header.num_records);
+    in.seekg(header.records_offset);
+    if (header.num_records != 0 && !in.read(reinterpret_cast<char*>(log->records.data()), header.num_records * sizeof(EventLogRecord)))
+        ThrowLogError(path, "event log is truncated");
+}
+
+size_t DiffOrderActions(const EventLog& golden, const EventLog& current, std::ostream& os, size_t maxReported)
+{
+    if (golden.symbols != current.symbols) {
+        os << "symbol sets differ; order actions are not comparable\n";
+        return golden.records.size() + current.records.size();
+    }
+
+    std::vector<const EventLogRecord*> expected;
+    std::vector<const EventLogRecord*> actual;
+    for (size_t i = 0; i < golden.records.size(); ++i) {
+        if (IsOrderAction(golden.records[i].kind))
+            expected.push_back(&golden.records[i]);
+    }
+    for (size_t i = 0; i < current.records.size(); ++i) {
+        if (IsOrderAction(current.records[i].kind))
+            actual.push_back(&current.records[i]);
+    }
+
+    size_t differences = 0;
+    size_t common = std::min(expected.size(), actual.size());
+    for (size_t i = 0; i < common; ++i) {
+        if (SameAction(*expected[i], *actual[i]))
+            continue;
+        if (differences++ < maxReported) {
+            os << "action " << i << "\n  golden  ";
+            PrintAction(os, golden, *expected[i]);
+            os << "\n  current ";
+            PrintAction(os, current, *actual[i]);
+            os << "\n";
+        }
+    }
+
+    if (expected.size() != actual.size()) {
+        os << "golden has " << expected.size() << " order actions, current run has " << actual.size() << "\n";
+        bool goldenLonger = expected.size() > actual.size();
+        const EventLog& longer = goldenLonger ? golden : current;
+        const std::vector<const EventLogRecord*>& surplus = goldenLonger ? expected : actual;
+        for (size_t i = common; i < surplus.size(); ++i) {
+            if (differences++ < maxReported) {
+                os << "action " << i << (goldenLonger ? " only in golden: " : " only in current: ");
+                PrintAction(os, longer, *surplus[i]);
+                os << "\n";
+            }
+        }
+    }
+    return differences;
+}
+
+RecordingTradeActions::RecordingTradeActions(ITradeActions& actions, EventRecorder& recorder):
+    m_actions(actions),
+    m_recorder(recorder)
+{
+}
+
+TradeActionResult RecordingTradeActions::SendNewOrder(OrderParams& params)
+{
+    AllocationPause pause;
+    TradeActionResult result = m_actions.SendNewOrder(params);
+    m_recorder.Action(EVENT_LOG_NEW_ORDER, &params, params.order_id, result);
+    return result;
+}
+
+TradeActionResult RecordingTradeActions::SendCancelOrder(OrderID orderID)
+{
+    AllocationPause pause;
+    TradeActionResult result = m_actions.SendCancelOrder(orderID);
+    m_recorder.Action(EVENT_LOG_CANCEL, NULL, orderID, result);
+    return result;
+}
+
+TradeActionResult RecordingTradeActions::SendCancelReplaceOrder(OrderID orderID, const OrderParams& params)
+{
+    AllocationPause pause;
+    TradeActionResult result = m_actions.SendCancelReplaceOrder(orderID, params);
+    m_recorder.Action(EVENT_LOG_REPLACE, &params, orderID, result);
+    return result;
+}
+
+TradeActionResult RecordingTradeActions::SendCancelAll()
+{
+    AllocationPause pause;
+    TradeActionResult result = m_actions.SendCancelAll();
+    m_recorder.Action(EVENT_LOG_CANCEL_ALL, NULL, 0, result);
+    return result;
+}
+
+} // namespace Replay
@@ -0,0 +1,167 @@
+#pragma once
+
+#ifndef _STRATEGY_STUDIO_REPLAY_EVENT_LOG_H_
+#define _STRATEGY_STUDIO_REPLAY_EVENT_LOG_H_
+
+#include <Strategy.h>
+
+#include <boost/unordered_map.hpp>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace Replay {
+
+using namespace RCM::StrategyStudio;
+
+/**
+ * Binary event log of one replay: what the strategy was told and what it did, in the order it happened.
+ * Little-endian, every section on a 64 byte boundary:
+ *
+ *   EventLogHeader
+ *   symbol dictionary   num_symbols x char[EVENT_LOG_SYMBOL_LEN], NUL padded; the strategy's symbol set in order
+ *   records             num_records x EventLogRecord
+ *
+ * A replay is deterministic, so the log of a known good build is a golden recording: the order actions of a
+ * later build on the same ticks and params must match it record for record.
+ */
+const char EVENT_LOG_MAGIC[8] = {'S', 'S', 'E', 'V', 'L', 'O', 'G', '1'};
+const uint32_t EVENT_LOG_VERSION = 1;
+const size_t EVENT_LOG_SYMBOL_LEN = 32;
+const uint16_t EVENT_LOG_NO_INSTRUMENT = 0xFFFF;
+
+enum EventLogKind {
+    // inbound: events delivered to the strategy
+    EVENT_LOG_TRADE = 1,
+    EVENT_LOG_QUOTE,
+    EVENT_LOG_DEPTH,
+    EVENT_LOG_BAR,
+    EVENT_LOG_ORDER_UPDATE,
+    EVENT_LOG_COMMAND,
+    EVENT_LOG_MARKET_STATE,
+
+    // outbound: the strategy's trade actions
+    EVENT_LOG_NEW_ORDER = 32,
+    EVENT_LOG_CANCEL,
+    EVENT_LOG_REPLACE,
+    EVENT_LOG_CANCEL_ALL
+};
+
+inline bool IsOrderAction(uint8_t kind)
+{
+    return kind >= EVENT_LOG_NEW_ORDER;
+}
+
+const char* EventLogKindName(uint8_t kind);
+
+struct EventLogHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;       // sizeof(EventLogRecord) of the writer
+    uint32_t num_symbols;
+    uint32_t reserved0;
+    uint64_t num_records;
+    uint64_t symbols_offset;
+    uint64_t records_offset;
+    uint64_t reserved[2];
+};
+
+/**
+ *   market data:   price, quantity = size; detail = depth side
+ *   bar:           price = close, quantity = volume
+ *   order update:  order_id; price, quantity = fill price and signed size cast to unsigned; detail = update type
+ *   command:       quantity = command id
+ *   new / replace: order_id, price, quantity; detail = side; attributes = order type | TIF << 8 | venue << 16;
+ *                  result = TradeActionResult
+ *   cancel:        order_id; result
+ *
+ * sequence counts the inbound events so far, so an order action carries the number of the event it answered.
+ */
+struct EventLogRecord {
+    int64_t timestamp;          // event time, nanoseconds since the unix epoch
+    uint64_t sequence;
+    uint64_t order_id;
+    double price;
+    uint32_t quantity;
+    uint16_t instrument;        // index into the symbol dictionary, EVENT_LOG_NO_INSTRUMENT for none
+    uint8_t kind;
+    uint8_t detail;
+    uint32_t result;
+    uint32_t attributes;
+};
+
+static_assert(sizeof(EventLogHeader) == 64, "event log header layout changed");
+static_assert(sizeof(EventLogRecord) == 48, "event log record layout changed; bump EVENT_LOG_VERSION");
+
+struct EventLog {
+    std::vector<std::string> symbols;
+    std::vector<EventLogRecord> records;
+};
+
+/**
+ * Collects one replay's events in memory, 48 bytes per event, for saving or diffing at the end of the run
+ */
+class EventRecorder {
+public:
+    EventRecorder();
+
+    /**
+     * Adds the next instrument of the strategy's symbol set to the dictionary
+     */
+    void AddInstrument(const Instrument* instrument);
+
+    void Inbound(EventLogKind kind, int64_t timestamp, const Instrument* instrument, double price, uint32_t quantity,
+                 uint8_t detail = 0, OrderID orderID = 0);
+    void Action(EventLogKind kind, const OrderParams* params, OrderID orderID, TradeActionResult result);
+
+    const EventLog& log() const { return m_log; }
+
+    /**
+     * Throws std::runtime_error on I/O failure
+     */
+    void Save(const std::string& path) const;
+
+private:
+    uint16_t InstrumentIndex(const Instrument* instrument) const;
+
+    EventLog m_log;
+    boost::unordered_map<const Instrument*, uint16_t> m_instruments;
+    int64_t m_now;
+    uint64_t m_inbound;
+};
+
+/**
+ * Reads a saved log; throws std::runtime_error if it is not a readable event log for this build
+ */
+void ReadEventLog(const std::string& path, EventLog* log);
+
+/**
+ * Compares the order actions of a run against a golden log, in order, and writes the first maxReported
+ * differences to os. Returns the number of order actions that differ, counting any surplus on either side.
+ */
+size_t DiffOrderActions(const EventLog& golden, const EventLog& current, std::ostream& os, size_t maxReported);
+
+/**
+ * Trade actions that pass every call on and record it with its result
+ */
+class RecordingTradeActions : public ITradeActions {
+public:
+    RecordingTradeActions(ITradeActions& actions, EventRecorder& recorder);
+
+    TradeActionResult SendNewOrder(OrderParams& params);
+    TradeActionResult SendCancelOrder(OrderID orderID);
+    TradeActionResult SendCancelReplaceOrder(OrderID orderID, const OrderParams& params);
+    TradeActionResult SendCancelAll();
+
+private:
+    ITradeActions& m_actions;
+    EventRecorder& m_recorder;
+};
+
+} // namespace Replay
+
+#endif
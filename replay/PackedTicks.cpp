@@ -0,0 +1,511 @@
+#include "PackedTicks.h"
+
+#include <fcntl.h>
+#include <math.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <stdexcept>
+
+namespace Replay {
+
+namespace {
+
+// the longest record a corrupt block can make the decoder read: a tag, a level and eight 10 byte varints (time,
+// instrument, four prices, two sizes), whatever the kind says
+const size_t MAX_VARINT_BYTES = 10;
+const size_t MAX_RECORD_BYTES = 2 + 8 * MAX_VARINT_BYTES;
+
+// zero bytes after the last block, enough for the decoder to start a record on the block's last byte and finish
+// it, including the 8 byte word GetVarint loads, without a bounds check per field
+const size_t DATA_PADDING = 128;
+static_assert(DATA_PADDING >= MAX_RECORD_BYTES + sizeof(uint64_t), "data padding must cover a whole record");
+
+const uint8_t TAG_KIND_MASK = 0x03;
+const uint8_t TAG_NEW_INSTRUMENT = 0x04;
+const uint8_t TAG_ASK = 0x08;
+const int TAG_ACTION_SHIFT = 4;
+
+const int NUM_PRICES[4] = {1, 2, 1, 4};
+const int NUM_SIZES[4] = {1, 2, 1, 1};
+const uint8_t KIND_TYPES[4] = {TICK_TYPE_TRADE, TICK_TYPE_QUOTE, TICK_TYPE_DEPTH, TICK_TYPE_BAR};
+const uint8_t ACTIONS[3] = {TICK_DEPTH_INSERT, TICK_DEPTH_UPDATE, TICK_DEPTH_DELETE};
+
+const uint64_t PRICE_SCALES[] = {1ULL, 100ULL, 10000ULL, 1000000ULL, 100000000ULL};
+
+uint64_t AlignUp(uint64_t offset)
+{
+    return (offset + 63) & ~static_cast<uint64_t>(63);
+}
+
+int32_t UtcDate(int64_t timestampNanos)
+{
+    time_t seconds = static_cast<time_t>(timestampNanos / 1000000000LL);
+    tm parts;
+    gmtime_r(&seconds, &parts);
+    return (parts.tm_year + 1900) * 10000 + (parts.tm_mon + 1) * 100 + parts.tm_mday;
+}
+
+void WritePadding(std::ofstream& out, uint64_t offset)
+{
+    static const char zeros[64] = {0};
+    uint64_t pos = static_cast<uint64_t>(out.tellp());
+    out.write(zeros, offset - pos);
+}
+
+void ThrowPackedError(const std::string& path, const std::string& what)
+{
+    throw std::runtime_error(path + ": " + what);
+}
+
+int Kind(uint8_t type)
+{
+    switch (type) {
+        case TICK_TYPE_TRADE: return 0;
+        case TICK_TYPE_QUOTE: return 1;
+        case TICK_TYPE_DEPTH: return 2;
+        case TICK_TYPE_BAR: return 3;
+        default: return -1;
+    }
+}
+
+int ActionCode(uint8_t action)
+{
+    switch (action) {
+        case TICK_DEPTH_INSERT: return 0;
+        case TICK_DEPTH_UPDATE: return 1;
+        case TICK_DEPTH_DELETE: return 2;
+        default: return -1;
+    }
+}
+
+/**
+ * True if the record holds nothing beyond what its kind's encoding keeps
+ */
+bool Representable(const TickRecord& rec, int kind)
+{
+    if (kind < 0)
+        return false;
+    if (kind == 2) {
+        if ((rec.side != TICK_SIDE_BID && rec.side != TICK_SIDE_ASK) || ActionCode(rec.action) < 0)
+            return false;
+    } else if (rec.side != TICK_SIDE_NONE || rec.action != 0 || rec.level != 0) {
+        return false;
+    }
+    for (int i = NUM_PRICES[kind]; i < 4; ++i) {
+        if (rec.price[i] != 0)
+            return false;
+    }
+    for (int i = NUM_SIZES[kind]; i < 2; ++i) {
+        if (rec.size[i] != 0)
+            return false;
+    }
+    return true;
+}
+
+bool ExactAtScale(double price, uint64_t scale)
+{
+    double scaled = price * static_cast<double>(scale);
+    if (!(fabs(scaled) < 9.0e18))
+        return false;
+    return static_cast<double>(llround(scaled)) / static_cast<double>(scale) == price;
+}
+
+uint64_t ChoosePriceScale(const std::string& path, const TickStream& stream)
+{
+    for (size_t s = 0; s < sizeof(PRICE_SCALES) / sizeof(PRICE_SCALES[0]); ++s) {
+        bool exact = true;
+        for (size_t i = 0; i < stream.records.size() && exact; ++i) {
+            const TickRecord& rec = stream.records[i];
+            int count = NUM_PRICES[Kind(rec.type)];
+            for (int p = 0; p < count && exact; ++p)
+                exact = ExactAtScale(rec.price[p], PRICE_SCALES[s]);
+        }
+        if (exact)
+            return PRICE_SCALES[s];
+    }
+    ThrowPackedError(path, "prices need more than 8 decimals to pack exactly");
+    return 0;
+}
+
+uint64_t ZigZag(int64_t v)
+{
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+int64_t UnZigZag(uint64_t v)
+{
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+void PutVarint(std::vector<uint8_t>* out, uint64_t v)
+{
+    while (v >= 0x80) {
+        out->push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out->push_back(static_cast<uint8_t>(v));
+}
+
+/**
+ * Reads a varint longer than 8 bytes, stopping after 10
+ */
+uint64_t GetLongVarint(const uint8_t*& p)
+{
+    uint64_t v = 0;
+    for (int shift = 0; shift < 7 * static_cast<int>(MAX_VARINT_BYTES); shift += 7) {
+        uint64_t byte = *p++;
+        v |= (byte & 0x7f) << shift;
+        if (byte < 0x80)
+            break;
+    }
+    return v;
+}
+
+/**
+ * Reads a varint of at most MAX_VARINT_BYTES; the caller checks the position against the block end per record, and
+ * the data padding keeps the 8 byte load inside the mapping. Lengths vary from field to field at random, so the common
+ * case of up to 8 bytes is decoded without branching on the length.
+ */
+inline uint64_t GetVarint(const uint8_t*& p)
+{
+    uint64_t word;
+    memcpy(&word, p, sizeof(word));
+    uint64_t stops = ~word & 0x8080808080808080ULL;
+    if (stops == 0)
+        return GetLongVarint(p);
+    int bits = __builtin_ctzll(stops) + 1;
+    p += bits >> 3;
+    word &= (bits == 64) ? ~0ULL : (1ULL << bits) - 1;
+    return (word & 0x7fULL)
+        | ((word >> 1) & (0x7fULL << 7))
+        | ((word >> 2) & (0x7fULL << 14))
+        | ((word >> 3) & (0x7fULL << 21))
+        | ((word >> 4) & (0x7fULL << 28))
+        | ((word >> 5) & (0x7fULL << 35))
+        | ((word >> 6) & (0x7fULL << 42))
+        | ((word >> 7) & (0x7fULL << 49));
+}
+
+struct EncoderContext {
+    int64_t price;
+    uint32_t size[4][2];
+    uint32_t block;
+};
+
+} // namespace
+
+void WritePackedTicks(const std::string& path, const TickStream& stream)
+{
+    for (size_t i = 0; i < stream.records.size(); ++i) {
+        const TickRecord& rec = stream.records[i];
+        if (rec.instrument >= stream.symbols.size() || !Representable(rec, Kind(rec.type)))
+            ThrowPackedError(path, "record " + std::to_string(i) + " cannot be packed");
+    }
+    uint64_t scale = ChoosePriceScale(path, stream);
+
+    std::vector<PackedTicksDay> days;
+    std::vector<PackedTicksBlock> blocks;
+    std::vector<uint8_t> data;
+    std::vector<EncoderContext> contexts(stream.symbols.size(), EncoderContext());
+    uint32_t previousInstrument = 0;
+    int64_t previousTimestamp = 0;
+    for (size_t i = 0; i < stream.records.size(); ++i) {
+        const TickRecord& rec = stream.records[i];
+        int32_t date = UtcDate(rec.timestamp);
+        bool newDay = days.empty() || days.back().date != date;
+        if (newDay) {
+            PackedTicksDay day = PackedTicksDay();
+            day.date = date;
+            day.first_block = static_cast<uint32_t>(blocks.size());
+            days.push_back(day);
+        }
+        if (newDay || blocks.back().num_records == PACKED_TICKS_BLOCK_RECORDS) {
+            if (!blocks.empty())
+                blocks.back().bytes = static_cast<uint32_t>(data.size() - blocks.back().offset);
+            PackedTicksBlock block = PackedTicksBlock();
+            block.first_timestamp = rec.timestamp;
+            block.offset = data.size();
+            blocks.push_back(block);
+            ++days.back().num_blocks;
+            previousTimestamp = rec.timestamp;
+        }
+        uint32_t generation = static_cast<uint32_t>(blocks.size());
+        bool firstInBlock = (blocks.back().num_records == 0);
+        ++blocks.back().num_records;
+        ++days.back().num_records;
+
+        int kind = Kind(rec.type);
+        uint8_t tag = static_cast<uint8_t>(kind);
+        if (firstInBlock || rec.instrument != previousInstrument)
+            tag |= TAG_NEW_INSTRUMENT;
+        if (kind == 2) {
+            if (rec.side == TICK_SIDE_ASK)
+                tag |= TAG_ASK;
+            tag |= static_cast<uint8_t>(ActionCode(rec.action) << TAG_ACTION_SHIFT);
+        }
+        data.push_back(tag);
+        PutVarint(&data, ZigZag(rec.timestamp - previousTimestamp));
+        if (tag & TAG_NEW_INSTRUMENT)
+            PutVarint(&data, rec.instrument);
+        if (kind == 2)
+            data.push_back(rec.level);
+
+        EncoderContext& ctx = contexts[rec.instrument];
+        if (ctx.block != generation) {
+            ctx = EncoderContext();
+            ctx.block = generation;
+        }
+        for (int p = 0; p < NUM_PRICES[kind]; ++p) {
+            int64_t ticks = llround(rec.price[p] * static_cast<double>(scale));
+            PutVarint(&data, ZigZag(ticks - ctx.price));
+            ctx.price = ticks;
+        }
+        for (int s = 0; s < NUM_SIZES[kind]; ++s) {
+            PutVarint(&data, ZigZag(static_cast<int64_t>(rec.size[s]) - ctx.size[kind][s]));
+            ctx.size[kind][s] = rec.size[s];
+        }
+
+        previousInstrument = rec.instrument;
+        previousTimestamp = rec.timestamp;
+    }
+    if (!blocks.empty())
+        blocks.back().bytes = static_cast<uint32_t>(data.size() - blocks.back().offset);
+
+    PackedTicksHeader header = PackedTicksHeader();
+    memcpy(header.magic, PACKED_TICKS_MAGIC, sizeof(header.magic));
+    header.version = PACKED_TICKS_VERSION;
+    header.num_symbols = static_cast<uint32_t>(stream.symbols.size());
+    header.num_days = static_cast<uint32_t>(days.size());
+    header.num_blocks = static_cast<uint32_t>(blocks.size());
+    header.num_records = stream.records.size();
+    header.price_scale = scale;
+    header.days_offset = AlignUp(sizeof(header) + header.num_symbols * PACKED_TICKS_SYMBOL_LEN);
+    header.blocks_offset = AlignUp(header.days_offset + header.num_days * sizeof(PackedTicksDay));
+    header.data_offset = AlignUp(header.blocks_offset + header.num_blocks * sizeof(PackedTicksBlock));
+
+    std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+    if (!out)
+        ThrowPackedError(path, "cannot create packed archive");
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (size_t i = 0; i < stream.symbols.size(); ++i) {
+        char entry[PACKED_TICKS_SYMBOL_LEN] = {0};
+        if (stream.symbols[i].size() >= PACKED_TICKS_SYMBOL_LEN)
+            ThrowPackedError(path, "symbol too long for the dictionary: " + stream.symbols[i]);
+        memcpy(entry, stream.symbols[i].data(), stream.symbols[i].size());
+        out.write(entry, sizeof(entry));
+    }
+    WritePadding(out, header.days_offset);
+    if (!days.empty())
+        out.write(reinterpret_cast<const char*>(&days[0]), days.size() * sizeof(PackedTicksDay));
+    WritePadding(out, header.blocks_offset);
+    if (!blocks.empty())
+        out.write(reinterpret_cast<const char*>(&blocks[0]), blocks.size() * sizeof(PackedTicksBlock));
+    WritePadding(out, header.data_offset);
+    data.resize(data.size() + DATA_PADDING, 0);
+    out.write(reinterpret_cast<const char*>(&data[0]), data.size());
+
+    out.close();
+    if (!out)
+        ThrowPackedError(path, "write failed");
+}
+
+bool IsPackedTicks(const std::string& path)
+{
+    std::ifstream in(path.c_str(), std::ios::binary);
+    char magic[sizeof(PACKED_TICKS_MAGIC)];
+    return in.read(magic, sizeof(magic)) && memcmp(magic, PACKED_TICKS_MAGIC, sizeof(magic)) == 0;
+}
+
+PackedTicks::PackedTicks(const std::string& path):
+    m_base(MAP_FAILED),
+    m_length(0),
+    m_header(NULL),
+    m_days(NULL),
+    m_blocks(NULL),
+    m_data(NULL)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        ThrowPackedError(path, "cannot open packed archive");
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(PackedTicksHeader)) {
+        close(fd);
+        ThrowPackedError(path, "not a packed tick archive");
+    }
+    m_length = st.st_size;
+    m_base = mmap(NULL, m_length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (m_base == MAP_FAILED)
+        ThrowPackedError(path, "mmap failed");
+
+    madvise(m_base, m_length, MADV_SEQUENTIAL | MADV_WILLNEED);
+
+    const char* base = static_cast<const char*>(m_base);
+    m_header = reinterpret_cast<const PackedTicksHeader*>(base);
+    const char* error = NULL;
+    bool scaleKnown = false;
+    for (size_t s = 0; s < sizeof(PRICE_SCALES) / sizeof(PRICE_SCALES[0]); ++s)
+        scaleKnown = scaleKnown || m_header->price_scale == PRICE_SCALES[s];
+    if (memcmp(m_header->magic, PACKED_TICKS_MAGIC, sizeof(m_header->magic)) != 0)
+        error = "not a packed tick archive";
+    else if (m_header->version != PACKED_TICKS_VERSION)
+        error = "packed archive version does not match this build";
+    else if (!scaleKnown
+             || sizeof(PackedTicksHeader) + m_header->num_symbols * PACKED_TICKS_SYMBOL_LEN > m_header->days_offset
+             || m_header->days_offset + m_header->num_days * sizeof(PackedTicksDay) > m_length
+             || m_header->blocks_offset + m_header->num_blocks * sizeof(PackedTicksBlock) > m_length
+             || m_header->data_offset > m_length
+             || m_header->days_offset % 8 != 0 || m_header->blocks_offset % 8 != 0)
+        error = "packed archive is truncated or corrupt";
+    if (error == NULL) {
+        m_days = reinterpret_cast<const PackedTicksDay*>(base + m_header->days_offset);
+        m_blocks = reinterpret_cast<const PackedTicksBlock*>(base + m_header->blocks_offset);
+        m_data = reinterpret_cast<const uint8_t*>(base + m_header->data_offset);
+
+        // every block must lie in the data section with the padding behind it, and the indexes must agree
+        uint64_t available = m_length - m_header->data_offset;
+        uint64_t records = 0;
+        for (uint32_t i = 0; i < m_header->num_blocks && error == NULL; ++i) {
+            const PackedTicksBlock& block = m_blocks[i];
+            if (block.offset > available || block.bytes + DATA_PADDING > available - block.offset
+                || block.num_records == 0 || block.num_records > PACKED_TICKS_BLOCK_RECORDS)
+                error = "packed archive is truncated or corrupt";
+            records += block.num_records;
+        }
+        uint64_t dayRecords = 0;
+        for (uint32_t i = 0; i < m_header->num_days && error == NULL; ++i) {
+            const PackedTicksDay& day = m_days[i];
+            if (day.first_block > m_header->num_blocks || day.num_blocks > m_header->num_blocks - day.first_block)
+                error = "packed archive is truncated or corrupt";
+            dayRecords += day.num_records;
+        }
+        if (error == NULL && (records != m_header->num_records || dayRecords != m_header->num_records))
+            error = "packed archive indexes do not agree";
+    }
+    if (error != NULL) {
+        munmap(m_base, m_length);
+        m_base = MAP_FAILED;
+        ThrowPackedError(path, error);
+    }
+
+    const char* symbols = base + sizeof(PackedTicksHeader);
+    m_symbols.reserve(m_header->num_symbols);
+    for (uint32_t i = 0; i < m_header->num_symbols; ++i) {
+        const char* entry = symbols + i * PACKED_TICKS_SYMBOL_LEN;
+        m_symbols.push_back(std::string(entry, strnlen(entry, PACKED_TICKS_SYMBOL_LEN)));
+    }
+}
+
+PackedTicks::~PackedTicks()
+{
+    if (m_base != MAP_FAILED)
+        munmap(m_base, m_length);
+}
+
+int PackedTicks::FindDay(int32_t date) const
+{
+    for (size_t i = 0; i < num_days(); ++i) {
+        if (m_days[i].date == date)
+            return static_cast<int>(i);
+    }
+    return -1;
+}
+
+PackedTickDecoder::PackedTickDecoder(const PackedTicks& ticks, size_t firstBlock, size_t endBlock):
+    m_ticks(ticks),
+    m_block(firstBlock),
+    m_endBlock(endBlock),
+    m_scale(ticks.price_scale()),
+    m_contexts(ticks.symbols().size(), InstrumentContext())
+{
+}
+
+size_t PackedTickDecoder::Next(TickRecord* out)
+{
+    if (m_block >= m_endBlock)
+        return 0;
+
+    const PackedTicksBlock& block = m_ticks.block(m_block);
+    const uint8_t* p = m_ticks.block_data(m_block);
+    const uint8_t* end = p + block.bytes;
+    uint32_t generation = static_cast<uint32_t>(++m_block);
+    uint32_t numInstruments = static_cast<uint32_t>(m_contexts.size());
+    uint32_t instrument = numInstruments;
+    int64_t timestamp = block.first_timestamp;
+
+    for (uint32_t n = 0; n < block.num_records; ++n) {
+        if (p >= end)
+            throw std::runtime_error("packed tick block " + std::to_string(m_block - 1) + " is corrupt");
+
+        uint8_t tag = *p++;
+        int kind = tag & TAG_KIND_MASK;
+        timestamp += UnZigZag(GetVarint(p));
+        if (tag & TAG_NEW_INSTRUMENT)
+            instrument = static_cast<uint32_t>(GetVarint(p));
+        if (instrument >= numInstruments)
+            throw std::runtime_error("packed tick block " + std::to_string(m_block - 1) + " is corrupt");
+
+        TickRecord& rec = out[n];
+        rec.timestamp = timestamp;
+        rec.instrument = instrument;
+        rec.type = KIND_TYPES[kind];
+        rec.side = TICK_SIDE_NONE;
+        rec.action = 0;
+        rec.level = 0;
+        if (kind == 2) {
+            int action = (tag >> TAG_ACTION_SHIFT) & 0x03;
+            if (action > 2)
+                throw std::runtime_error("packed tick block " + std::to_string(m_block - 1) + " is corrupt");
+            rec.side = (tag & TAG_ASK) ? TICK_SIDE_ASK : TICK_SIDE_BID;
+            rec.action = ACTIONS[action];
+            rec.level = *p++;
+        }
+
+        InstrumentContext& ctx = m_contexts[instrument];
+        if (ctx.block != generation) {
+            memset(&ctx, 0, sizeof(ctx));
+            ctx.block = generation;
+        }
+        // every kind carries at least one price and one size; only quotes and bars carry more. Dividing the integer
+        // ticks gives back the exact double the writer checked against; a multiply by the reciprocal would not.
+        int64_t price = ctx.price + UnZigZag(GetVarint(p));
+        rec.price[0] = static_cast<double>(price) / m_scale;
+        rec.price[1] = 0;
+        rec.price[2] = 0;
+        rec.price[3] = 0;
+        if (kind == 1) {
+            price += UnZigZag(GetVarint(p));
+            rec.price[1] = static_cast<double>(price) / m_scale;
+        } else if (kind == 3) {
+            for (int i = 1; i < 4; ++i) {
+                price += UnZigZag(GetVarint(p));
+                rec.price[i] = static_cast<double>(price) / m_scale;
+            }
+        }
+        ctx.price = price;
+
+        uint32_t* sizes = ctx.size[kind];
+        sizes[0] = static_cast<uint32_t>(sizes[0] + UnZigZag(GetVarint(p)));
+        rec.size[0] = sizes[0];
+        rec.size[1] = 0;
+        if (kind == 1) {
+            sizes[1] = static_cast<uint32_t>(sizes[1] + UnZigZag(GetVarint(p)));
+            rec.size[1] = sizes[1];
+        }
+        // a record that ran past the block read into the padding or the next block; stop before the next one
+        if (p > end)
+            throw std::runtime_error("packed tick block " + std::to_string(m_block - 1) + " is corrupt");
+    }
+    if (p != end)
+        throw std::runtime_error("packed tick block " + std::to_string(m_block - 1) + " is corrupt");
+    return block.num_records;
+}
+
+} // namespace Replay
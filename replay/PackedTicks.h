@@ -0,0 +1,166 @@
+#pragma once
+
+#ifndef _STRATEGY_STUDIO_REPLAY_PACKED_TICKS_H_
+#define _STRATEGY_STUDIO_REPLAY_PACKED_TICKS_H_
+
+#include "TickRecord.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+namespace Replay {
+
+/**
+ * Compressed tick archive layout. Little-endian, every section on a 64 byte boundary:
+ *
+ *   PackedTicksHeader
+ *   symbol dictionary   num_symbols x char[PACKED_TICKS_SYMBOL_LEN], NUL padded, right after the header
+ *   day index           num_days x PackedTicksDay, in time order
+ *   block index         num_blocks x PackedTicksBlock, in time order
+ *   data                the blocks' encoded records back to back, then zero padding so that the decoder may
+ *                       read a whole record past a corrupt block's end without leaving the mapping
+ *
+ * Records are kept in stream order and cut into blocks of at most PACKED_TICKS_BLOCK_RECORDS; a block
+ * never spans two days and decodes on its own. Within a block each record is:
+ *
+ *   tag         one byte: kind (0 trade, 1 quote, 2 depth, 3 bar) in bits 0-1; bit 2 set when the
+ *               instrument differs from the previous record's; depth side (1 = ask) in bit 3 and
+ *               action (0 insert, 1 update, 2 delete) in bits 4-5
+ *   time        zigzag varint nanoseconds since the previous record (the block's first_timestamp for
+ *               the first)
+ *   instrument  varint, only with bit 2
+ *   level       one byte, depth only
+ *   prices      zigzag varints in integer ticks of 1 / price_scale, each the difference from the
+ *               previous price coded for the same instrument in the block
+ *   sizes       zigzag varints, each the difference from the same size field of the instrument's
+ *               previous record of the same kind in the block
+ *
+ * Prices move a few ticks and events are microseconds apart, so most fields take one or two bytes and a
+ * 56 byte TickRecord packs into about 8. price_scale is the smallest power of ten that represents every
+ * price exactly, so decoding reproduces the records bit for bit.
+ */
+const char PACKED_TICKS_MAGIC[8] = {'S', 'S', 'P', 'A', 'C', 'K', 'S', '1'};
+const uint32_t PACKED_TICKS_VERSION = 1;
+const size_t PACKED_TICKS_SYMBOL_LEN = 32;
+const size_t PACKED_TICKS_BLOCK_RECORDS = 1024;
+
+struct PackedTicksHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t num_symbols;
+    uint32_t num_days;
+    uint32_t num_blocks;
+    uint64_t num_records;
+    uint64_t price_scale;
+    uint64_t days_offset;
+    uint64_t blocks_offset;
+    uint64_t data_offset;
+};
+
+struct PackedTicksDay {
+    int32_t date;               // yyyymmdd, UTC
+    uint32_t first_block;
+    uint32_t num_blocks;
+    uint32_t reserved;
+    uint64_t num_records;
+};
+
+struct PackedTicksBlock {
+    int64_t first_timestamp;
+    uint64_t offset;            // from data_offset
+    uint32_t bytes;
+    uint32_t num_records;
+};
+
+static_assert(sizeof(PackedTicksHeader) == 64, "packed ticks header layout changed");
+static_assert(sizeof(PackedTicksDay) == 24, "packed ticks day layout changed");
+static_assert(sizeof(PackedTicksBlock) == 24, "packed ticks block layout changed");
+
+/**
+ * Writes an in-memory stream in the packed format, splitting days on UTC dates. Throws std::runtime_error on
+ * I/O failure, when a symbol does not fit the dictionary, or when a price needs more than 8 decimals.
+ */
+void WritePackedTicks(const std::string& path, const TickStream& stream);
+
+/**
+ * True if the file starts with the packed ticks magic
+ */
+bool IsPackedTicks(const std::string& path);
+
+/**
+ * A read-only mapping of a packed archive. Nothing is decoded up front; PackedTickDecoder streams the records.
+ */
+class PackedTicks {
+public:
+    /**
+     * Maps the file and validates the header, indexes and block bounds; throws std::runtime_error if it is not
+     * a readable packed archive for this build
+     */
+    explicit PackedTicks(const std::string& path);
+    ~PackedTicks();
+
+    const std::vector<std::string>& symbols() const { return m_symbols; }
+
+    uint64_t num_records() const { return m_header->num_records; }
+    double price_scale() const { return static_cast<double>(m_header->price_scale); }
+
+    size_t num_days() const { return m_header->num_days; }
+    const PackedTicksDay& day(size_t i) const { return m_days[i]; }
+
+    /**
+     * Index of the day with the given yyyymmdd date, or -1
+     */
+    int FindDay(int32_t date) const;
+
+    size_t num_blocks() const { return m_header->num_blocks; }
+    const PackedTicksBlock& block(size_t i) const { return m_blocks[i]; }
+    const uint8_t* block_data(size_t i) const { return m_data + m_blocks[i].offset; }
+
+private:
+    PackedTicks(const PackedTicks&);
+    PackedTicks& operator=(const PackedTicks&);
+
+    void* m_base;
+    size_t m_length;
+    const PackedTicksHeader* m_header;
+    const PackedTicksDay* m_days;
+    const PackedTicksBlock* m_blocks;
+    const uint8_t* m_data;
+    std::vector<std::string> m_symbols;
+};
+
+/**
+ * Streams the records of blocks [firstBlock, endBlock) of a packed archive, one block per call, into a
+ * caller-owned buffer that is reused for every block; the day never exists in memory as a whole. Each
+ * decoder keeps its own per-instrument state, so any number may run over one mapping at once.
+ */
+class PackedTickDecoder {
+public:
+    PackedTickDecoder(const PackedTicks& ticks, size_t firstBlock, size_t endBlock);
+
+    /**
+     * Decodes the next block into out, which must hold PACKED_TICKS_BLOCK_RECORDS records. Returns the number
+     * of records decoded, 0 once every block is done. Throws std::runtime_error on a corrupt block.
+     */
+    size_t Next(TickRecord* out);
+
+private:
+    struct InstrumentContext {
+        int64_t price;
+        uint32_t size[4][2];    // by kind
+        uint32_t block;         // block the context was last set in; stale contexts start from zero
+    };
+
+    const PackedTicks& m_ticks;
+    size_t m_block;
+    size_t m_endBlock;
+    double m_scale;
+    std::vector<InstrumentContext> m_contexts;
+};
+
+} // namespace Replay
+
+#endif
@@ -0,0 +1,400 @@
+#include "ReplayHost.h"
+
+#include "AllocationCounter.h"
+
+#include <dlfcn.h>
+#include <time.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+
+namespace Replay {
+
+namespace {
+
+const int64_t NANOS_PER_SECOND = 1000000000LL;
+
+inline int64_t NowNanos()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * NANOS_PER_SECOND + ts.tv_nsec;
+}
+
+inline bool IsMarketData(Callback callback)
+{
+    return callback <= CALLBACK_BAR;
+}
+
+} // namespace
+
+const char* CallbackName(Callback callback)
+{
+    switch (callback) {
+        case CALLBACK_TRADE: return "OnTrade";
+        case CALLBACK_TOP_QUOTE: return "OnTopQuote";
+        case CALLBACK_QUOTE: return "OnQuote";
+        case CALLBACK_DEPTH: return "OnDepth";
+        case CALLBACK_BAR: return "OnBar";
+        case CALLBACK_ORDER_UPDATE: return "OnOrderUpdate";
+        case CALLBACK_STRATEGY_COMMAND: return "OnStrategyCommand";
+        case CALLBACK_MARKET_STATE: return "OnMarketState";
+        case NUM_CALLBACKS: break;
+    }
+    return "Unknown";
+}
+
+StrategyLibrary::StrategyLibrary(const std::string& path):
+    m_handle(NULL), m_getType(NULL), m_createStrategy(NULL)
+{
+    // RTLD_LOCAL keeps each library's extern "C" exports private, so several strategies can be loaded at once
+    m_handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (m_handle == NULL)
+        throw std::runtime_error(std::string("cannot load strategy library: ") + dlerror());
+
+    m_getType = reinterpret_cast<GetTypeFn>(dlsym(m_handle, "GetType"));
+    m_createStrategy = reinterpret_cast<CreateStrategyFn>(dlsym(m_handle, "CreateStrategy"));
+    if (m_getType == NULL || m_createStrategy == NULL) {
+        dlclose(m_handle);
+        throw std::runtime_error(path + " does not export GetType/CreateStrategy");
+    }
+}
+
+StrategyLibrary::~StrategyLibrary()
+{
+    dlclose(m_handle);
+}
+
+const char* StrategyLibrary::type() const
+{
+    return m_getType();
+}
+
+Strategy* StrategyLibrary::Create(const std::string& type, StrategyID strategyID, const std::string& name, const std::string& group) const
+{
+    IStrategy* strategy = m_createStrategy(type.c_str(), strategyID, name.c_str(), group.c_str());
+    if (strategy == NULL)
+        throw std::runtime_error("strategy library does not create type " + type);
+    return static_cast<Strategy*>(strategy);
+}
+
+ReplayHost::ReplayHost(Strategy* strategy, const std::vector<std::string>& streamSymbols, const ReplayOptions& options):
+    m_strategy(strategy),
+    m_streamSlots(streamSymbols.size(), static_cast<InstrumentSlot*>(NULL)),
+    m_nextBarClose(std::numeric_limits<int64_t>::max()),
+    m_now(0),
+    m_exchange(strategy->orders(), strategy->portfolio()),
+    m_recorder(options.recorder),
+    m_recordingActions(NULL),
+    m_timing(options.timing),
+    m_checkAllocations(options.checkAllocations),
+    m_allocationWarmup(options.allocationWarmup),
+    m_events(0)
+{
+    m_exchange.set_faults(options.faults);
+    const SymbolSet& symbols = options.symbols.empty() ? streamSymbols : options.symbols;
+    for (SymbolSetConstIter it = symbols.begin(); it != symbols.end(); ++it) {
+        if (m_bySymbol.count(*it))
+            continue;
+        m_instruments.push_back(InstrumentSlot(*it));
+        m_bySymbol[*it] = &m_instruments.back();
+    }
+    for (size_t i = 0; i < streamSymbols.size(); ++i)
+        m_streamSlots[i] = FindSlot(streamSymbols[i]);
+
+    if (options.log != NULL) {
+        m_strategy->logger().set_output(options.log, LOGLEVEL_DEBUG);
+    } else {
+        m_strategy->logger().set_output(&std::cerr, LOGLEVEL_INFO);
+    }
+    ITradeActions* actions = &m_exchange;
+    if (m_recorder != NULL) {
+        for (std::deque<InstrumentSlot>::const_iterator it = m_instruments.begin(); it != m_instruments.end(); ++it)
+            m_recorder->AddInstrument(&it->instrument);
+        m_recordingActions = new RecordingTradeActions(m_exchange, *m_recorder);
+        actions = m_recordingActions;
+    }
+    m_strategy->Initialize(actions, symbols);
+
+    for (size_t i = 0; i < options.params.size(); ++i) {
+        StrategyParam* param = m_strategy->params().GetParam(options.params[i].first);
+        if (param == NULL)
+            throw std::runtime_error("strategy has no param named " + options.params[i].first);
+        if (!param->SetFromString(options.params[i].second))
+            throw std::runtime_error("bad value for param " + options.params[i].first + ": " + options.params[i].second);
+        m_strategy->OnParamChanged(*param);
+    }
+
+    m_strategy->Register(this, options.date);
+}
+
+ReplayHost::~ReplayHost()
+{
+    delete m_strategy;
+    delete m_recordingActions;
+}
+
+ReplayHost::InstrumentSlot* ReplayHost::FindSlot(const SymbolTag& symbol)
+{
+    std::map<SymbolTag, InstrumentSlot*>::iterator it = m_bySymbol.find(symbol);
+    return (it != m_bySymbol.end()) ? it->second : NULL;
+}
+
+EventInstrumentPair ReplayHost::RegisterForMarketData(const SymbolTag& symbol)
+{
+    InstrumentSlot* slot = FindSlot(symbol);
+    if (slot == NULL)
+        return EventInstrumentPair(false, static_cast<const Instrument*>(NULL));
+
+    slot->marketData = true;
+    return EventInstrumentPair(true, &slot->instrument);
+}
+
+EventInstrumentPair ReplayHost::RegisterForBars(const SymbolTag& symbol, BarType barType, int interval)
+{
+    InstrumentSlot* slot = FindSlot(symbol);
+    if (slot == NULL || barType != BAR_TYPE_TIME || interval <= 0)
+        return EventInstrumentPair(false, slot ? &slot->instrument : static_cast<const Instrument*>(NULL));
+
+    BarSubscription sub;
+    sub.instrument = &slot->instrument;
+    sub.interval = interval;
+    sub.intervalNanos = interval * NANOS_PER_SECOND;
+    sub.closeTime = 0;
+    sub.open = false;
+    sub.openPrice = sub.high = sub.low = sub.close = 0;
+    sub.volume = 0;
+
+    slot->bars.push_back(m_bars.size());
+    m_bars.push_back(sub);
+    return EventInstrumentPair(true, &slot->instrument);
+}
+
+template <typename Msg>
+void ReplayHost::Invoke(Callback callback, void (IStrategy::*handler)(const Msg&), const Msg& msg)
+{
+    bool counting = m_checkAllocations && m_events > m_allocationWarmup && IsMarketData(callback);
+    unsigned long long allocations = counting ? ThreadAllocations() : 0;
+
+    if (!m_timing) {
+        (m_strategy->*handler)(msg);
+    } else {
+        int64_t start = NowNanos();
+        (m_strategy->*handler)(msg);
+        m_stats[callback].Record(NowNanos() - start);
+    }
+
+    if (counting)
+        m_stats[callback].allocations += ThreadAllocations() - allocations;
+}
+
+void ReplayHost::Dispatch(const TickRecord& record)
+{
+    m_now = record.timestamp;
+    if (m_now >= m_nextBarClose)
+        CloseBars(m_now);
+
+    ++m_events;
+    InstrumentSlot* slot = (record.instrument < m_streamSlots.size()) ? m_streamSlots[record.instrument] : NULL;
+    if (slot == NULL)
+        return;
+
+    Instrument& instrument = slot->instrument;
+    TimeType eventTime = TimeFromNanos(record.timestamp);
+    if (m_recorder != NULL)
+        RecordTick(record, &instrument);
+
+    switch (record.type) {
+        case TICK_TYPE_TRADE: {
+            Trade trade(record.price[0], static_cast<int>(record.size[0]));
+            instrument.set_last_trade(trade);
+            m_exchange.OnTrade(&instrument, trade.price());
+            if (!slot->bars.empty())
+                AddTradeToBars(*slot, record.timestamp, trade.price(), record.size[0]);
+            if (slot->marketData)
+                Invoke(CALLBACK_TRADE, &IStrategy::OnTrade, TradeDataEventMsg(instrument, trade, eventTime));
+            break;
+        }
+        case TICK_TYPE_QUOTE: {
+            MarketModels::AggrOrderBook& book = instrument.mutable_order_book();
+            book.ApplyDepth(true, record.size[0] ? MarketModels::DEPTH_UPDATE_TYPE_UPDATE : MarketModels::DEPTH_UPDATE_TYPE_DELETE, 0, record.price[0], record.size[0]);
+            book.ApplyDepth(false, record.size[1] ? MarketModels::DEPTH_UPDATE_TYPE_UPDATE : MarketModels::DEPTH_UPDATE_TYPE_DELETE, 0, record.price[1], record.size[1]);
+            instrument.mutable_top_quote().set(record.price[0], record.size[0], record.price[1], record.size[1]);
+            m_exchange.OnQuote(&instrument);
+            if (slot->marketData) {
+                QuoteEventMsg msg(instrument, instrument.top_quote(), eventTime);
+                Invoke(CALLBACK_QUOTE, &IStrategy::OnQuote, msg);
+                Invoke(CALLBACK_TOP_QUOTE, &IStrategy::OnTopQuote, msg);
+            }
+            break;
+        }
+        case TICK_TYPE_DEPTH: {
+            bool bid = (record.side == TICK_SIDE_BID);
+            MarketModels::DepthUpdateType updateType = (record.action == TICK_DEPTH_INSERT) ? MarketModels::DEPTH_UPDATE_TYPE_INSERT :
+                ((record.action == TICK_DEPTH_DELETE) ? MarketModels::DEPTH_UPDATE_TYPE_DELETE : MarketModels::DEPTH_UPDATE_TYPE_UPDATE);
+            MarketModels::AggrOrderBook& book = instrument.mutable_order_book();
+            book.ApplyDepth(bid, updateType, record.level, record.price[0], record.size[0]);
+
+            bool topChanged = (record.level == 0);
+            if (topChanged) {
+                const IPriceLevel* bestBid = book.BidPriceLevelAtLevel(0);
+                const IPriceLevel* bestAsk = book.AskPriceLevelAtLevel(0);
+                instrument.mutable_top_quote().set(bestBid ? bestBid->price() : 0, bestBid ? bestBid->size() : 0,
+                                                   bestAsk ? bestAsk->price() : 0, bestAsk ? bestAsk->size() : 0);
+                m_exchange.OnQuote(&instrument);
+            }
+            if (slot->marketData) {
+                Invoke(CALLBACK_DEPTH, &IStrategy::OnDepth,
+                       MarketDepthEventMsg(instrument, bid, updateType, record.level, record.price[0], record.size[0], eventTime));
+                if (topChanged) {
+                    QuoteEventMsg msg(instrument, instrument.top_quote(), eventTime);
+                    Invoke(CALLBACK_QUOTE, &IStrategy::OnQuote, msg);
+                    Invoke(CALLBACK_TOP_QUOTE, &IStrategy::OnTopQuote, msg);
+                }
+            }
+            break;
+        }
+        case TICK_TYPE_BAR:
+            if (!slot->bars.empty()) {
+                Bar bar(record.price[0], record.price[1], record.price[2], record.price[3], record.size[0]);
+                Invoke(CALLBACK_BAR, &IStrategy::OnBar, BarEventMsg(instrument, bar, eventTime, m_bars[slot->bars.front()].interval));
+            }
+            break;
+    }
+
+    DeliverOrderUpdates();
+}
+
+void ReplayHost::AddTradeToBars(const InstrumentSlot& slot, int64_t now, double price, unsigned size)
+{
+    for (std::vector<size_t>::const_iterator it = slot.bars.begin(); it != slot.bars.end(); ++it) {
+        BarSubscription& sub = m_bars[*it];
+        if (!sub.open) {
+            sub.open = true;
+            sub.closeTime = (now / sub.intervalNanos + 1) * sub.intervalNanos;
+            sub.openPrice = sub.high = sub.low = price;
+            sub.volume = 0;
+            m_nextBarClose = std::min(m_nextBarClose, sub.closeTime);
+        }
+        sub.high = std::max(sub.high, price);
+        sub.low = std::min(sub.low, price);
+        sub.close = price;
+        sub.volume += size;
+    }
+}
+
+void ReplayHost::CloseBars(int64_t now)
+{
+    m_nextBarClose = std::numeric_limits<int64_t>::max();
+    for (std::vector<BarSubscription>::iterator it = m_bars.begin(); it != m_bars.end(); ++it) {
+        if (!it->open)
+            continue;
+        if (it->closeTime > now) {
+            m_nextBarClose = std::min(m_nextBarClose, it->closeTime);
+            continue;
+        }
+
+        it->open = false;
+        if (m_recorder != NULL)
+            m_recorder->Inbound(EVENT_LOG_BAR, it->closeTime, it->instrument, it->close, static_cast<uint32_t>(it->volume));
+        Bar bar(it->openPrice, it->high, it->low, it->close, it->volume);
+        Invoke(CALLBACK_BAR, &IStrategy::OnBar, BarEventMsg(*it->instrument, bar, TimeFromNanos(it->closeTime), it->interval));
+    }
+    DeliverOrderUpdates();
+}
+
+void ReplayHost::Finish()
+{
+    CloseBars(std::numeric_limits<int64_t>::max());
+
+    // the end of the data is the market close; strategies building their own bars close them here
+    if (m_recorder != NULL)
+        m_recorder->Inbound(EVENT_LOG_MARKET_STATE, m_now, NULL, 0, 0);
+    Invoke(CALLBACK_MARKET_STATE, &IStrategy::OnMarketState, MarketStateEventMsg(TimeFromNanos(m_now)));
+    DeliverOrderUpdates();
+}
+
+void ReplayHost::DeliverOrderUpdates()
+{
+    SimExchange::PendingUpdate update;
+    while (m_exchange.PopUpdate(&update)) {
+        if (m_recorder != NULL) {
+            m_recorder->Inbound(EVENT_LOG_ORDER_UPDATE, m_now, update.order->instrument(), update.fill.fill_price(),
+                                static_cast<uint32_t>(update.fill.fill_size()), static_cast<uint8_t>(update.type), update.order->order_id());
+        }
+        OrderUpdateEventMsg msg(*update.order, update.type, update.fill, TimeFromNanos(m_now));
+        Invoke(CALLBACK_ORDER_UPDATE, &IStrategy::OnOrderUpdate, msg);
+    }
+}
+
+void ReplayHost::SendCommand(int commandID)
+{
+    if (m_recorder != NULL)
+        m_recorder->Inbound(EVENT_LOG_COMMAND, m_now, NULL, 0, static_cast<uint32_t>(commandID));
+    Invoke(CALLBACK_STRATEGY_COMMAND, &IStrategy::OnStrategyCommand, StrategyCommandEventMsg(commandID, TimeFromNanos(m_now)));
+    DeliverOrderUpdates();
+}
+
+void ReplayHost::RecordTick(const TickRecord& record, const Instrument* instrument)
+{
+    EventLogKind kind = EVENT_LOG_TRADE;
+    switch (record.type) {
+        case TICK_TYPE_QUOTE: kind = EVENT_LOG_QUOTE; break;
+        case TICK_TYPE_DEPTH: kind = EVENT_LOG_DEPTH; break;
+        case TICK_TYPE_BAR: kind = EVENT_LOG_BAR; break;
+    }
+    double price = (record.type == TICK_TYPE_BAR) ? record.price[3] : record.price[0];
+    m_recorder->Inbound(kind, record.timestamp, instrument, price, record.size[0], record.side);
+}
+
+unsigned long long ReplayHost::hot_allocations() const
+{
+    unsigned long long total = 0;
+    for (int i = 0; i < NUM_CALLBACKS; ++i)
+        total += m_stats[i].allocations;
+    return total;
+}
+
+void ReplayHost::Report(std::ostream& os, double wallSeconds) const
+{
+    os << "events            " << m_events << "\n"
+       << "wall time (s)     " << std::fixed << std::setprecision(3) << wallSeconds << "\n"
+       << "events/s          " << std::setprecision(0) << (wallSeconds > 0 ? m_events / wallSeconds : 0.0) << "\n";
+
+    if (m_timing) {
+        os << "\n" << std::left << std::setw(20) << "callback" << std::right
+           << std::setw(14) << "calls" << std::setw(12) << "mean ns" << std::setw(12) << "max ns" << std::setw(12) << "total ms" << "\n";
+        for (int i = 0; i < NUM_CALLBACKS; ++i) {
+            const CallbackStats& s = m_stats[i];
+            if (s.calls == 0)
+                continue;
+            os << std::left << std::setw(20) << CallbackName(static_cast<Callback>(i)) << std::right
+               << std::setw(14) << s.calls
+               << std::setw(12) << std::setprecision(1) << s.mean_nanos()
+               << std::setw(12) << s.maxNanos
+               << std::setw(12) << std::setprecision(3) << s.totalNanos / 1e6 << "\n";
+        }
+    }
+
+    const SimExchange::Counters& c = m_exchange.counters();
+    os << "\norders new " << c.newOrders << " cancel " << c.cancels << " replace " << c.replaces
+       << " fills " << c.fills << " rejects " << c.rejects << "\n"
+       << "messages/1M evts  " << std::setprecision(0) << (m_events ? c.messages() * 1e6 / m_events : 0.0) << "\n"
+       << "total pnl         " << std::setprecision(2) << m_strategy->portfolio().total_pnl() << "\n";
+
+    if (m_checkAllocations) {
+        os << "hot allocations   " << hot_allocations() << " after " << m_allocationWarmup << " warm-up events";
+        for (int i = 0; i < NUM_CALLBACKS; ++i) {
+            if (m_stats[i].allocations != 0)
+                os << ", " << CallbackName(static_cast<Callback>(i)) << " " << m_stats[i].allocations;
+        }
+        os << "\n";
+    }
+    os.unsetf(std::ios::floatfield);
+}
+
+} // namespace Replay
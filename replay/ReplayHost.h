@@ -0,0 +1,210 @@
+#pragma once
+
+#ifndef _STRATEGY_STUDIO_REPLAY_REPLAY_HOST_H_
+#define _STRATEGY_STUDIO_REPLAY_REPLAY_HOST_H_
+
+#include "EventLog.h"
+#include "SimExchange.h"
+#include "TickRecord.h"
+
+#include <Strategy.h>
+
+#include <stdint.h>
+
+#include <deque>
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Replay {
+
+using namespace RCM::StrategyStudio;
+
+enum Callback {
+    CALLBACK_TRADE = 0,
+    CALLBACK_TOP_QUOTE,
+    CALLBACK_QUOTE,
+    CALLBACK_DEPTH,
+    CALLBACK_BAR,
+    CALLBACK_ORDER_UPDATE,
+    CALLBACK_STRATEGY_COMMAND,
+    CALLBACK_MARKET_STATE,
+    NUM_CALLBACKS
+};
+
+const char* CallbackName(Callback callback);
+
+struct CallbackStats {
+    CallbackStats(): calls(0), totalNanos(0), maxNanos(0), allocations(0) {}
+
+    void Record(int64_t nanos)
+    {
+        ++calls;
+        totalNanos += nanos;
+        if (nanos > maxNanos)
+            maxNanos = nanos;
+    }
+
+    double mean_nanos() const { return calls ? static_cast<double>(totalNanos) / calls : 0.0; }
+
+    unsigned long long calls;
+    int64_t totalNanos;
+    int64_t maxNanos;
+    unsigned long long allocations;     // heap allocations made by the strategy after warm-up, when checked
+};
+
+/**
+ * A strategy shared object built against the stand-in SDK, opened with dlopen
+ */
+class StrategyLibrary {
+public:
+    explicit StrategyLibrary(const std::string& path);
+    ~StrategyLibrary();
+
+    const char* type() const;
+
+    /**
+     * Calls the library's CreateStrategy export; throws if it does not know the type
+     */
+    Strategy* Create(const std::string& type, StrategyID strategyID, const std::string& name, const std::string& group) const;
+
+private:
+    StrategyLibrary(const StrategyLibrary&);
+    StrategyLibrary& operator=(const StrategyLibrary&);
+
+    typedef const char* (*GetTypeFn)();
+    typedef IStrategy* (*CreateStrategyFn)(const char*, unsigned, const char*, const char*);
+
+    void* m_handle;
+    GetTypeFn m_getType;
+    CreateStrategyFn m_createStrategy;
+};
+
+struct ReplayOptions {
+    ReplayOptions(): timing(true), log(NULL), recorder(NULL), checkAllocations(false), allocationWarmup(0) {}
+
+    SymbolSet symbols;                                          // the strategy's symbol set, in order
+    std::vector<std::pair<std::string, std::string> > params;   // overrides applied after DefineStrategyParams
+    DateType date;
+    bool timing;                                                // time every strategy callback
+    std::ostream* log;                                          // LogToClient sink for every level; NULL sends INFO and above to stderr
+    EventRecorder* recorder;                                    // records every delivered event and trade action; NULL disables
+    bool checkAllocations;                                      // count heap allocations in market data callbacks
+    unsigned long long allocationWarmup;                        // events before allocations count against the strategy
+    SimExchange::Faults faults;                                 // rejects and partial fills the exchange produces
+};
+
+/**
+ * Drives one strategy instance from recorded events at full speed, standing in for the Strategy Studio server.
+ *
+ * The host owns the instruments and the simulated exchange. It applies each record to the instrument's state,
+ * builds time bars from trades for bar subscriptions, invokes the subscribed callbacks and then delivers any order
+ * updates the strategy's actions produced. Records for symbols outside the strategy's symbol set are skipped.
+ * With a recorder, every event delivered and every trade action taken goes into its event log.
+ *
+ * With checkAllocations, the host counts the heap allocations the strategy makes inside its trade, quote, depth
+ * and bar callbacks once warm-up is over; a strategy that sizes its state at registration should make none. Work
+ * the simulated exchange does on the strategy's behalf is not counted.
+ */
+class ReplayHost : public StrategyEventRegister {
+public:
+    /**
+     * Takes ownership of the strategy, initializes it and runs its registration.
+     * streamSymbols is the dictionary that incoming records' instrument indices refer to.
+     */
+    ReplayHost(Strategy* strategy, const std::vector<std::string>& streamSymbols, const ReplayOptions& options);
+    ~ReplayHost();
+
+    void Dispatch(const TickRecord& record);
+
+    void Run(const TickRecord* begin, const TickRecord* end)
+    {
+        for (const TickRecord* it = begin; it != end; ++it)
+            Dispatch(*it);
+    }
+
+    /**
+     * Closes any bars still open at the end of the stream and sends the strategy a market state
+     * event for the close
+     */
+    void Finish();
+
+    void SendCommand(int commandID);
+
+    Strategy& strategy() { return *m_strategy; }
+    const SimExchange& exchange() const { return m_exchange; }
+    const CallbackStats& stats(Callback callback) const { return m_stats[callback]; }
+    unsigned long long events() const { return m_events; }
+
+    /**
+     * Heap allocations the strategy made in market data callbacks after the warm-up; always 0 unless
+     * checkAllocations is set, which needs AllocationCounter.cpp linked into the binary
+     */
+    unsigned long long hot_allocations() const;
+
+    /**
+     * Prints throughput, per-callback timing and order activity
+     */
+    void Report(std::ostream& os, double wallSeconds) const;
+
+public: /* StrategyEventRegister */
+    EventInstrumentPair RegisterForMarketData(const SymbolTag& symbol);
+    EventInstrumentPair RegisterForBars(const SymbolTag& symbol, BarType barType, int interval);
+
+private:
+    struct BarSubscription {
+        Instrument* instrument;
+        int interval;
+        int64_t intervalNanos;
+        int64_t closeTime;
+        bool open;
+        double openPrice;
+        double high;
+        double low;
+        double close;
+        long long volume;
+    };
+
+    struct InstrumentSlot {
+        explicit InstrumentSlot(const SymbolTag& symbol): instrument(symbol), marketData(false) {}
+
+        Instrument instrument;
+        bool marketData;
+        std::vector<size_t> bars;   // indices into m_bars
+    };
+
+    ReplayHost(const ReplayHost&);
+    ReplayHost& operator=(const ReplayHost&);
+
+    InstrumentSlot* FindSlot(const SymbolTag& symbol);
+    void CloseBars(int64_t now);
+    void AddTradeToBars(const InstrumentSlot& slot, int64_t now, double price, unsigned size);
+    void DeliverOrderUpdates();
+    void RecordTick(const TickRecord& record, const Instrument* instrument);
+
+    template <typename Msg>
+    void Invoke(Callback callback, void (IStrategy::*handler)(const Msg&), const Msg& msg);
+
+private:
+    Strategy* m_strategy;
+    std::deque<InstrumentSlot> m_instruments;      // one per symbol in the strategy's symbol set
+    std::map<SymbolTag, InstrumentSlot*> m_bySymbol;
+    std::vector<InstrumentSlot*> m_streamSlots;    // indexed by stream symbol index; NULL when not traded
+    std::vector<BarSubscription> m_bars;
+    int64_t m_nextBarClose;
+    int64_t m_now;
+    SimExchange m_exchange;
+    EventRecorder* m_recorder;
+    RecordingTradeActions* m_recordingActions;     // wraps m_exchange while recording
+    bool m_timing;
+    bool m_checkAllocations;
+    unsigned long long m_allocationWarmup;
+    unsigned long long m_events;
+    CallbackStats m_stats[NUM_CALLBACKS];
+};
+
+} // namespace Replay
+
+#endif
@@ -0,0 +1,204 @@
+/**
+ * strategy_replay: runs a Strategy Studio strategy from a tick file without the Strategy Studio server.
+ *
+ * Build the strategy against the stand-in SDK, then the host:
+ *
+ *   g++ -O2 -fPIC -shared -pthread -Ireplay/sdk signed_volume_strategy/signedVolumeStrategy.cpp -o libSignedVolumeTrade.so
+ *   g++ -O2 -Ireplay/sdk replay/ReplayMain.cpp replay/ReplayHost.cpp replay/SimExchange.cpp replay/TickFile.cpp \
+ *       replay/TickArchive.cpp replay/PackedTicks.cpp replay/EventLog.cpp replay/AllocationCounter.cpp -o strategy_replay -ldl
+ *
+ * Usage:
+ *
+ *   strategy_replay --strategy <lib.so> --ticks <file> [--type <type>] [--symbols A,B,...] [--day <yyyymmdd>]
+ *                   [--param <name>=<value>]... [--command <id>]... [--repeat <n>] [--log] [--no-timing]
+ *                   [--record <log>] [--golden <log>] [--check-allocations <warmup events>]
+ *                   [--reject-replaces <n>] [--reject-cancels <n>] [--partial-fills]
+ *
+ * --ticks takes a text tick file or a binary archive written by tick_convert; flat archives are mapped and replayed
+ * in place, packed ones (tick_convert --packed) are mapped and decoded a block at a time as the replay goes, and
+ * --day limits the replay to one day of the archive's index.
+ * --symbols sets the strategy's symbol set in order (default: every symbol in the tick file), --command sends a
+ * strategy command after the replay, --repeat replays the loaded day n times into fresh strategy instances.
+ *
+ * --record saves the first run's event log: every event delivered to the strategy and every trade action it took.
+ * --golden replays against such a log and diffs the first run's order actions with it, exiting 3 if any differ.
+ * Together with the per-callback timing this is the gate for changes meant to be faster without trading
+ * differently: record a golden log before the change, then replay with --golden --repeat n after it. Only run 1 is
+ * recorded, so runs 2..n are timed without the recorder in the way.
+ *
+ * --check-allocations counts the heap allocations the strategy makes in its market data callbacks once the given
+ * number of events has gone by, and exits 4 if there are any: after warm-up the hot path must not allocate.
+ *
+ * --reject-replaces and --reject-cancels have the simulated exchange refuse every nth cancel-replace or cancel,
+ * and --partial-fills makes limit orders fill in halves, to exercise the order handling paths a clean replay
+ * never reaches.
+ */
+
+#include "ReplayHost.h"
+#include "TickSource.h"
+
+#include <stdlib.h>
+#include <time.h>
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace Replay;
+
+namespace {
+
+void Usage()
+{
+    std::cerr << "usage: strategy_replay --strategy <lib.so> --ticks <file> [--type <type>] [--symbols A,B,...] [--day <yyyymmdd>]\n"
+                 "                       [--param <name>=<value>]... [--command <id>]... [--repeat <n>] [--log] [--no-timing]\n"
+                 "                       [--record <log>] [--golden <log>] [--check-allocations <warmup events>]\n"
+                 "                       [--reject-replaces <n>] [--reject-cancels <n>] [--partial-fills]\n";
+    exit(2);
+}
+
+double WallSeconds()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+SymbolSet SplitSymbols(const std::string& list)
+{
+    SymbolSet symbols;
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t comma = list.find(',', start);
+        std::string symbol = list.substr(start, comma - start);
+        if (!symbol.empty())
+            symbols.push_back(symbol);
+        if (comma == std::string::npos)
+            break;
+        start = comma + 1;
+    }
+    return symbols;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::string libraryPath;
+    std::string ticksPath;
+    std::string type;
+    std::vector<int> commands;
+    int repeat = 1;
+    int day = 0;
+    std::string recordPath;
+    std::string goldenPath;
+    ReplayOptions options;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--strategy" && hasValue) {
+            libraryPath = argv[++i];
+        } else if (arg == "--ticks" && hasValue) {
+            ticksPath = argv[++i];
+        } else if (arg == "--type" && hasValue) {
+            type = argv[++i];
+        } else if (arg == "--symbols" && hasValue) {
+            options.symbols = SplitSymbols(argv[++i]);
+        } else if (arg == "--param" && hasValue) {
+            std::string kv = argv[++i];
+            size_t eq = kv.find('=');
+            if (eq == std::string::npos)
+                Usage();
+            options.params.push_back(std::make_pair(kv.substr(0, eq), kv.substr(eq + 1)));
+        } else if (arg == "--command" && hasValue) {
+            commands.push_back(atoi(argv[++i]));
+        } else if (arg == "--day" && hasValue) {
+            day = atoi(argv[++i]);
+        } else if (arg == "--repeat" && hasValue) {
+            repeat = atoi(argv[++i]);
+        } else if (arg == "--record" && hasValue) {
+            recordPath = argv[++i];
+        } else if (arg == "--golden" && hasValue) {
+            goldenPath = argv[++i];
+        } else if (arg == "--check-allocations" && hasValue) {
+            options.checkAllocations = true;
+            options.allocationWarmup = strtoull(argv[++i], NULL, 10);
+        } else if (arg == "--reject-replaces" && hasValue) {
+            options.faults.rejectReplaceEvery = static_cast<unsigned>(atoi(argv[++i]));
+        } else if (arg == "--reject-cancels" && hasValue) {
+            options.faults.rejectCancelEvery = static_cast<unsigned>(atoi(argv[++i]));
+        } else if (arg == "--partial-fills") {
+            options.faults.partialFills = true;
+        } else if (arg == "--log") {
+            options.log = &std::cerr;
+        } else if (arg == "--no-timing") {
+            options.timing = false;
+        } else {
+            Usage();
+        }
+    }
+    if (libraryPath.empty() || ticksPath.empty() || repeat < 1)
+        Usage();
+
+    try {
+        StrategyLibrary library(libraryPath);
+        if (type.empty())
+            type = library.type();
+
+        double loadStart = WallSeconds();
+        TickSource source(ticksPath, day);
+        std::cout << "loaded " << source.size() << " events for " << source.symbols().size()
+                  << " symbols in " << WallSeconds() - loadStart << " s\n";
+        if (source.size() != 0)
+            options.date = TimeFromNanos(source.first_timestamp()).date();
+
+        EventLog golden;
+        if (!goldenPath.empty())
+            ReadEventLog(goldenPath, &golden);
+
+        size_t differences = 0;
+        unsigned long long allocations = 0;
+        for (int run = 0; run < repeat; ++run) {
+            EventRecorder recorder;
+            ReplayOptions runOptions = options;
+            bool recording = (run == 0 && (!recordPath.empty() || !goldenPath.empty()));
+            if (recording)
+                runOptions.recorder = &recorder;
+            ReplayHost host(library.Create(type, run + 1, type, "replay"), source.symbols(), runOptions);
+
+            double start = WallSeconds();
+            source.ForEachBatch([&](const TickRecord* begin, const TickRecord* end) { host.Run(begin, end); });
+            host.Finish();
+            double elapsed = WallSeconds() - start;
+
+            for (size_t i = 0; i < commands.size(); ++i)
+                host.SendCommand(commands[i]);
+
+            std::cout << "\n== " << type << " run " << run + 1 << " ==\n";
+            host.Report(std::cout, elapsed);
+            allocations += host.hot_allocations();
+
+            if (recording && !recordPath.empty()) {
+                recorder.Save(recordPath);
+                std::cout << "recorded " << recorder.log().records.size() << " events and actions to " << recordPath << "\n";
+            }
+            if (recording && !goldenPath.empty()) {
+                differences = DiffOrderActions(golden, recorder.log(), std::cout, 10);
+                if (differences == 0)
+                    std::cout << "golden check      order actions match " << goldenPath << "\n";
+                else
+                    std::cout << "golden check      " << differences << " order actions differ from " << goldenPath << "\n";
+            }
+        }
+        if (differences != 0)
+            return 3;
+        if (allocations != 0)
+            return 4;
+    } catch (const std::exception& e) {
+        std::cerr << "strategy_replay: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
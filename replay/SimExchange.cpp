@@ -0,0 +1,218 @@
+#include "SimExchange.h"
+
+#include "AllocationCounter.h"
+
+#include <algorithm>
+
+namespace Replay {
+
+SimExchange::SimExchange(IOrderTracker& orders, PortfolioTracker& portfolio):
+    m_orders(orders),
+    m_portfolio(portfolio),
+    m_nextOrderID(1)
+{
+}
+
+TradeActionResult SimExchange::SendNewOrder(OrderParams& params)
+{
+    AllocationPause pause;
+    ++m_counters.newOrders;
+    if (params.instrument == NULL || params.quantity == 0 || (params.order_side != ORDER_SIDE_BUY && !IsSellSide(params.order_side))) {
+        ++m_counters.rejects;
+        return TRADE_ACTION_RESULT_INVALID_ORDER;
+    }
+
+    params.order_id = m_nextOrderID++;
+    m_allOrders.push_back(Order(params));
+    Order* order = &m_allOrders.back();
+    order->set_state(ORDER_STATE_OPEN);
+    m_working[order->order_id()] = order;
+    m_orders.AddWorking(order);
+    Queue(order, ORDER_UPDATE_TYPE_NEW, FillInfo());
+
+    if (!TryFillAtTouch(order)) {
+        if (order->order_type() == ORDER_TYPE_MARKET) {
+            // nothing to trade against; the market order dies
+            Complete(order, ORDER_STATE_REJECTED, ORDER_UPDATE_TYPE_REJECT);
+            ++m_counters.rejects;
+        } else {
+            m_resting[order->instrument()].push_back(order);
+        }
+    }
+    return TRADE_ACTION_RESULT_SUCCESSFUL;
+}
+
+TradeActionResult SimExchange::SendCancelOrder(OrderID orderID)
+{
+    AllocationPause pause;
+    ++m_counters.cancels;
+    Order* order = FindWorking(orderID);
+    if (order == NULL)
+        return TRADE_ACTION_RESULT_ORDER_NOT_FOUND;
+    if (m_faults.rejectCancelEvery != 0 && m_counters.cancels % m_faults.rejectCancelEvery == 0) {
+        ++m_counters.rejects;
+        Queue(order, ORDER_UPDATE_TYPE_CANCEL_REJECT, FillInfo());
+        return TRADE_ACTION_RESULT_SUCCESSFUL;
+    }
+
+    RemoveResting(order);
+    Complete(order, ORDER_STATE_CANCELLED, ORDER_UPDATE_TYPE_CANCEL);
+    return TRADE_ACTION_RESULT_SUCCESSFUL;
+}
+
+TradeActionResult SimExchange::SendCancelReplaceOrder(OrderID orderID, const OrderParams& params)
+{
+    AllocationPause pause;
+    ++m_counters.replaces;
+    Order* order = FindWorking(orderID);
+    if (order == NULL)
+        return TRADE_ACTION_RESULT_ORDER_NOT_FOUND;
+    if (params.quantity <= order->executed_quantity())
+        return TRADE_ACTION_RESULT_INVALID_ORDER;
+    if (m_faults.rejectReplaceEvery != 0 && m_counters.replaces % m_faults.rejectReplaceEvery == 0) {
+        ++m_counters.rejects;
+        Queue(order, ORDER_UPDATE_TYPE_REPLACE_REJECT, FillInfo());
+        return TRADE_ACTION_RESULT_SUCCESSFUL;
+    }
+
+    order->replace_params(params);
+    Queue(order, ORDER_UPDATE_TYPE_MODIFY, FillInfo());
+    if (TryFillAtTouch(order))
+        RemoveResting(order);
+    return TRADE_ACTION_RESULT_SUCCESSFUL;
+}
+
+TradeActionResult SimExchange::SendCancelAll()
+{
+    AllocationPause pause;
+    std::vector<Order*> working(m_orders.working_orders_begin(), m_orders.working_orders_end());
+    for (std::vector<Order*>::iterator it = working.begin(); it != working.end(); ++it)
+        SendCancelOrder((*it)->order_id());
+    return TRADE_ACTION_RESULT_SUCCESSFUL;
+}
+
+void SimExchange::OnQuote(const Instrument* instrument)
+{
+    RestingMap::iterator it = m_resting.find(instrument);
+    if (it == m_resting.end())
+        return;
+
+    RestingOrders& resting = it->second;
+    for (size_t i = 0; i < resting.size();) {
+        if (TryFillAtTouch(resting[i])) {
+            resting[i] = resting.back();
+            resting.pop_back();
+        } else {
+            ++i;
+        }
+    }
+}
+
+void SimExchange::OnTrade(const Instrument* instrument, double price)
+{
+    RestingMap::iterator it = m_resting.find(instrument);
+    if (it == m_resting.end())
+        return;
+
+    RestingOrders& resting = it->second;
+    for (size_t i = 0; i < resting.size();) {
+        Order* order = resting[i];
+        bool through = IsBuySide(order->order_side()) ? price < order->price() : price > order->price();
+        if (through && Fill(order, order->price())) {
+            resting[i] = resting.back();
+            resting.pop_back();
+        } else {
+            ++i;
+        }
+    }
+}
+
+bool SimExchange::PopUpdate(PendingUpdate* update)
+{
+    if (m_updates.empty())
+        return false;
+    *update = m_updates.front();
+    m_updates.pop_front();
+    return true;
+}
+
+Order* SimExchange::FindWorking(OrderID orderID)
+{
+    boost::unordered_map<OrderID, Order*>::iterator it = m_working.find(orderID);
+    return (it != m_working.end()) ? it->second : NULL;
+}
+
+bool SimExchange::TryFillAtTouch(Order* order)
+{
+    const Instrument* instrument = order->instrument();
+    const Quote& quote = instrument->top_quote();
+    bool buy = IsBuySide(order->order_side());
+    double touch = buy ? quote.ask() : quote.bid();
+
+    if (touch <= 0) {
+        if (order->order_type() != ORDER_TYPE_MARKET || instrument->last_trade().price() <= 0)
+            return false;
+        touch = instrument->last_trade().price();
+    }
+
+    if (order->order_type() == ORDER_TYPE_LIMIT && (buy ? touch > order->price() : touch < order->price()))
+        return false;
+
+    return Fill(order, touch);
+}
+
+bool SimExchange::Fill(Order* order, double price)
+{
+    unsigned quantity = order->leaves_quantity();
+    if (m_faults.partialFills && order->order_type() == ORDER_TYPE_LIMIT && quantity > 1)
+        quantity /= 2;
+    int signedQuantity = IsBuySide(order->order_side()) ? static_cast<int>(quantity) : -static_cast<int>(quantity);
+
+    order->add_execution(quantity);
+    m_portfolio.ApplyFill(order->instrument(), signedQuantity, price);
+    ++m_counters.fills;
+
+    if (order->leaves_quantity() != 0) {
+        order->set_state(ORDER_STATE_PARTIALLY_FILLED);
+        Queue(order, ORDER_UPDATE_TYPE_PARTIAL_FILL, FillInfo(order->order_id(), price, signedQuantity));
+        return false;
+    }
+    order->set_state(ORDER_STATE_FILLED);
+    m_working.erase(order->order_id());
+    m_orders.RemoveWorking(order);
+    Queue(order, ORDER_UPDATE_TYPE_FILL, FillInfo(order->order_id(), price, signedQuantity));
+    return true;
+}
+
+void SimExchange::Complete(Order* order, OrderState state, OrderUpdateType updateType)
+{
+    order->set_state(state);
+    m_working.erase(order->order_id());
+    m_orders.RemoveWorking(order);
+    Queue(order, updateType, FillInfo());
+}
+
+void SimExchange::RemoveResting(Order* order)
+{
+    RestingMap::iterator it = m_resting.find(order->instrument());
+    if (it == m_resting.end())
+        return;
+
+    RestingOrders& resting = it->second;
+    RestingOrders::iterator pos = std::find(resting.begin(), resting.end(), order);
+    if (pos != resting.end()) {
+        *pos = resting.back();
+        resting.pop_back();
+    }
+}
+
+void SimExchange::Queue(Order* order, OrderUpdateType type, const FillInfo& fill)
+{
+    PendingUpdate update;
+    update.order = order;
+    update.type = type;
+    update.fill = fill;
+    m_updates.push_back(update);
+}
+
+} // namespace Replay
@@ -0,0 +1,106 @@
+#pragma once
+
+#ifndef _STRATEGY_STUDIO_REPLAY_SIM_EXCHANGE_H_
+#define _STRATEGY_STUDIO_REPLAY_SIM_EXCHANGE_H_
+
+#include <Strategy.h>
+
+#include <boost/unordered_map.hpp>
+
+#include <deque>
+#include <vector>
+
+namespace Replay {
+
+using namespace RCM::StrategyStudio;
+
+/**
+ * Minimal matching simulator standing in for the server's trade actions.
+ *
+ * Market orders fill in full at the touch on arrival. Limit orders fill in full at the touch as soon as they are
+ * marketable against the top quote, or at their limit when a trade prints through them. Order updates are queued
+ * and handed to the strategy by the host after the current callback returns, as the server would.
+ *
+ * With faults set, the exchange also produces the answers a live venue gives that the happy path never does:
+ * every nth cancel-replace or cancel is refused with a REPLACE_REJECT or CANCEL_REJECT that leaves the order
+ * working as it was, and limit orders fill half their open quantity per match, so they go through partial fills.
+ */
+class SimExchange : public ITradeActions {
+public:
+    struct PendingUpdate {
+        Order* order;
+        OrderUpdateType type;
+        FillInfo fill;
+    };
+
+    struct Counters {
+        Counters(): newOrders(0), cancels(0), replaces(0), fills(0), rejects(0) {}
+
+        unsigned long long messages() const { return newOrders + cancels + replaces; }
+
+        unsigned long long newOrders;
+        unsigned long long cancels;
+        unsigned long long replaces;
+        unsigned long long fills;
+        unsigned long long rejects;
+    };
+
+    struct Faults {
+        Faults(): rejectReplaceEvery(0), rejectCancelEvery(0), partialFills(false) {}
+
+        unsigned rejectReplaceEvery;    // refuse every nth cancel-replace; 0 never
+        unsigned rejectCancelEvery;     // refuse every nth cancel; 0 never
+        bool partialFills;              // limit orders fill half their open quantity, at least one, per match
+    };
+
+public:
+    SimExchange(IOrderTracker& orders, PortfolioTracker& portfolio);
+
+    void set_faults(const Faults& faults) { m_faults = faults; }
+
+    TradeActionResult SendNewOrder(OrderParams& params);
+    TradeActionResult SendCancelOrder(OrderID orderID);
+    TradeActionResult SendCancelReplaceOrder(OrderID orderID, const OrderParams& params);
+    TradeActionResult SendCancelAll();
+
+    /**
+     * Re-checks resting orders on the instrument after its top quote changed
+     */
+    void OnQuote(const Instrument* instrument);
+
+    /**
+     * Fills resting orders the trade printed through
+     */
+    void OnTrade(const Instrument* instrument, double price);
+
+    bool PopUpdate(PendingUpdate* update);
+    bool has_updates() const { return !m_updates.empty(); }
+
+    const Counters& counters() const { return m_counters; }
+
+private:
+    typedef std::vector<Order*> RestingOrders;
+    typedef boost::unordered_map<const Instrument*, RestingOrders> RestingMap;
+
+    Order* FindWorking(OrderID orderID);
+    bool TryFillAtTouch(Order* order);
+    bool Fill(Order* order, double price);
+    void Complete(Order* order, OrderState state, OrderUpdateType updateType);
+    void RemoveResting(Order* order);
+    void Queue(Order* order, OrderUpdateType type, const FillInfo& fill);
+
+private:
+    IOrderTracker& m_orders;
+    PortfolioTracker& m_portfolio;
+    std::deque<Order> m_allOrders;
+    boost::unordered_map<OrderID, Order*> m_working;
+    RestingMap m_resting;
+    std::deque<PendingUpdate> m_updates;
+    OrderID m_nextOrderID;
+    Faults m_faults;
+    Counters m_counters;
+};
+
+} // namespace Replay
+
+#endif
@@ -0,0 +1,228 @@
+/**
+ * strategy_sweep: replays one day through many parameter sets of a strategy at once, one instance per set.
+ *
+ * Every configuration gets its own strategy instance, ReplayHost and simulated exchange over the same read-only
+ * events, and the configurations are spread over the cores by a work-stealing scheduler.
+ *
+ *   g++ -O2 -fPIC -shared -pthread -Ireplay/sdk leverage_arbitrage/lev_arb.cpp -o libLevArb.so
+ *   g++ -O2 -pthread -Ireplay/sdk replay/SweepMain.cpp replay/ReplayHost.cpp replay/SimExchange.cpp replay/TickFile.cpp \
+ *       replay/TickArchive.cpp replay/PackedTicks.cpp replay/EventLog.cpp replay/AllocationCounter.cpp -o strategy_sweep -ldl
+ *
+ * Usage:
+ *
+ *   strategy_sweep --strategy <lib.so> --ticks <file> [--type <type>] [--symbols A,B,...] [--day <yyyymmdd>]
+ *                  [--param <name>=<value>]... [--sweep <name>=<v1>,<v2>,...]... [--threads <n>]
+ *
+ * --param fixes a value for every configuration; --sweep adds a grid axis, and the configurations are every
+ * combination of the swept values. Journals are off unless journal_path is set with --param. Prints one row per
+ * configuration with its order counts and PnL, in grid order.
+ */
+
+#include "ReplayHost.h"
+#include "TickSource.h"
+#include "WorkStealingScheduler.h"
+
+#include <stdlib.h>
+#include <time.h>
+
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Replay;
+
+namespace {
+
+struct SweepAxis {
+    std::string name;
+    std::vector<std::string> values;
+};
+
+struct SweepResult {
+    SweepResult(): ok(false), pnl(0), seconds(0) {}
+
+    bool ok;
+    std::string error;
+    SimExchange::Counters counters;
+    double pnl;
+    double seconds;
+};
+
+void Usage()
+{
+    std::cerr << "usage: strategy_sweep --strategy <lib.so> --ticks <file> [--type <type>] [--symbols A,B,...] [--day <yyyymmdd>]\n"
+                 "                      [--param <name>=<value>]... [--sweep <name>=<v1>,<v2>,...]... [--threads <n>]\n";
+    exit(2);
+}
+
+double WallSeconds()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+std::vector<std::string> Split(const std::string& list)
+{
+    std::vector<std::string> items;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ','))
+        if (!item.empty())
+            items.push_back(item);
+    return items;
+}
+
+bool SplitAssignment(const std::string& kv, std::string* name, std::string* value)
+{
+    size_t eq = kv.find('=');
+    if (eq == std::string::npos || eq == 0)
+        return false;
+    *name = kv.substr(0, eq);
+    *value = kv.substr(eq + 1);
+    return true;
+}
+
+/**
+ * The swept values of configuration `index`, the last axis varying fastest
+ */
+std::vector<std::pair<std::string, std::string> > Configuration(const std::vector<SweepAxis>& axes, size_t index)
+{
+    std::vector<std::pair<std::string, std::string> > values(axes.size());
+    for (size_t a = axes.size(); a-- > 0;) {
+        values[a] = std::make_pair(axes[a].name, axes[a].values[index % axes[a].values.size()]);
+        index /= axes[a].values.size();
+    }
+    return values;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::string libraryPath;
+    std::string ticksPath;
+    std::string type;
+    int day = 0;
+    int threads = static_cast<int>(std::thread::hardware_concurrency());
+    ReplayOptions base;
+    std::vector<SweepAxis> axes;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        std::string name, value;
+        if (arg == "--strategy" && hasValue) {
+            libraryPath = argv[++i];
+        } else if (arg == "--ticks" && hasValue) {
+            ticksPath = argv[++i];
+        } else if (arg == "--type" && hasValue) {
+            type = argv[++i];
+        } else if (arg == "--symbols" && hasValue) {
+            base.symbols = Split(argv[++i]);
+        } else if (arg == "--day" && hasValue) {
+            day = atoi(argv[++i]);
+        } else if (arg == "--threads" && hasValue) {
+            threads = atoi(argv[++i]);
+        } else if (arg == "--param" && hasValue) {
+            if (!SplitAssignment(argv[++i], &name, &value))
+                Usage();
+            base.params.push_back(std::make_pair(name, value));
+        } else if (arg == "--sweep" && hasValue) {
+            if (!SplitAssignment(argv[++i], &name, &value))
+                Usage();
+            SweepAxis axis;
+            axis.name = name;
+            axis.values = Split(value);
+            if (axis.values.empty())
+                Usage();
+            axes.push_back(axis);
+        } else {
+            Usage();
+        }
+    }
+    if (libraryPath.empty() || ticksPath.empty())
+        Usage();
+    if (threads < 1)
+        threads = 1;
+
+    try {
+        StrategyLibrary library(libraryPath);
+        if (type.empty())
+            type = library.type();
+
+        TickSource source(ticksPath, day);
+        if (source.size() != 0)
+            base.date = TimeFromNanos(source.first_timestamp()).date();
+        base.timing = false;
+
+        size_t numConfigs = 1;
+        for (size_t a = 0; a < axes.size(); ++a)
+            numConfigs *= axes[a].values.size();
+
+        std::vector<SweepResult> results(numConfigs);
+        WorkStealingScheduler scheduler(threads);
+
+        double start = WallSeconds();
+        scheduler.Run(numConfigs, [&](size_t job, int) {
+            SweepResult& result = results[job];
+            std::ostringstream log;     // strategies' client logging is dropped; each instance gets its own sink
+            ReplayOptions options = base;
+            options.log = &log;
+            std::vector<std::pair<std::string, std::string> > swept = Configuration(axes, job);
+            options.params.insert(options.params.end(), swept.begin(), swept.end());
+
+            double runStart = WallSeconds();
+            try {
+                ReplayHost host(library.Create(type, static_cast<StrategyID>(job + 1), type, "sweep"), source.symbols(), options);
+                source.ForEachBatch([&](const TickRecord* begin, const TickRecord* end) { host.Run(begin, end); });
+                host.Finish();
+                result.counters = host.exchange().counters();
+                result.pnl = host.strategy().portfolio().total_pnl();
+                result.ok = true;
+            } catch (const std::exception& e) {
+                result.error = e.what();
+            }
+            result.seconds = WallSeconds() - runStart;
+        });
+        double elapsed = WallSeconds() - start;
+
+        std::cout << std::setw(6) << "config";
+        for (size_t a = 0; a < axes.size(); ++a)
+            std::cout << std::setw(std::max<size_t>(12, axes[a].name.size() + 2)) << axes[a].name;
+        std::cout << std::setw(10) << "new" << std::setw(10) << "cancel" << std::setw(10) << "replace"
+                  << std::setw(10) << "fills" << std::setw(10) << "rejects" << std::setw(14) << "pnl" << "\n";
+
+        double busySeconds = 0;
+        for (size_t i = 0; i < numConfigs; ++i) {
+            const SweepResult& r = results[i];
+            std::vector<std::pair<std::string, std::string> > swept = Configuration(axes, i);
+            std::cout << std::setw(6) << i;
+            for (size_t a = 0; a < axes.size(); ++a)
+                std::cout << std::setw(std::max<size_t>(12, axes[a].name.size() + 2)) << swept[a].second;
+            if (r.ok) {
+                std::cout << std::setw(10) << r.counters.newOrders << std::setw(10) << r.counters.cancels
+                          << std::setw(10) << r.counters.replaces << std::setw(10) << r.counters.fills
+                          << std::setw(10) << r.counters.rejects
+                          << std::setw(14) << std::fixed << std::setprecision(2) << r.pnl << "\n";
+            } else {
+                std::cout << "  failed: " << r.error << "\n";
+            }
+            busySeconds += r.seconds;
+        }
+
+        std::cout << "\n" << numConfigs << " configurations x " << source.size() << " events on "
+                  << scheduler.num_workers() << " threads in " << std::setprecision(3) << elapsed << " s ("
+                  << std::setprecision(0) << (elapsed > 0 ? numConfigs * source.size() / elapsed : 0.0)
+                  << " events/s, " << std::setprecision(1) << (elapsed > 0 ? busySeconds / elapsed : 0.0)
+                  << "x busy/wall)\n";
+    } catch (const std::exception& e) {
+        std::cerr << "strategy_sweep: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
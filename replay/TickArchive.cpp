@@ -0,0 +1,170 @@
+#include "TickArchive.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <stdexcept>
+
+namespace Replay {
+
+namespace {
+
+uint64_t AlignUp(uint64_t offset)
+{
+    return (offset + 63) & ~static_cast<uint64_t>(63);
+}
+
+int32_t UtcDate(int64_t timestampNanos)
+{
+    time_t seconds = static_cast<time_t>(timestampNanos / 1000000000LL);
+    tm parts;
+    gmtime_r(&seconds, &parts);
+    return (parts.tm_year + 1900) * 10000 + (parts.tm_mon + 1) * 100 + parts.tm_mday;
+}
+
+void WritePadding(std::ofstream& out, uint64_t offset)
+{
+    static const char zeros[64] = {0};
+    uint64_t pos = static_cast<uint64_t>(out.tellp());
+    out.write(zeros, offset - pos);
+}
+
+void ThrowArchiveError(const std::string& path, const std::string& what)
+{
+    throw std::runtime_error(path + ": " + what);
+}
+
+} // namespace
+
+void WriteTickArchive(const std::string& path, const TickStream& stream)
+{
+    std::vector<TickArchiveDay> days;
+    for (size_t i = 0; i < stream.records.size(); ++i) {
+        int32_t date = UtcDate(stream.records[i].timestamp);
+        if (days.empty() || days.back().date != date) {
+            TickArchiveDay day = TickArchiveDay();
+            day.date = date;
+            day.first_record = i;
+            days.push_back(day);
+        }
+        ++days.back().num_records;
+    }
+
+    TickArchiveHeader header = TickArchiveHeader();
+    memcpy(header.magic, TICK_ARCHIVE_MAGIC, sizeof(header.magic));
+    header.version = TICK_ARCHIVE_VERSION;
+    header.record_size = sizeof(TickRecord);
+    header.num_symbols = static_cast<uint32_t>(stream.symbols.size());
+    header.num_days = static_cast<uint32_t>(days.size());
+    header.num_records = stream.records.size();
+    header.symbols_offset = AlignUp(sizeof(header));
+    header.days_offset = AlignUp(header.symbols_offset + header.num_symbols * TICK_ARCHIVE_SYMBOL_LEN);
+    header.records_offset = AlignUp(header.days_offset + header.num_days * sizeof(TickArchiveDay));
+
+    std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+    if (!out)
+        ThrowArchiveError(path, "cannot create archive");
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    WritePadding(out, header.symbols_offset);
+    for (size_t i = 0; i < stream.symbols.size(); ++i) {
+        char entry[TICK_ARCHIVE_SYMBOL_LEN] = {0};
+        if (stream.symbols[i].size() >= TICK_ARCHIVE_SYMBOL_LEN)
+            ThrowArchiveError(path, "symbol too long for the dictionary: " + stream.symbols[i]);
+        memcpy(entry, stream.symbols[i].data(), stream.symbols[i].size());
+        out.write(entry, sizeof(entry));
+    }
+    WritePadding(out, header.days_offset);
+    if (!days.empty())
+        out.write(reinterpret_cast<const char*>(&days[0]), days.size() * sizeof(TickArchiveDay));
+    WritePadding(out, header.records_offset);
+    if (!stream.records.empty())
+        out.write(reinterpret_cast<const char*>(stream.records.data()), stream.records.size() * sizeof(TickRecord));
+
+    out.close();
+    if (!out)
+        ThrowArchiveError(path, "write failed");
+}
+
+bool IsTickArchive(const std::string& path)
+{
+    std::ifstream in(path.c_str(), std::ios::binary);
+    char magic[sizeof(TICK_ARCHIVE_MAGIC)];
+    return in.read(magic, sizeof(magic)) && memcmp(magic, TICK_ARCHIVE_MAGIC, sizeof(magic)) == 0;
+}
+
+TickArchive::TickArchive(const std::string& path):
+    m_base(MAP_FAILED),
+    m_length(0),
+    m_header(NULL),
+    m_days(NULL),
+    m_records(NULL)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        ThrowArchiveError(path, "cannot open archive");
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(TickArchiveHeader)) {
+        close(fd);
+        ThrowArchiveError(path, "not a tick archive");
+    }
+    m_length = st.st_size;
+    m_base = mmap(NULL, m_length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (m_base == MAP_FAILED)
+        ThrowArchiveError(path, "mmap failed");
+
+    // replay reads front to back once; let the kernel read ahead aggressively
+    madvise(m_base, m_length, MADV_SEQUENTIAL | MADV_WILLNEED);
+
+    const char* base = static_cast<const char*>(m_base);
+    m_header = reinterpret_cast<const TickArchiveHeader*>(base);
+    const char* error = NULL;
+    if (memcmp(m_header->magic, TICK_ARCHIVE_MAGIC, sizeof(m_header->magic)) != 0)
+        error = "not a tick archive";
+    else if (m_header->version != TICK_ARCHIVE_VERSION || m_header->record_size != sizeof(TickRecord))
+        error = "archive version or record layout does not match this build";
+    else if (m_header->symbols_offset + m_header->num_symbols * TICK_ARCHIVE_SYMBOL_LEN > m_length
+             || m_header->days_offset + m_header->num_days * sizeof(TickArchiveDay) > m_length
+             || m_header->records_offset + m_header->num_records * sizeof(TickRecord) > m_length
+             || m_header->records_offset % 8 != 0 || m_header->days_offset % 8 != 0)
+        error = "archive is truncated or corrupt";
+    if (error != NULL) {
+        munmap(m_base, m_length);
+        m_base = MAP_FAILED;
+        ThrowArchiveError(path, error);
+    }
+
+    m_days = reinterpret_cast<const TickArchiveDay*>(base + m_header->days_offset);
+    m_records = reinterpret_cast<const TickRecord*>(base + m_header->records_offset);
+
+    const char* symbols = base + m_header->symbols_offset;
+    m_symbols.reserve(m_header->num_symbols);
+    for (uint32_t i = 0; i < m_header->num_symbols; ++i) {
+        const char* entry = symbols + i * TICK_ARCHIVE_SYMBOL_LEN;
+        m_symbols.push_back(std::string(entry, strnlen(entry, TICK_ARCHIVE_SYMBOL_LEN)));
+    }
+}
+
+TickArchive::~TickArchive()
+{
+    if (m_base != MAP_FAILED)
+        munmap(m_base, m_length);
+}
+
+int TickArchive::FindDay(int32_t date) const
+{
+    for (size_t i = 0; i < num_days(); ++i) {
+        if (m_days[i].date == date)
+            return static_cast<int>(i);
+    }
+    return -1;
+}
+
+} // namespace Replay
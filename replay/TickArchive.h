@@ -0,0 +1,106 @@
+#pragma once
+
+#ifndef _STRATEGY_STUDIO_REPLAY_TICK_ARCHIVE_H_
+#define _STRATEGY_STUDIO_REPLAY_TICK_ARCHIVE_H_
+
+#include "TickRecord.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+namespace Replay {
+
+/**
+ * Binary tick archive layout. Everything is little-endian and every section starts on a 64 byte boundary:
+ *
+ *   TickArchiveHeader
+ *   symbol dictionary   num_symbols x char[TICK_ARCHIVE_SYMBOL_LEN], NUL padded; records index into it
+ *   day index           num_days x TickArchiveDay, in time order
+ *   records             num_records x TickRecord, in time order
+ *
+ * The records are TickRecords byte for byte, so a mapped archive replays without decoding.
+ */
+const char TICK_ARCHIVE_MAGIC[8] = {'S', 'S', 'T', 'I', 'C', 'K', 'S', '1'};
+const uint32_t TICK_ARCHIVE_VERSION = 1;
+const size_t TICK_ARCHIVE_SYMBOL_LEN = 32;
+
+struct TickArchiveHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;       // sizeof(TickRecord) of the writer
+    uint32_t num_symbols;
+    uint32_t num_days;
+    uint64_t num_records;
+    uint64_t symbols_offset;
+    uint64_t days_offset;
+    uint64_t records_offset;
+    uint64_t reserved;
+};
+
+struct TickArchiveDay {
+    int32_t date;               // yyyymmdd, UTC
+    uint32_t reserved;
+    uint64_t first_record;
+    uint64_t num_records;
+};
+
+static_assert(sizeof(TickArchiveHeader) == 64, "archive header layout changed");
+static_assert(sizeof(TickArchiveDay) == 24, "archive day layout changed");
+static_assert(sizeof(TickRecord) == 56, "tick record layout changed; bump TICK_ARCHIVE_VERSION");
+
+/**
+ * Writes an in-memory stream as an archive, splitting the day index on UTC dates. Throws std::runtime_error
+ * on I/O failure or when a symbol does not fit the dictionary.
+ */
+void WriteTickArchive(const std::string& path, const TickStream& stream);
+
+/**
+ * True if the file starts with the archive magic
+ */
+bool IsTickArchive(const std::string& path);
+
+/**
+ * A read-only mapping of an archive. Records are served straight from the mapping.
+ */
+class TickArchive {
+public:
+    /**
+     * Maps the file and validates the header and section bounds; throws std::runtime_error if it is not a
+     * readable archive for this build
+     */
+    explicit TickArchive(const std::string& path);
+    ~TickArchive();
+
+    const std::vector<std::string>& symbols() const { return m_symbols; }
+
+    size_t num_days() const { return m_header->num_days; }
+    const TickArchiveDay& day(size_t i) const { return m_days[i]; }
+
+    /**
+     * Index of the day with the given yyyymmdd date, or -1
+     */
+    int FindDay(int32_t date) const;
+
+    const TickRecord* begin() const { return m_records; }
+    const TickRecord* end() const { return m_records + m_header->num_records; }
+    const TickRecord* day_begin(size_t i) const { return m_records + m_days[i].first_record; }
+    const TickRecord* day_end(size_t i) const { return day_begin(i) + m_days[i].num_records; }
+
+private:
+    TickArchive(const TickArchive&);
+    TickArchive& operator=(const TickArchive&);
+
+    void* m_base;
+    size_t m_length;
+    const TickArchiveHeader* m_header;
+    const TickArchiveDay* m_days;
+    const TickRecord* m_records;
+    std::vector<std::string> m_symbols;
+};
+
+} // namespace Replay
+
+#endif
@@ -0,0 +1,86 @@
+/**
+ * tick_convert: converts a text tick file (see TickFile.h) into a binary tick archive (see TickArchive.h), or with
+ * --packed into a packed archive (see PackedTicks.h).
+ *
+ *   g++ -O2 -Ireplay/sdk replay/TickConvert.cpp replay/TickFile.cpp replay/TickArchive.cpp replay/PackedTicks.cpp \
+ *       -o tick_convert
+ *
+ * Usage:
+ *
+ *   tick_convert [--packed] <ticks.csv|ticks.bin> <ticks.bin>
+ *
+ * The input may also be either kind of archive, so existing archives can be repacked. The output is read back and
+ * compared record for record with the input before the tool reports success.
+ */
+
+#include "PackedTicks.h"
+#include "TickArchive.h"
+#include "TickFile.h"
+#include "TickSource.h"
+
+#include <string.h>
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace Replay;
+
+namespace {
+
+void LoadStream(const std::string& path, TickStream* stream)
+{
+    TickSource source(path, 0);
+    stream->symbols = source.symbols();
+    stream->records.clear();
+    stream->records.reserve(source.size());
+    source.ForEachBatch([&](const TickRecord* begin, const TickRecord* end) {
+        stream->records.insert(stream->records.end(), begin, end);
+    });
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    bool packed = (argc == 4 && std::string(argv[1]) == "--packed");
+    if (argc != (packed ? 4 : 3)) {
+        std::cerr << "usage: tick_convert [--packed] <ticks.csv|ticks.bin> <ticks.bin>\n";
+        return 2;
+    }
+    std::string inPath = argv[argc - 2];
+    std::string outPath = argv[argc - 1];
+
+    try {
+        TickStream stream;
+        LoadStream(inPath, &stream);
+        if (packed)
+            WritePackedTicks(outPath, stream);
+        else
+            WriteTickArchive(outPath, stream);
+
+        TickStream check;
+        LoadStream(outPath, &check);
+        if (check.symbols != stream.symbols || check.records.size() != stream.records.size()
+            || (!check.records.empty()
+                && memcmp(&check.records[0], &stream.records[0], check.records.size() * sizeof(TickRecord)) != 0))
+            throw std::runtime_error(outPath + ": read back differs from the input");
+
+        std::cout << "wrote " << stream.records.size() << " events for " << stream.symbols.size() << " symbols to "
+                  << outPath << "\n";
+        if (packed) {
+            PackedTicks out(outPath);
+            for (size_t i = 0; i < out.num_days(); ++i)
+                std::cout << "  " << out.day(i).date << "  " << out.day(i).num_records << " events in "
+                          << out.day(i).num_blocks << " blocks\n";
+        } else {
+            TickArchive out(outPath);
+            for (size_t i = 0; i < out.num_days(); ++i)
+                std::cout << "  " << out.day(i).date << "  " << out.day(i).num_records << " events\n";
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "tick_convert: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
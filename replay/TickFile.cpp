@@ -0,0 +1,151 @@
+#include "TickFile.h"
+
+#include <boost/unordered_map.hpp>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace Replay {
+
+namespace {
+
+void ThrowParseError(const std::string& path, size_t lineNo, const std::string& what)
+{
+    std::ostringstream ss;
+    ss << path << ":" << lineNo << ": " << what;
+    throw std::runtime_error(ss.str());
+}
+
+void SplitFields(const std::string& line, std::vector<std::string>* fields)
+{
+    fields->clear();
+    size_t start = 0;
+    for (;;) {
+        size_t comma = line.find(',', start);
+        fields->push_back(line.substr(start, comma - start));
+        if (comma == std::string::npos)
+            break;
+        start = comma + 1;
+    }
+}
+
+bool ParseDouble(const std::string& text, double* value)
+{
+    char* end = NULL;
+    *value = strtod(text.c_str(), &end);
+    return end != text.c_str() && *end == '\0';
+}
+
+bool ParseInt(const std::string& text, long long* value)
+{
+    char* end = NULL;
+    *value = strtoll(text.c_str(), &end, 10);
+    return end != text.c_str() && *end == '\0';
+}
+
+} // namespace
+
+void LoadTickFile(const std::string& path, TickStream* stream)
+{
+    std::ifstream in(path.c_str());
+    if (!in)
+        throw std::runtime_error("cannot open tick file " + path);
+
+    // symbol lookups by name are only needed while loading
+    boost::unordered_map<std::string, uint32_t> symbolIndex;
+    for (size_t i = 0; i < stream->symbols.size(); ++i)
+        symbolIndex[stream->symbols[i]] = static_cast<uint32_t>(i);
+
+    std::string lastSymbol;
+    uint32_t lastIndex = 0;
+
+    std::string line;
+    std::vector<std::string> fields;
+    size_t lineNo = 0;
+    int64_t lastTime = 0;
+
+    while (std::getline(in, line)) {
+        ++lineNo;
+        if (!line.empty() && line[line.size() - 1] == '\r')
+            line.erase(line.size() - 1);
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        SplitFields(line, &fields);
+        if (fields.size() < 3 || fields[0].size() != 1)
+            ThrowParseError(path, lineNo, "expected <type>,<time_ns>,<symbol>,...");
+
+        TickRecord rec;
+        memset(&rec, 0, sizeof(rec));
+        rec.type = static_cast<uint8_t>(fields[0][0]);
+
+        long long ts = 0;
+        if (!ParseInt(fields[1], &ts))
+            ThrowParseError(path, lineNo, "bad timestamp");
+        if (ts < lastTime)
+            ThrowParseError(path, lineNo, "timestamp goes backwards");
+        rec.timestamp = lastTime = ts;
+
+        if (lastSymbol.empty() || fields[2] != lastSymbol) {
+            boost::unordered_map<std::string, uint32_t>::iterator it = symbolIndex.find(fields[2]);
+            if (it == symbolIndex.end()) {
+                it = symbolIndex.insert(std::make_pair(fields[2], static_cast<uint32_t>(stream->symbols.size()))).first;
+                stream->symbols.push_back(fields[2]);
+            }
+            lastIndex = it->second;
+            lastSymbol = fields[2];
+        }
+        rec.instrument = lastIndex;
+
+        size_t expected = 0;
+        switch (rec.type) {
+            case TICK_TYPE_TRADE: expected = 5; break;
+            case TICK_TYPE_QUOTE: expected = 7; break;
+            case TICK_TYPE_DEPTH: expected = 8; break;
+            case TICK_TYPE_BAR: expected = 8; break;
+            default: ThrowParseError(path, lineNo, "unknown record type " + fields[0]);
+        }
+        if (fields.size() != expected)
+            ThrowParseError(path, lineNo, "wrong number of fields");
+
+        long long n0 = 0, n1 = 0;
+        bool ok = true;
+        switch (rec.type) {
+            case TICK_TYPE_TRADE:
+                ok = ParseDouble(fields[3], &rec.price[0]) && ParseInt(fields[4], &n0);
+                break;
+            case TICK_TYPE_QUOTE:
+                ok = ParseDouble(fields[3], &rec.price[0]) && ParseInt(fields[4], &n0) &&
+                     ParseDouble(fields[5], &rec.price[1]) && ParseInt(fields[6], &n1);
+                break;
+            case TICK_TYPE_DEPTH: {
+                long long level = 0;
+                ok = (fields[3] == "B" || fields[3] == "A") &&
+                     (fields[4] == "I" || fields[4] == "U" || fields[4] == "D") &&
+                     ParseInt(fields[5], &level) && level >= 0 && level <= 255 &&
+                     ParseDouble(fields[6], &rec.price[0]) && ParseInt(fields[7], &n0);
+                rec.side = static_cast<uint8_t>(fields[3][0]);
+                rec.action = static_cast<uint8_t>(fields[4][0]);
+                rec.level = static_cast<uint8_t>(level);
+                break;
+            }
+            case TICK_TYPE_BAR:
+                ok = ParseDouble(fields[3], &rec.price[0]) && ParseDouble(fields[4], &rec.price[1]) &&
+                     ParseDouble(fields[5], &rec.price[2]) && ParseDouble(fields[6], &rec.price[3]) &&
+                     ParseInt(fields[7], &n0);
+                break;
+        }
+        if (!ok || n0 < 0 || n1 < 0)
+            ThrowParseError(path, lineNo, "bad field value");
+
+        rec.size[0] = static_cast<uint32_t>(n0);
+        rec.size[1] = static_cast<uint32_t>(n1);
+        stream->records.push_back(rec);
+    }
+}
+
+} // namespace Replay
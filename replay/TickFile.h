@@ -0,0 +1,27 @@
+#pragma once
+
+#ifndef _STRATEGY_STUDIO_REPLAY_TICK_FILE_H_
+#define _STRATEGY_STUDIO_REPLAY_TICK_FILE_H_
+
+#include "TickRecord.h"
+
+#include <string>
+
+namespace Replay {
+
+/**
+ * Loads a text tick file into memory. One event per line, '#' starts a comment:
+ *
+ *   T,<time_ns>,<symbol>,<price>,<size>
+ *   Q,<time_ns>,<symbol>,<bid>,<bid_size>,<ask>,<ask_size>
+ *   D,<time_ns>,<symbol>,<B|A>,<I|U|D>,<level>,<price>,<size>
+ *   B,<time_ns>,<symbol>,<open>,<high>,<low>,<close>,<volume>
+ *
+ * Depth actions insert, update or delete the level, with inserts and deletes shifting the deeper levels.
+ * Events must be in time order. Throws std::runtime_error naming the line on malformed input.
+ */
+void LoadTickFile(const std::string& path, TickStream* stream);
+
+} // namespace Replay
+
+#endif
@@ -0,0 +1,61 @@
+#pragma once
+
+#ifndef _STRATEGY_STUDIO_REPLAY_TICK_RECORD_H_
+#define _STRATEGY_STUDIO_REPLAY_TICK_RECORD_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+namespace Replay {
+
+enum TickType {
+    TICK_TYPE_TRADE = 'T',
+    TICK_TYPE_QUOTE = 'Q',
+    TICK_TYPE_DEPTH = 'D',
+    TICK_TYPE_BAR = 'B'
+};
+
+enum TickDepthAction {
+    TICK_DEPTH_INSERT = 'I',
+    TICK_DEPTH_UPDATE = 'U',
+    TICK_DEPTH_DELETE = 'D'
+};
+
+enum TickSide {
+    TICK_SIDE_NONE = 0,
+    TICK_SIDE_BID = 'B',
+    TICK_SIDE_ASK = 'A'
+};
+
+/**
+ * One recorded market data event. Fixed width so that a day can be held (or mapped) as a flat array.
+ *
+ *   trade:  price[0] = price, size[0] = size
+ *   quote:  price[0] = bid, price[1] = ask, size[0] = bid size, size[1] = ask size
+ *   depth:  side, action, level, price[0] = price, size[0] = size
+ *   bar:    price[0..3] = open, high, low, close, size[0] = volume
+ */
+struct TickRecord {
+    int64_t timestamp;      // nanoseconds since the unix epoch
+    uint32_t instrument;    // index into the stream's symbol dictionary
+    uint8_t type;
+    uint8_t side;
+    uint8_t action;
+    uint8_t level;
+    double price[4];
+    uint32_t size[2];
+};
+
+/**
+ * An in-memory day of events plus the symbol dictionary its records index into
+ */
+struct TickStream {
+    std::vector<std::string> symbols;
+    std::vector<TickRecord> records;
+};
+
+} // namespace Replay
+
+#endif
@@ -0,0 +1,127 @@
+#pragma once
+
+#ifndef _STRATEGY_STUDIO_REPLAY_TICK_SOURCE_H_
+#define _STRATEGY_STUDIO_REPLAY_TICK_SOURCE_H_
+
+#include "PackedTicks.h"
+#include "TickArchive.h"
+#include "TickFile.h"
+
+#include <stdint.h>
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Replay {
+
+/**
+ * The events a replay runs over: a text tick file parsed into memory, a binary archive mapped in place, or a
+ * packed archive mapped and decoded a block at a time, the archives optionally narrowed to one day of their
+ * index. The source is read-only and may be shared by any number of concurrent ReplayHosts; each pass over a
+ * packed source decodes with its own buffer.
+ */
+class TickSource {
+public:
+    /**
+     * day is a yyyymmdd date to select from an archive, or 0 for everything
+     */
+    TickSource(const std::string& path, int32_t day):
+        m_begin(NULL),
+        m_end(NULL),
+        m_firstBlock(0),
+        m_endBlock(0),
+        m_size(0),
+        m_firstTimestamp(0)
+    {
+        if (IsPackedTicks(path)) {
+            m_packed.reset(new PackedTicks(path));
+            m_endBlock = m_packed->num_blocks();
+            m_size = m_packed->num_records();
+            if (day != 0) {
+                int index = m_packed->FindDay(day);
+                if (index < 0)
+                    throw std::runtime_error("archive has no day " + std::to_string(day));
+                m_firstBlock = m_packed->day(index).first_block;
+                m_endBlock = m_firstBlock + m_packed->day(index).num_blocks;
+                m_size = m_packed->day(index).num_records;
+            }
+            if (m_firstBlock < m_endBlock)
+                m_firstTimestamp = m_packed->block(m_firstBlock).first_timestamp;
+            return;
+        }
+
+        if (IsTickArchive(path)) {
+            m_archive.reset(new TickArchive(path));
+            m_begin = m_archive->begin();
+            m_end = m_archive->end();
+            if (day != 0) {
+                int index = m_archive->FindDay(day);
+                if (index < 0)
+                    throw std::runtime_error("archive has no day " + std::to_string(day));
+                m_begin = m_archive->day_begin(index);
+                m_end = m_archive->day_end(index);
+            }
+        } else {
+            if (day != 0)
+                throw std::runtime_error("selecting a day needs a binary archive");
+            LoadTickFile(path, &m_stream);
+            m_begin = m_stream.records.data();
+            m_end = m_begin + m_stream.records.size();
+        }
+        m_size = m_end - m_begin;
+        if (m_size != 0)
+            m_firstTimestamp = m_begin->timestamp;
+    }
+
+    const std::vector<std::string>& symbols() const
+    {
+        if (m_packed)
+            return m_packed->symbols();
+        return m_archive ? m_archive->symbols() : m_stream.symbols;
+    }
+
+    size_t size() const { return m_size; }
+
+    /**
+     * Timestamp of the first event, 0 if there are none
+     */
+    int64_t first_timestamp() const { return m_firstTimestamp; }
+
+    /**
+     * Calls f(begin, end) over consecutive runs of records that together are every event in order: the whole
+     * range at once for text and flat archives, one decoded block at a time for packed archives
+     */
+    template <typename F>
+    void ForEachBatch(F f) const
+    {
+        if (!m_packed) {
+            if (m_begin != m_end)
+                f(m_begin, m_end);
+            return;
+        }
+        PackedTickDecoder decoder(*m_packed, m_firstBlock, m_endBlock);
+        std::vector<TickRecord> batch(PACKED_TICKS_BLOCK_RECORDS);
+        for (size_t n = decoder.Next(&batch[0]); n != 0; n = decoder.Next(&batch[0]))
+            f(&batch[0], &batch[0] + n);
+    }
+
+private:
+    TickSource(const TickSource&);
+    TickSource& operator=(const TickSource&);
+
+    TickStream m_stream;
+    std::unique_ptr<TickArchive> m_archive;
+    std::unique_ptr<PackedTicks> m_packed;
+    const TickRecord* m_begin;
+    const TickRecord* m_end;
+    size_t m_firstBlock;
+    size_t m_endBlock;
+    size_t m_size;
+    int64_t m_firstTimestamp;
+};
+
+} // namespace Replay
+
+#endif
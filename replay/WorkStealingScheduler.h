@@ -0,0 +1,103 @@
+#pragma once
+
+#ifndef _STRATEGY_STUDIO_REPLAY_WORK_STEALING_SCHEDULER_H_
+#define _STRATEGY_STUDIO_REPLAY_WORK_STEALING_SCHEDULER_H_
+
+#include <stddef.h>
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Replay {
+
+/**
+ * Runs jobs 0..n-1 on a fixed set of worker threads.
+ *
+ * Each worker starts with a contiguous block of the jobs in its own deque and takes work from the back of it.
+ * A worker that runs dry steals from the front of the other workers' deques, so a few slow configurations
+ * don't leave the rest of the machine idle at the end of a sweep. Jobs are whole replays, so a mutex per deque
+ * costs nothing measurable next to the work it hands out.
+ */
+class WorkStealingScheduler {
+public:
+    typedef std::function<void(size_t job, int worker)> Job;
+
+    explicit WorkStealingScheduler(int numWorkers):
+        m_queues(numWorkers > 0 ? numWorkers : 1)
+    {
+    }
+
+    int num_workers() const { return static_cast<int>(m_queues.size()); }
+
+    /**
+     * Runs every job once and returns when all have finished. The job must not throw.
+     */
+    void Run(size_t numJobs, const Job& job)
+    {
+        int workers = num_workers();
+        for (int w = 0; w < workers; ++w) {
+            size_t first = numJobs * w / workers;
+            size_t last = numJobs * (w + 1) / workers;
+            for (size_t j = first; j < last; ++j)
+                m_queues[w].jobs.push_back(j);
+        }
+
+        std::vector<std::thread> threads;
+        threads.reserve(workers - 1);
+        for (int w = 1; w < workers; ++w)
+            threads.push_back(std::thread(&WorkStealingScheduler::Work, this, w, std::cref(job)));
+        Work(0, job);
+        for (size_t i = 0; i < threads.size(); ++i)
+            threads[i].join();
+    }
+
+private:
+    struct alignas(64) Queue {
+        std::mutex lock;
+        std::deque<size_t> jobs;
+    };
+
+    bool PopLocal(int worker, size_t* job)
+    {
+        Queue& q = m_queues[worker];
+        std::lock_guard<std::mutex> guard(q.lock);
+        if (q.jobs.empty())
+            return false;
+        *job = q.jobs.back();
+        q.jobs.pop_back();
+        return true;
+    }
+
+    bool Steal(int worker, size_t* job)
+    {
+        int workers = num_workers();
+        for (int i = 1; i < workers; ++i) {
+            Queue& victim = m_queues[(worker + i) % workers];
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if (!victim.jobs.empty()) {
+                *job = victim.jobs.front();
+                victim.jobs.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void Work(int worker, const Job& job)
+    {
+        // jobs never spawn jobs, so once every deque is empty there is nothing left to wait for
+        size_t next;
+        while (PopLocal(worker, &next) || Steal(worker, &next))
+            job(next, worker);
+    }
+
+private:
+    std::vector<Queue> m_queues;
+};
+
+} // namespace Replay
+
+#endif
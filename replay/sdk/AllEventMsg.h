@@ -0,0 +1,192 @@
+#pragma once
+
+#ifndef _STRATEGY_STUDIO_REPLAY_SDK_ALL_EVENT_MSG_H_
+#define _STRATEGY_STUDIO_REPLAY_SDK_ALL_EVENT_MSG_H_
+
+#include "DataTypes.h"
+#include "FillInfo.h"
+#include "Order.h"
+#include "MarketModels/Instrument.h"
+
+#include <string>
+
+namespace RCM {
+namespace StrategyStudio {
+
+class EventMsg {
+public:
+    explicit EventMsg(const TimeType& eventTime): m_eventTime(eventTime) {}
+
+    const TimeType& event_time() const { return m_eventTime; }
+
+private:
+    TimeType m_eventTime;
+};
+
+class MarketDataEventMsg : public EventMsg {
+public:
+    MarketDataEventMsg(const MarketModels::Instrument& instrument, const TimeType& eventTime):
+        EventMsg(eventTime), m_instrument(&instrument)
+    {
+    }
+
+    const MarketModels::Instrument& instrument() const { return *m_instrument; }
+    const TimeType& source_time() const { return event_time(); }
+
+private:
+    const MarketModels::Instrument* m_instrument;
+};
+
+class TradeDataEventMsg : public MarketDataEventMsg {
+public:
+    TradeDataEventMsg(const MarketModels::Instrument& instrument, const MarketModels::Trade& trade, const TimeType& eventTime):
+        MarketDataEventMsg(instrument, eventTime), m_trade(trade)
+    {
+    }
+
+    const MarketModels::Trade& trade() const { return m_trade; }
+
+private:
+    MarketModels::Trade m_trade;
+};
+
+class QuoteEventMsg : public MarketDataEventMsg {
+public:
+    QuoteEventMsg(const MarketModels::Instrument& instrument, const MarketModels::Quote& quote, const TimeType& eventTime):
+        MarketDataEventMsg(instrument, eventTime), m_quote(quote)
+    {
+    }
+
+    const MarketModels::Quote& quote() const { return m_quote; }
+
+private:
+    MarketModels::Quote m_quote;
+};
+
+class MarketDepthEventMsg : public MarketDataEventMsg {
+public:
+    MarketDepthEventMsg(const MarketModels::Instrument& instrument,
+                        bool isBid,
+                        MarketModels::DepthUpdateType updateType,
+                        int level,
+                        double price,
+                        int size,
+                        const TimeType& eventTime):
+        MarketDataEventMsg(instrument, eventTime),
+        m_isBid(isBid),
+        m_updateType(updateType),
+        m_level(level),
+        m_price(price),
+        m_size(size)
+    {
+    }
+
+    bool is_bid() const { return m_isBid; }
+    MarketModels::DepthUpdateType update_type() const { return m_updateType; }
+    int level() const { return m_level; }
+    double price() const { return m_price; }
+
+    int size() const { return m_size; }
+
+private:
+    bool m_isBid;
+    MarketModels::DepthUpdateType m_updateType;
+    int m_level;
+    double m_price;
+    int m_size;
+};
+
+class BarEventMsg : public MarketDataEventMsg {
+public:
+    BarEventMsg(const MarketModels::Instrument& instrument, const MarketModels::Bar& bar, const TimeType& barTime, int interval):
+        MarketDataEventMsg(instrument, barTime), m_bar(bar), m_interval(interval)
+    {
+    }
+
+    const MarketModels::Bar& bar() const { return m_bar; }
+    const TimeType& bar_time() const { return event_time(); }
+    int interval() const { return m_interval; }
+
+private:
+    MarketModels::Bar m_bar;
+    int m_interval;
+};
+
+class OrderUpdateEventMsg : public EventMsg {
+public:
+    OrderUpdateEventMsg(const Order& order, OrderUpdateType updateType, const FillInfo& fill, const TimeType& updateTime):
+        EventMsg(updateTime), m_order(&order), m_updateType(updateType), m_fill(fill)
+    {
+    }
+
+    const Order& order() const { return *m_order; }
+    OrderUpdateType update_type() const { return m_updateType; }
+    const TimeType& update_time() const { return event_time(); }
+
+    bool fill_occurred() const
+    {
+        return m_updateType == ORDER_UPDATE_TYPE_FILL || m_updateType == ORDER_UPDATE_TYPE_PARTIAL_FILL;
+    }
+
+    const FillInfo* fill() const { return fill_occurred() ? &m_fill : NULL; }
+
+    bool completes_order() const
+    {
+        return m_updateType == ORDER_UPDATE_TYPE_FILL || m_updateType == ORDER_UPDATE_TYPE_CANCEL || m_updateType == ORDER_UPDATE_TYPE_REJECT;
+    }
+
+    std::string name() const
+    {
+        switch (m_updateType) {
+            case ORDER_UPDATE_TYPE_NEW: return "New";
+            case ORDER_UPDATE_TYPE_FILL: return "Fill";
+            case ORDER_UPDATE_TYPE_PARTIAL_FILL: return "PartialFill";
+            case ORDER_UPDATE_TYPE_CANCEL: return "Cancel";
+            case ORDER_UPDATE_TYPE_MODIFY: return "Modify";
+            case ORDER_UPDATE_TYPE_REJECT: return "Reject";
+            case ORDER_UPDATE_TYPE_CANCEL_REJECT: return "CancelReject";
+            case ORDER_UPDATE_TYPE_REPLACE_REJECT: return "ReplaceReject";
+        }
+        return "Unknown";
+    }
+
+private:
+    const Order* m_order;
+    OrderUpdateType m_updateType;
+    FillInfo m_fill;
+};
+
+class MarketStateEventMsg : public EventMsg {
+public:
+    explicit MarketStateEventMsg(const TimeType& eventTime): EventMsg(eventTime) {}
+};
+
+class StrategyStateControlEventMsg : public EventMsg {
+public:
+    explicit StrategyStateControlEventMsg(const TimeType& eventTime): EventMsg(eventTime) {}
+};
+
+class DataSubscriptionEventMsg : public EventMsg {
+public:
+    explicit DataSubscriptionEventMsg(const TimeType& eventTime): EventMsg(eventTime) {}
+};
+
+class AppStateEventMsg : public EventMsg {
+public:
+    explicit AppStateEventMsg(const TimeType& eventTime): EventMsg(eventTime) {}
+};
+
+class StrategyCommandEventMsg : public EventMsg {
+public:
+    StrategyCommandEventMsg(int commandID, const TimeType& eventTime): EventMsg(eventTime), m_commandID(commandID) {}
+
+    int command_id() const { return m_commandID; }
+
+private:
+    int m_commandID;
+};
+
+} // namespace StrategyStudio
+} // namespace RCM
+
+#endif
@@ -0,0 +1,8 @@
+#pragma once
+
+#ifndef _STRATEGY_STUDIO_REPLAY_SDK_ANALYTICS_INCREMENTAL_ESTIMATION_H_
+#define _STRATEGY_STUDIO_REPLAY_SDK_ANALYTICS_INCREMENTAL_ESTIMATION_H_
+
+// Included by the strategies for SDK compatibility; nothing from it is used, so the stand-in is empty.
+
+#endif
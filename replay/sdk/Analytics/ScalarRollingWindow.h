@@ -0,0 +1,54 @@
+#pragma once
+
+#ifndef _STRATEGY_STUDIO_REPLAY_SDK_ANALYTICS_SCALAR_ROLLING_WINDOW_H_
+#define _STRATEGY_STUDIO_REPLAY_SDK_ANALYTICS_SCALAR_ROLLING_WINDOW_H_
+
+#include <boost/circular_buffer.hpp>
+
+#include <cmath>
+
+namespace RCM {
+namespace StrategyStudio {
+namespace Analytics {
+
+/**
+ * Fixed-size rolling window of scalars with on-demand statistics, as in the SDK
+ */
+template <typename T>
+class ScalarRollingWindow : public boost::circular_buffer<T> {
+public:
+    explicit ScalarRollingWindow(size_t size = 0): boost::circular_buffer<T>(size) {}
+
+    T Mean() const
+    {
+        if (this->empty())
+            return T();
+        T sum = T();
+        for (typename boost::circular_buffer<T>::const_iterator it = this->begin(); it != this->end(); ++it)
+            sum += *it;
+        return sum / static_cast<T>(this->size());
+    }
+
+    T StdDev() const
+    {
+        if (this->size() < 2)
+            return T();
+        T mean = Mean();
+        T sumSq = T();
+        for (typename boost::circular_buffer<T>::const_iterator it = this->begin(); it != this->end(); ++it)
+            sumSq += (*it - mean) * (*it - mean);
+        return std::sqrt(sumSq / static_cast<T>(this->size() - 1));
+    }
+
+    T ZScore(T value) const
+    {
+        T sd = StdDev();
+        return (sd != T()) ? (value - Mean()) / sd : T();
+    }
+};
+
+} // namespace Analytics
+} // namespace StrategyStudio
+} // namespace RCM
+
+#endif
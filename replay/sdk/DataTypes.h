@@ -0,0 +1,42 @@
+#pragma once
+
+#ifndef _STRATEGY_STUDIO_REPLAY_SDK_DATA_TYPES_H_
+#define _STRATEGY_STUDIO_REPLAY_SDK_DATA_TYPES_H_
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include <stdexcept>
+#include <string>
+
+namespace RCM {
+namespace StrategyStudio {
+
+typedef std::string SymbolTag;
+typedef unsigned StrategyID;
+typedef boost::posix_time::ptime TimeType;
+typedef boost::gregorian::date DateType;
+
+enum LogLevel {
+    LOGLEVEL_DEBUG = 0,
+    LOGLEVEL_INFO = 1,
+    LOGLEVEL_WARN = 2,
+    LOGLEVEL_ERROR = 3
+};
+
+class StrategyStudioException : public std::runtime_error {
+public:
+    explicit StrategyStudioException(const std::string& what): std::runtime_error(what) {}
+};
+
+/**
+ * Converts a replay timestamp (nanoseconds since the unix epoch) into the SDK time type
+ */
+inline TimeType TimeFromNanos(long long nanos)
+{
+    return TimeType(DateType(1970, 1, 1)) + boost::posix_time::microseconds(nanos / 1000);
+}
+
+} // namespace StrategyStudio
+} // namespace RCM
+
+#endif
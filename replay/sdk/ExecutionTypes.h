@@ -0,0 +1,128 @@
+#pragma once
+
+#ifndef _STRATEGY_STUDIO_REPLAY_SDK_EXECUTION_TYPES_H_
+#define _STRATEGY_STUDIO_REPLAY_SDK_EXECUTION_TYPES_H_
+
+#include "DataTypes.h"
+
+namespace RCM {
+namespace StrategyStudio {
+
+namespace MarketModels {
+class Instrument;
+}
+
+typedef unsigned long long OrderID;
+
+enum OrderSide {
+    ORDER_SIDE_UNKNOWN = 0,
+    ORDER_SIDE_BUY = 1,
+    ORDER_SIDE_SELL = 2,
+    ORDER_SIDE_SELL_SHORT = 3
+};
+
+enum OrderTIF {
+    ORDER_TIF_DAY = 0,
+    ORDER_TIF_GTC = 1,
+    ORDER_TIF_IOC = 2,
+    ORDER_TIF_FOK = 3
+};
+
+enum OrderType {
+    ORDER_TYPE_MARKET = 0,
+    ORDER_TYPE_LIMIT = 1
+};
+
+enum OrderState {
+    ORDER_STATE_PENDING_OPEN = 0,
+    ORDER_STATE_OPEN = 1,
+    ORDER_STATE_PARTIALLY_FILLED = 2,
+    ORDER_STATE_FILLED = 3,
+    ORDER_STATE_CANCELLED = 4,
+    ORDER_STATE_REJECTED = 5
+};
+
+enum OrderUpdateType {
+    ORDER_UPDATE_TYPE_NEW = 0,
+    ORDER_UPDATE_TYPE_FILL = 1,
+    ORDER_UPDATE_TYPE_PARTIAL_FILL = 2,
+    ORDER_UPDATE_TYPE_CANCEL = 3,
+    ORDER_UPDATE_TYPE_MODIFY = 4,
+    ORDER_UPDATE_TYPE_REJECT = 5,
+    ORDER_UPDATE_TYPE_CANCEL_REJECT = 6,     // the order is still working as it was
+    ORDER_UPDATE_TYPE_REPLACE_REJECT = 7     // the order is still working with its old params
+};
+
+enum TradeActionResult {
+    TRADE_ACTION_RESULT_SUCCESSFUL = 0,
+    TRADE_ACTION_RESULT_FAILED = 1,
+    TRADE_ACTION_RESULT_INVALID_ORDER = 2,
+    TRADE_ACTION_RESULT_ORDER_NOT_FOUND = 3
+};
+
+enum MarketCenterID {
+    MARKET_CENTER_ID_UNKNOWN = 0,
+    MARKET_CENTER_ID_NASDAQ = 1,
+    MARKET_CENTER_ID_NYSE = 2,
+    MARKET_CENTER_ID_CBOE_OPTIONS = 3,
+    MARKET_CENTER_ID_CME_GLOBEX = 4
+};
+
+inline bool IsBuySide(OrderSide side)
+{
+    return side == ORDER_SIDE_BUY;
+}
+
+inline bool IsSellSide(OrderSide side)
+{
+    return side == ORDER_SIDE_SELL || side == ORDER_SIDE_SELL_SHORT;
+}
+
+/**
+ * Parameters of a new or replacement order. order_id is filled in by the trade actions on a successful send.
+ */
+struct OrderParams {
+    OrderParams():
+        instrument(0),
+        quantity(0),
+        price(0),
+        market_center(MARKET_CENTER_ID_UNKNOWN),
+        order_side(ORDER_SIDE_UNKNOWN),
+        tif(ORDER_TIF_DAY),
+        order_type(ORDER_TYPE_MARKET),
+        order_id(0)
+    {
+    }
+
+    OrderParams(const MarketModels::Instrument& inst,
+                unsigned qty,
+                double px,
+                MarketCenterID mc,
+                OrderSide side,
+                OrderTIF t,
+                OrderType type):
+        instrument(&inst),
+        quantity(qty),
+        price(px),
+        market_center(mc),
+        order_side(side),
+        tif(t),
+        order_type(type),
+        order_id(0)
+    {
+    }
+
+    const MarketModels::Instrument* instrument;
+    unsigned quantity;
+    double price;
+    MarketCenterID market_center;
+    OrderSide order_side;
+    OrderTIF tif;
+    OrderType order_type;
+    OrderID order_id;
+};
+
+} // namespace StrategyStudio
+} // namespace RCM
+
+#endif
@@ -0,0 +1,33 @@
+#pragma once
+
+#ifndef _STRATEGY_STUDIO_REPLAY_SDK_FILL_INFO_H_
+#define _STRATEGY_STUDIO_REPLAY_SDK_FILL_INFO_H_
+
+#include "ExecutionTypes.h"
+
+namespace RCM {
+namespace StrategyStudio {
+
+class FillInfo {
+public:
+    FillInfo(): m_orderID(0), m_price(0), m_size(0) {}
+    FillInfo(OrderID orderID, double price, int size): m_orderID(orderID), m_price(price), m_size(size) {}
+
+    OrderID order_id() const { return m_orderID; }
+    double fill_price() const { return m_price; }
+
+    /**
+     * Signed fill size: positive for buys, negative for sells
+     */
+    int fill_size() const { return m_size; }
+
+private:
+    OrderID m_orderID;
+    double m_price;
+    int m_size;
+};
+
+} // namespace StrategyStudio
+} // namespace RCM
+
+#endif
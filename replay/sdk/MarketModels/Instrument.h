@@ -0,0 +1,210 @@
+#pragma once
+
+#ifndef _STRATEGY_STUDIO_REPLAY_SDK_MARKET_MODELS_INSTRUMENT_H_
+#define _STRATEGY_STUDIO_REPLAY_SDK_MARKET_MODELS_INSTRUMENT_H_
+
+#include "../DataTypes.h"
+
+#include <ostream>
+#include <vector>
+
+namespace RCM {
+namespace StrategyStudio {
+namespace MarketModels {
+
+enum InstrumentType {
+    INSTRUMENT_TYPE_UNKNOWN = 0,
+    INSTRUMENT_TYPE_EQUITY = 1,
+    INSTRUMENT_TYPE_OPTION = 2,
+    INSTRUMENT_TYPE_FUTURE = 3
+};
+
+enum DepthUpdateType {
+    DEPTH_UPDATE_TYPE_INSERT = 0,
+    DEPTH_UPDATE_TYPE_UPDATE = 1,
+    DEPTH_UPDATE_TYPE_DELETE = 2
+};
+
+class Quote {
+public:
+    Quote(): m_bid(0), m_ask(0), m_bidSize(0), m_askSize(0) {}
+
+    double bid() const { return m_bid; }
+    double ask() const { return m_ask; }
+    int bid_size() const { return m_bidSize; }
+    int ask_size() const { return m_askSize; }
+    double mid_price() const { return (m_bid + m_ask) / 2; }
+
+    void set(double bid, int bidSize, double ask, int askSize)
+    {
+        m_bid = bid;
+        m_bidSize = bidSize;
+        m_ask = ask;
+        m_askSize = askSize;
+    }
+
+private:
+    double m_bid;
+    double m_ask;
+    int m_bidSize;
+    int m_askSize;
+};
+
+class Trade {
+public:
+    Trade(): m_price(0), m_size(0) {}
+    Trade(double price, int size): m_price(price), m_size(size) {}
+
+    double price() const { return m_price; }
+    int size() const { return m_size; }
+
+private:
+    double m_price;
+    int m_size;
+};
+
+class Bar {
+public:
+    Bar(): m_open(0), m_high(0), m_low(0), m_close(0), m_volume(0) {}
+    Bar(double open, double high, double low, double close, long long volume):
+        m_open(open), m_high(high), m_low(low), m_close(close), m_volume(volume)
+    {
+    }
+
+    double open() const { return m_open; }
+    double high() const { return m_high; }
+    double low() const { return m_low; }
+    double close() const { return m_close; }
+    long long volume() const { return m_volume; }
+
+private:
+    double m_open;
+    double m_high;
+    double m_low;
+    double m_close;
+    long long m_volume;
+};
+
+inline std::ostream& operator<<(std::ostream& os, const Bar& bar)
+{
+    return os << "O " << bar.open() << " H " << bar.high() << " L " << bar.low()
+              << " C " << bar.close() << " V " << bar.volume();
+}
+
+class IPriceLevel {
+public:
+    virtual ~IPriceLevel() {}
+    virtual double price() const = 0;
+    virtual int size() const = 0;
+};
+
+class IAggrOrderBook {
+public:
+    virtual ~IAggrOrderBook() {}
+    virtual const IPriceLevel* AskPriceLevelAtLevel(int level) const = 0;
+    virtual const IPriceLevel* BidPriceLevelAtLevel(int level) const = 0;
+    virtual int NumAskLevels() const = 0;
+    virtual int NumBidLevels() const = 0;
+};
+
+/**
+ * Aggregate price level book kept by the replay host. Levels are indexed from the top of book.
+ */
+class AggrOrderBook : public IAggrOrderBook {
+public:
+    class PriceLevel : public IPriceLevel {
+    public:
+        PriceLevel(): m_price(0), m_size(0) {}
+        PriceLevel(double price, int size): m_price(price), m_size(size) {}
+
+        double price() const { return m_price; }
+        int size() const { return m_size; }
+
+    private:
+        double m_price;
+        int m_size;
+    };
+
+public:
+    const IPriceLevel* AskPriceLevelAtLevel(int level) const
+    {
+        return (level >= 0 && level < static_cast<int>(m_asks.size())) ? &m_asks[level] : NULL;
+    }
+
+    const IPriceLevel* BidPriceLevelAtLevel(int level) const
+    {
+        return (level >= 0 && level < static_cast<int>(m_bids.size())) ? &m_bids[level] : NULL;
+    }
+
+    int NumAskLevels() const { return static_cast<int>(m_asks.size()); }
+    int NumBidLevels() const { return static_cast<int>(m_bids.size()); }
+
+    /**
+     * Applies a level-based depth update. Inserts shift deeper levels down, deletes shift them up.
+     */
+    void ApplyDepth(bool bidSide, DepthUpdateType updateType, int level, double price, int size)
+    {
+        std::vector<PriceLevel>& side = bidSide ? m_bids : m_asks;
+        if (level < 0)
+            return;
+
+        switch (updateType) {
+            case DEPTH_UPDATE_TYPE_INSERT:
+                if (level > static_cast<int>(side.size()))
+                    side.resize(level);
+                side.insert(side.begin() + level, PriceLevel(price, size));
+                break;
+            case DEPTH_UPDATE_TYPE_UPDATE:
+                if (level >= static_cast<int>(side.size()))
+                    side.resize(level + 1);
+                side[level] = PriceLevel(price, size);
+                break;
+            case DEPTH_UPDATE_TYPE_DELETE:
+                if (level < static_cast<int>(side.size()))
+                    side.erase(side.begin() + level);
+                break;
+        }
+    }
+
+    void Clear()
+    {
+        m_bids.clear();
+        m_asks.clear();
+    }
+
+private:
+    std::vector<PriceLevel> m_bids;
+    std::vector<PriceLevel> m_asks;
+};
+
+class Instrument {
+public:
+    Instrument(const SymbolTag& symbol, InstrumentType type = INSTRUMENT_TYPE_EQUITY):
+        m_symbol(symbol), m_type(type)
+    {
+    }
+
+    const SymbolTag& symbol() const { return m_symbol; }
+    InstrumentType type() const { return m_type; }
+    const Quote& top_quote() const { return m_topQuote; }
+    const Trade& last_trade() const { return m_lastTrade; }
+    const IAggrOrderBook& aggregate_order_book() const { return m_book; }
+
+    // mutators used by the replay host when applying market data
+    Quote& mutable_top_quote() { return m_topQuote; }
+    AggrOrderBook& mutable_order_book() { return m_book; }
+    void set_last_trade(const Trade& trade) { m_lastTrade = trade; }
+
+private:
+    SymbolTag m_symbol;
+    InstrumentType m_type;
+    Quote m_topQuote;
+    Trade m_lastTrade;
+    AggrOrderBook m_book;
+};
+
+} // namespace MarketModels
+} // namespace StrategyStudio
+} // namespace RCM
+
+#endif
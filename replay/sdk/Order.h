@@ -0,0 +1,98 @@
+#pragma once
+
+#ifndef _STRATEGY_STUDIO_REPLAY_SDK_ORDER_H_
+#define _STRATEGY_STUDIO_REPLAY_SDK_ORDER_H_
+
+#include "ExecutionTypes.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace RCM {
+namespace StrategyStudio {
+
+class Order {
+public:
+    Order(const OrderParams& params):
+        m_params(params), m_state(ORDER_STATE_PENDING_OPEN), m_executedQuantity(0)
+    {
+    }
+
+    OrderID order_id() const { return m_params.order_id; }
+    const MarketModels::Instrument* instrument() const { return m_params.instrument; }
+    const OrderParams& params() const { return m_params; }
+    OrderSide order_side() const { return m_params.order_side; }
+    OrderType order_type() const { return m_params.order_type; }
+    OrderState order_state() const { return m_state; }
+    double price() const { return m_params.price; }
+    unsigned order_quantity() const { return m_params.quantity; }
+    unsigned executed_quantity() const { return m_executedQuantity; }
+    unsigned leaves_quantity() const { return m_params.quantity - m_executedQuantity; }
+
+    bool is_working() const
+    {
+        return m_state == ORDER_STATE_PENDING_OPEN || m_state == ORDER_STATE_OPEN || m_state == ORDER_STATE_PARTIALLY_FILLED;
+    }
+
+    // mutators used by the replay host's simulated exchange
+    void set_state(OrderState state) { m_state = state; }
+    void add_execution(unsigned quantity) { m_executedQuantity += quantity; }
+    void replace_params(const OrderParams& params)
+    {
+        OrderID id = m_params.order_id;
+        m_params = params;
+        m_params.order_id = id;
+    }
+
+private:
+    OrderParams m_params;
+    OrderState m_state;
+    unsigned m_executedQuantity;
+};
+
+/**
+ * Tracks the strategy's orders. The replay host owns the orders and keeps the working set current.
+ */
+class IOrderTracker {
+public:
+    typedef std::vector<Order*> WorkingOrders;
+    typedef WorkingOrders::iterator WorkingOrdersIter;
+    typedef WorkingOrders::const_iterator WorkingOrdersConstIter;
+
+public:
+    size_t num_working_orders() const { return m_working.size(); }
+
+    WorkingOrdersConstIter working_orders_begin() const { return m_working.begin(); }
+    WorkingOrdersConstIter working_orders_end() const { return m_working.end(); }
+
+    const Order* find_working(OrderID orderID) const
+    {
+        for (WorkingOrdersConstIter it = m_working.begin(); it != m_working.end(); ++it) {
+            if ((*it)->order_id() == orderID)
+                return *it;
+        }
+        return NULL;
+    }
+
+    // mutators used by the replay host
+    void AddWorking(Order* order) { m_working.push_back(order); }
+
+    void RemoveWorking(Order* order)
+    {
+        WorkingOrdersIter it = std::find(m_working.begin(), m_working.end(), order);
+        if (it != m_working.end()) {
+            *it = m_working.back();
+            m_working.pop_back();
+        }
+    }
+
+    void Clear() { m_working.clear(); }
+
+private:
+    WorkingOrders m_working;
+};
+
+} // namespace StrategyStudio
+} // namespace RCM
+
+#endif
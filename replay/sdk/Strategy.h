@@ -0,0 +1,432 @@
+#pragma once
+
+#ifndef _STRATEGY_STUDIO_REPLAY_SDK_STRATEGY_H_
+#define _STRATEGY_STUDIO_REPLAY_SDK_STRATEGY_H_
+
+/**
+ * Stand-in for the Strategy Studio SDK's Strategy.h.
+ *
+ * Provides the subset of the SDK surface that the strategies in this repository use, so that they can be built
+ * unmodified as shared objects and driven by the replay host (see replay/ReplayHost.h) on a plain Linux box.
+ * Everything here is header-only so that the host and the strategy object agree on layout without a vendor library.
+ */
+
+#include "DataTypes.h"
+#include "ExecutionTypes.h"
+#include "FillInfo.h"
+#include "Order.h"
+#include "AllEventMsg.h"
+#include "MarketModels/Instrument.h"
+
+#include <boost/unordered_map.hpp>
+
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace RCM {
+namespace StrategyStudio {
+
+using MarketModels::Bar;
+using MarketModels::IAggrOrderBook;
+using MarketModels::Instrument;
+using MarketModels::IPriceLevel;
+using MarketModels::Quote;
+using MarketModels::Trade;
+
+typedef std::vector<SymbolTag> SymbolSet;
+typedef SymbolSet::const_iterator SymbolSetConstIter;
+
+enum StrategyParamType {
+    STRATEGY_PARAM_TYPE_STARTUP = 0,
+    STRATEGY_PARAM_TYPE_RUNTIME = 1
+};
+
+enum ValueType {
+    VALUE_TYPE_INT = 0,
+    VALUE_TYPE_DOUBLE = 1,
+    VALUE_TYPE_BOOL = 2,
+    VALUE_TYPE_STRING = 3
+};
+
+enum BarType {
+    BAR_TYPE_TIME = 0,
+    BAR_TYPE_TICK = 1
+};
+
+class StrategyParam {
+public:
+    StrategyParam(const std::string& name, StrategyParamType paramType, ValueType valueType):
+        m_name(name), m_paramType(paramType), m_valueType(valueType), m_int(0), m_double(0), m_bool(false)
+    {
+    }
+
+    const std::string& param_name() const { return m_name; }
+    StrategyParamType param_type() const { return m_paramType; }
+    ValueType value_type() const { return m_valueType; }
+
+    bool Get(int* value) const
+    {
+        if (m_valueType != VALUE_TYPE_INT)
+            return false;
+        *value = m_int;
+        return true;
+    }
+
+    bool Get(double* value) const
+    {
+        if (m_valueType != VALUE_TYPE_DOUBLE)
+            return false;
+        *value = m_double;
+        return true;
+    }
+
+    bool Get(bool* value) const
+    {
+        if (m_valueType != VALUE_TYPE_BOOL)
+            return false;
+        *value = m_bool;
+        return true;
+    }
+
+    bool Get(std::string* value) const
+    {
+        if (m_valueType != VALUE_TYPE_STRING)
+            return false;
+        *value = m_string;
+        return true;
+    }
+
+    void Set(int value) { m_int = value; m_double = value; m_bool = (value != 0); }
+    void Set(double value) { m_double = value; m_int = static_cast<int>(value); m_bool = (value != 0); }
+    void Set(bool value) { m_bool = value; m_int = value; m_double = value; }
+    void Set(const std::string& value) { m_string = value; }
+
+    /**
+     * Parses a textual value according to the param's value type; returns false if it does not parse
+     */
+    bool SetFromString(const std::string& text)
+    {
+        std::istringstream is(text);
+        switch (m_valueType) {
+            case VALUE_TYPE_INT: {
+                int v;
+                if (!(is >> v))
+                    return false;
+                Set(v);
+                return true;
+            }
+            case VALUE_TYPE_DOUBLE: {
+                double v;
+                if (!(is >> v))
+                    return false;
+                Set(v);
+                return true;
+            }
+            case VALUE_TYPE_BOOL:
+                if (text == "1" || text == "true") {
+                    Set(true);
+                } else if (text == "0" || text == "false") {
+                    Set(false);
+                } else {
+                    return false;
+                }
+                return true;
+            case VALUE_TYPE_STRING:
+                Set(text);
+                return true;
+        }
+        return false;
+    }
+
+private:
+    std::string m_name;
+    StrategyParamType m_paramType;
+    ValueType m_valueType;
+    int m_int;
+    double m_double;
+    bool m_bool;
+    std::string m_string;
+};
+
+class CreateStrategyParamArgs {
+public:
+    template <typename T>
+    CreateStrategyParamArgs(const std::string& name, StrategyParamType paramType, ValueType valueType, const T& defaultValue):
+        m_param(name, paramType, valueType)
+    {
+        m_param.Set(defaultValue);
+    }
+
+    CreateStrategyParamArgs(const std::string& name, StrategyParamType paramType, ValueType valueType, const char* defaultValue):
+        m_param(name, paramType, valueType)
+    {
+        m_param.Set(std::string(defaultValue));
+    }
+
+    const StrategyParam& param() const { return m_param; }
+
+private:
+    StrategyParam m_param;
+};
+
+class StrategyCommand {
+public:
+    StrategyCommand(int commandID, const std::string& name): m_commandID(commandID), m_name(name) {}
+
+    int command_id() const { return m_commandID; }
+    const std::string& name() const { return m_name; }
+
+private:
+    int m_commandID;
+    std::string m_name;
+};
+
+class StrategyCommandCollection {
+public:
+    typedef std::vector<StrategyCommand>::const_iterator CommandsConstIter;
+
+    void AddCommand(const StrategyCommand& command) { m_commands.push_back(command); }
+
+    CommandsConstIter begin() const { return m_commands.begin(); }
+    CommandsConstIter end() const { return m_commands.end(); }
+
+private:
+    std::vector<StrategyCommand> m_commands;
+};
+
+/**
+ * Sink for LogToClient. The replay host decides where (and whether) messages go.
+ */
+class StrategyLogger {
+public:
+    StrategyLogger(): m_out(NULL), m_minLevel(LOGLEVEL_DEBUG) {}
+
+    void LogToClient(LogLevel level, const char* message)
+    {
+        if (m_out && level >= m_minLevel)
+            *m_out << message << '\n';
+    }
+
+    void LogToClient(LogLevel level, const std::string& message) { LogToClient(level, message.c_str()); }
+
+    void set_output(std::ostream* out, LogLevel minLevel)
+    {
+        m_out = out;
+        m_minLevel = minLevel;
+    }
+
+private:
+    std::ostream* m_out;
+    LogLevel m_minLevel;
+};
+
+/**
+ * Fill-driven position and cash book. Marks use the instrument's last trade, falling back to the top quote mid.
+ */
+class PortfolioTracker {
+public:
+    PortfolioTracker(): m_realizedCash(0) {}
+
+    int position(const Instrument* instrument) const
+    {
+        PositionsConstIter it = m_positions.find(instrument);
+        return (it != m_positions.end()) ? it->second.position : 0;
+    }
+
+    double total_pnl() const
+    {
+        double pnl = m_realizedCash;
+        for (PositionsConstIter it = m_positions.begin(); it != m_positions.end(); ++it) {
+            const Instrument* instrument = it->first;
+            double mark = instrument->last_trade().price();
+            if (mark == 0)
+                mark = instrument->top_quote().mid_price();
+            pnl += it->second.position * mark;
+        }
+        return pnl;
+    }
+
+    // mutators used by the replay host's simulated exchange
+    void ApplyFill(const Instrument* instrument, int signedQuantity, double price)
+    {
+        m_positions[instrument].position += signedQuantity;
+        m_realizedCash -= signedQuantity * price;
+    }
+
+    void Clear()
+    {
+        m_positions.clear();
+        m_realizedCash = 0;
+    }
+
+private:
+    struct PositionInfo {
+        PositionInfo(): position(0) {}
+        int position;
+    };
+
+    typedef std::map<const Instrument*, PositionInfo> Positions;
+    typedef Positions::const_iterator PositionsConstIter;
+
+    Positions m_positions;
+    double m_realizedCash;
+};
+
+class ITradeActions {
+public:
+    virtual ~ITradeActions() {}
+
+    /**
+     * Sends a new order; on success params.order_id holds the id assigned to it
+     */
+    virtual TradeActionResult SendNewOrder(OrderParams& params) = 0;
+    virtual TradeActionResult SendCancelOrder(OrderID orderID) = 0;
+    virtual TradeActionResult SendCancelReplaceOrder(OrderID orderID, const OrderParams& params) = 0;
+    virtual TradeActionResult SendCancelAll() = 0;
+};
+
+typedef std::pair<bool, const Instrument*> EventInstrumentPair;
+
+class StrategyEventRegister {
+public:
+    virtual ~StrategyEventRegister() {}
+
+    virtual EventInstrumentPair RegisterForMarketData(const SymbolTag& symbol) = 0;
+    virtual EventInstrumentPair RegisterForBars(const SymbolTag& symbol, BarType barType, int interval) = 0;
+};
+
+class IStrategy {
+public:
+    virtual ~IStrategy() {}
+
+public: /* IEventCallback */
+    virtual void OnTrade(const TradeDataEventMsg& msg) {}
+    virtual void OnTopQuote(const QuoteEventMsg& msg) {}
+    virtual void OnQuote(const QuoteEventMsg& msg) {}
+    virtual void OnDepth(const MarketDepthEventMsg& msg) {}
+    virtual void OnBar(const BarEventMsg& msg) {}
+    virtual void OnMarketState(const MarketStateEventMsg& msg) {}
+    virtual void OnOrderUpdate(const OrderUpdateEventMsg& msg) {}
+    virtual void OnStrategyControl(const StrategyStateControlEventMsg& msg) {}
+    virtual void OnDataSubscription(const DataSubscriptionEventMsg& msg) {}
+    virtual void OnAppStateChange(const AppStateEventMsg& msg) {}
+    virtual void OnStrategyCommand(const StrategyCommandEventMsg& msg) {}
+    virtual void OnResetStrategyState() {}
+    virtual void OnParamChanged(StrategyParam& param) {}
+
+protected:
+    virtual void RegisterForStrategyEvents(StrategyEventRegister* eventRegister, DateType currDate) = 0;
+    virtual void DefineStrategyParams() {}
+    virtual void DefineStrategyCommands() {}
+    virtual void DefineStrategyGraphs() {}
+};
+
+class StrategyParamCollection {
+public:
+    typedef std::deque<StrategyParam>::iterator ParamsIter;
+
+    explicit StrategyParamCollection(IStrategy* owner): m_owner(owner) {}
+
+    /**
+     * Adds the param and immediately notifies the strategy of its default value
+     */
+    void CreateParam(const CreateStrategyParamArgs& args)
+    {
+        m_params.push_back(args.param());
+        m_owner->OnParamChanged(m_params.back());
+    }
+
+    StrategyParam* GetParam(const std::string& name)
+    {
+        for (ParamsIter it = m_params.begin(); it != m_params.end(); ++it) {
+            if (it->param_name() == name)
+                return &*it;
+        }
+        return NULL;
+    }
+
+    ParamsIter begin() { return m_params.begin(); }
+    ParamsIter end() { return m_params.end(); }
+
+private:
+    IStrategy* m_owner;
+    std::deque<StrategyParam> m_params;
+};
+
+class Strategy : public IStrategy {
+public:
+    Strategy(StrategyID strategyID, const std::string& strategyName, const std::string& groupName):
+        m_strategyID(strategyID),
+        m_name(strategyName),
+        m_group(groupName),
+        m_params(this),
+        m_tradeActions(NULL)
+    {
+    }
+
+    virtual ~Strategy() {}
+
+    /**
+     * The exported CreateStrategy factories return *(new X(...)); this hands the framework its interface pointer
+     */
+    operator IStrategy*() { return this; }
+
+    static const char* release_version() { return "replay-sdk-1"; }
+
+    StrategyID strategy_id() const { return m_strategyID; }
+    const std::string& name() const { return m_name; }
+    const std::string& group() const { return m_group; }
+
+    SymbolSetConstIter symbols_begin() const { return m_symbols.begin(); }
+    SymbolSetConstIter symbols_end() const { return m_symbols.end(); }
+
+    StrategyParamCollection& params() { return m_params; }
+    StrategyCommandCollection& commands() { return m_commands; }
+    StrategyLogger& logger() { return m_logger; }
+    IOrderTracker& orders() { return m_orders; }
+    PortfolioTracker& portfolio() { return m_portfolio; }
+    ITradeActions* trade_actions() { return m_tradeActions; }
+
+public: /* framework entry points, called by the hosting server */
+
+    /**
+     * Wires in the host's services and runs the strategy's Define* hooks
+     */
+    void Initialize(ITradeActions* tradeActions, const SymbolSet& symbols)
+    {
+        m_tradeActions = tradeActions;
+        m_symbols = symbols;
+        DefineStrategyParams();
+        DefineStrategyCommands();
+        DefineStrategyGraphs();
+    }
+
+    void Register(StrategyEventRegister* eventRegister, DateType currDate)
+    {
+        RegisterForStrategyEvents(eventRegister, currDate);
+    }
+
+private:
+    StrategyID m_strategyID;
+    std::string m_name;
+    std::string m_group;
+    SymbolSet m_symbols;
+    StrategyParamCollection m_params;
+    StrategyCommandCollection m_commands;
+    StrategyLogger m_logger;
+    IOrderTracker m_orders;
+    PortfolioTracker m_portfolio;
+    ITradeActions* m_tradeActions;
+};
+
+} // namespace StrategyStudio
+} // namespace RCM
+
+#endif
@@ -0,0 +1,20 @@
+#pragma once
+
+#ifndef _STRATEGY_STUDIO_REPLAY_SDK_UTILITIES_CAST_H_
+#define _STRATEGY_STUDIO_REPLAY_SDK_UTILITIES_CAST_H_
+
+namespace RCM {
+namespace StrategyStudio {
+namespace Utilities {
+
+template <typename To, typename From>
+inline To numeric_cast(From value)
+{
+    return static_cast<To>(value);
+}
+
+} // namespace Utilities
+} // namespace StrategyStudio
+} // namespace RCM
+
+#endif
@@ -0,0 +1,9 @@
+#pragma once
+
+#ifndef _STRATEGY_STUDIO_REPLAY_SDK_UTILITIES_UTILS_H_
+#define _STRATEGY_STUDIO_REPLAY_SDK_UTILITIES_UTILS_H_
+
+// Namespace anchor for `using namespace RCM::StrategyStudio::Utilities`; see Cast.h for the helpers.
+#include "Cast.h"
+
+#endif
@@ -0,0 +1,249 @@
+#pragma once
+
+#ifndef _STRATEGY_STUDIO_LIB_EXAMPLES_BOOK_FEATURES_H_
+#define _STRATEGY_STUDIO_LIB_EXAMPLES_BOOK_FEATURES_H_
+
+#include "BookSnapshot.h"
+
+#include <MarketModels/Instrument.h>
+
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+using namespace RCM::StrategyStudio;
+
+/**
+ * Order book features kept up to date from depth deltas instead of recomputed from the book.
+ *
+ * Each instrument keeps a flat mirror of the top depth levels a side and the side's level count. A
+ * level update overwrites its slot; an insert or delete shifts at most depth slots of the mirror and
+ * reads the one level that enters it from the book. Every change is O(1) in the depth of the book,
+ * and the features below are read without touching the book:
+ *
+ *   sums            size and notional over the top levels present on both sides, as the signed
+ *                   volume signal uses them; the depth-weighted prices are notional / size. They are
+ *                   summed from the mirror by the BookSnapshot kernel, in the same order as a fresh
+ *                   capture, so they match the book read bit for bit whatever the prices
+ *   microprice      top of book mid weighted by the opposite side's size
+ *   imbalance       (bid size - ask size) / (bid size + ask size) at the top, in [-1, 1]
+ *   order_flow      cumulative order flow imbalance (Cont, Kukanov and Stoikov) of the top level
+ *
+ * OnDepth is fed the deltas of depth feeds. Top quotes that reach the book without a depth delta
+ * are picked up by OnQuote, which compares the mirror's top and level counts against the book and
+ * applies whatever it missed. Depth is fixed by Reset, up to BOOK_SNAPSHOT_MAX_DEPTH levels.
+ */
+class BookFeatureEngine {
+public:
+    BookFeatureEngine(): m_depth(0) {}
+
+    void Reset(size_t num_instruments, int depth) {
+        m_depth = std::max(1, std::min(depth, BOOK_SNAPSHOT_MAX_DEPTH));
+        m_books.assign(num_instruments, Book());
+    }
+
+    /**
+     * Applies one depth delta; the book must already include it
+     */
+    void OnDepth(int index, const MarketModels::IAggrOrderBook& book, bool is_bid, MarketModels::DepthUpdateType update_type,
+                 int level, double price, int size) {
+        Book& b = m_books[index];
+        Side& side = is_bid ? b.bid : b.ask;
+        switch (update_type) {
+            case MarketModels::DEPTH_UPDATE_TYPE_INSERT:
+                if (level > side.count) {
+                    Resync(side, book, is_bid);
+                } else {
+                    Insert(side, level, price, size);
+                }
+                break;
+            case MarketModels::DEPTH_UPDATE_TYPE_UPDATE:
+                if (level >= side.count) {
+                    Resync(side, book, is_bid);
+                } else {
+                    Update(side, level, price, size);
+                }
+                break;
+            case MarketModels::DEPTH_UPDATE_TYPE_DELETE:
+                if (level < side.count) {
+                    Delete(side, book, is_bid, level);
+                }
+                break;
+        }
+        if (level == 0) {
+            UpdateTop(b);
+        }
+    }
+
+    /**
+     * Brings the mirror in line with a top of book change that arrived without a depth delta;
+     * a no-op when the deltas already covered it
+     */
+    void OnQuote(int index, const MarketModels::IAggrOrderBook& book) {
+        Book& b = m_books[index];
+        bool changed = Reconcile(b.bid, book, true);
+        changed |= Reconcile(b.ask, book, false);
+        if (changed) {
+            UpdateTop(b);
+        }
+    }
+
+    /**
+     * Sums over the top levels present on both sides; false when either side is empty
+     */
+    bool sums(int index, BookSums* out) const {
+        const Book& b = m_books[index];
+        int levels = std::min(std::min(b.bid.count, b.ask.count), m_depth);
+        if (levels <= 0) {
+            return false;
+        }
+        BookSnapshot snapshot;
+        memcpy(snapshot.ask_price, b.ask.price, levels * sizeof(double));
+        memcpy(snapshot.ask_size, b.ask.quantity, levels * sizeof(double));
+        memcpy(snapshot.bid_price, b.bid.price, levels * sizeof(double));
+        memcpy(snapshot.bid_size, b.bid.quantity, levels * sizeof(double));
+        snapshot.Pad(levels);
+        *out = SumBookLevels(snapshot);
+        return true;
+    }
+
+    /**
+     * Size-weighted mid of the top level, or 0 until both sides are quoted
+     */
+    double microprice(int index) const {
+        const Book& b = m_books[index];
+        double total = b.top_bid_size + b.top_ask_size;
+        return (b.top_bid > 0 && b.top_ask > 0 && total > 0) ? (b.top_bid * b.top_ask_size + b.top_ask * b.top_bid_size) / total : 0;
+    }
+
+    double imbalance(int index) const {
+        const Book& b = m_books[index];
+        double total = b.top_bid_size + b.top_ask_size;
+        return (total > 0) ? (b.top_bid_size - b.top_ask_size) / total : 0;
+    }
+
+    double order_flow(int index) const { return m_books[index].order_flow; }
+
+    int depth() const { return m_depth; }
+
+private:
+    struct Side {
+        Side(): count(0) {
+            memset(price, 0, sizeof(price));
+            memset(quantity, 0, sizeof(quantity));
+        }
+
+        alignas(32) double price[BOOK_SNAPSHOT_MAX_DEPTH];
+        alignas(32) double quantity[BOOK_SNAPSHOT_MAX_DEPTH];   // zero past count
+        int count;          // levels in the full book side, mirrored or not
+    };
+
+    struct alignas(64) Book {
+        Book(): top_bid(0), top_bid_size(0), top_ask(0), top_ask_size(0), order_flow(0) {}
+
+        Side bid;
+        Side ask;
+        double top_bid;
+        double top_bid_size;
+        double top_ask;
+        double top_ask_size;
+        double order_flow;
+    };
+
+    void Update(Side& side, int level, double price, int size) {
+        if (level >= m_depth) {
+            return;
+        }
+        side.price[level] = price;
+        side.quantity[level] = size;
+    }
+
+    void Insert(Side& side, int level, double price, int size) {
+        ++side.count;
+        if (level >= m_depth) {
+            return;
+        }
+        // the deepest mirrored level is pushed out of the mirror
+        int moved = m_depth - 1 - level;
+        memmove(side.price + level + 1, side.price + level, moved * sizeof(double));
+        memmove(side.quantity + level + 1, side.quantity + level, moved * sizeof(double));
+        side.price[level] = price;
+        side.quantity[level] = size;
+    }
+
+    void Delete(Side& side, const MarketModels::IAggrOrderBook& book, bool is_bid, int level) {
+        --side.count;
+        if (level >= m_depth) {
+            return;
+        }
+        int moved = m_depth - 1 - level;
+        memmove(side.price + level, side.price + level + 1, moved * sizeof(double));
+        memmove(side.quantity + level, side.quantity + level + 1, moved * sizeof(double));
+
+        // the level below the mirror moves up into it
+        int last = m_depth - 1;
+        const MarketModels::IPriceLevel* entering = (side.count > last) ? LevelAt(book, is_bid, last) : NULL;
+        side.price[last] = entering ? entering->price() : 0;
+        side.quantity[last] = entering ? entering->size() : 0;
+    }
+
+    /**
+     * Re-reads the side's mirrored levels from the book; for changes a single delta cannot describe
+     */
+    void Resync(Side& side, const MarketModels::IAggrOrderBook& book, bool is_bid) {
+        side.count = is_bid ? book.NumBidLevels() : book.NumAskLevels();
+        for (int level = 0; level < m_depth; ++level) {
+            const MarketModels::IPriceLevel* entry = (level < side.count) ? LevelAt(book, is_bid, level) : NULL;
+            side.price[level] = entry ? entry->price() : 0;
+            side.quantity[level] = entry ? entry->size() : 0;
+        }
+    }
+
+    bool Reconcile(Side& side, const MarketModels::IAggrOrderBook& book, bool is_bid) {
+        int count = is_bid ? book.NumBidLevels() : book.NumAskLevels();
+        if (count != side.count) {
+            Resync(side, book, is_bid);
+            return true;
+        }
+        if (count == 0) {
+            return false;
+        }
+        const MarketModels::IPriceLevel* top = LevelAt(book, is_bid, 0);
+        if (top->price() == side.price[0] && top->size() == side.quantity[0]) {
+            return false;
+        }
+        Update(side, 0, top->price(), top->size());
+        return true;
+    }
+
+    /**
+     * Folds a top of book change into the order flow imbalance: bid size added at or above the old
+     * best bid counts as buying pressure, ask size added at or below the old best ask as selling
+     */
+    void UpdateTop(Book& b) {
+        double bid = (b.bid.count > 0) ? b.bid.price[0] : 0;
+        double bid_size = (b.bid.count > 0) ? b.bid.quantity[0] : 0;
+        double ask = (b.ask.count > 0) ? b.ask.price[0] : 0;
+        double ask_size = (b.ask.count > 0) ? b.ask.quantity[0] : 0;
+        if (b.top_bid > 0 && bid > 0) {
+            b.order_flow += ((bid >= b.top_bid) ? bid_size : 0) - ((bid <= b.top_bid) ? b.top_bid_size : 0);
+        }
+        if (b.top_ask > 0 && ask > 0) {
+            b.order_flow -= ((ask <= b.top_ask) ? ask_size : 0) - ((ask >= b.top_ask) ? b.top_ask_size : 0);
+        }
+        b.top_bid = bid;
+        b.top_bid_size = bid_size;
+        b.top_ask = ask;
+        b.top_ask_size = ask_size;
+    }
+
+    static const MarketModels::IPriceLevel* LevelAt(const MarketModels::IAggrOrderBook& book, bool is_bid, int level) {
+        return is_bid ? book.BidPriceLevelAtLevel(level) : book.AskPriceLevelAtLevel(level);
+    }
+
+    int m_depth;
+    std::vector<Book> m_books;
+};
+
+#endif
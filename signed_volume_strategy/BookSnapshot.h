@@ -0,0 +1,169 @@
+#pragma once
+
+#ifndef _STRATEGY_STUDIO_LIB_EXAMPLES_BOOK_SNAPSHOT_H_
+#define _STRATEGY_STUDIO_LIB_EXAMPLES_BOOK_SNAPSHOT_H_
+
+#include <MarketModels/Instrument.h>
+
+#if defined(__AVX__)
+    #include <immintrin.h>
+#elif defined(__SSE2__)
+    #include <emmintrin.h>
+#endif
+
+using namespace RCM::StrategyStudio;
+
+/**
+ * Deepest book the snapshot can hold; the configured depth is clamped to this
+ */
+const int BOOK_SNAPSHOT_MAX_DEPTH = 16;
+
+/**
+ * Lanes processed per step by the weighted-price kernel; snapshots are zero padded to a multiple of it
+ */
+const int BOOK_SNAPSHOT_LANES = 4;
+
+/**
+ * Sums over the captured levels that the weighted prices are built from
+ */
+struct BookSums {
+    double ask_notional;
+    double ask_size;
+    double bid_notional;
+    double bid_size;
+};
+
+/**
+ * Contiguous copy of the top levels of an aggregate book, taken once per quote so that the signal
+ * is computed over flat arrays instead of through per-level virtual calls. Only levels present on
+ * both sides are captured, matching the original three-level calculation.
+ */
+struct BookSnapshot {
+    BookSnapshot(): depth(0), padded_depth(0) {}
+
+    void Capture(const MarketModels::IAggrOrderBook& book, int max_depth) {
+        int n = 0;
+        for (; n < max_depth; ++n) {
+            const MarketModels::IPriceLevel* ask = book.AskPriceLevelAtLevel(n);
+            const MarketModels::IPriceLevel* bid = book.BidPriceLevelAtLevel(n);
+            if (ask == NULL || bid == NULL) {
+                break;
+            }
+            ask_price[n] = ask->price();
+            ask_size[n] = ask->size();
+            bid_price[n] = bid->price();
+            bid_size[n] = bid->size();
+        }
+        Pad(n);
+    }
+
+    /**
+     * Sets the depth to the first n levels, already filled in, and zeroes the lanes after them
+     */
+    void Pad(int n) {
+        depth = n;
+        padded_depth = (n + BOOK_SNAPSHOT_LANES - 1) / BOOK_SNAPSHOT_LANES * BOOK_SNAPSHOT_LANES;
+        for (; n < padded_depth; ++n) {
+            ask_price[n] = ask_size[n] = bid_price[n] = bid_size[n] = 0;
+        }
+    }
+
+    /**
+     * Capture with the depth fixed at compile time. Always pads out to the padded width of Depth, so
+     * a kernel can sum a constant number of lanes whatever the book held.
+     */
+    template <int Depth>
+    void CaptureFixed(const MarketModels::IAggrOrderBook& book) {
+        static_assert(Depth > 0 && Depth <= BOOK_SNAPSHOT_MAX_DEPTH, "book depth out of range");
+        const int padded = (Depth + BOOK_SNAPSHOT_LANES - 1) / BOOK_SNAPSHOT_LANES * BOOK_SNAPSHOT_LANES;
+
+        Capture(book, Depth);
+        for (int n = padded_depth; n < padded; ++n) {
+            ask_price[n] = ask_size[n] = bid_price[n] = bid_size[n] = 0;
+        }
+        padded_depth = padded;
+    }
+
+    alignas(32) double ask_price[BOOK_SNAPSHOT_MAX_DEPTH];
+    alignas(32) double ask_size[BOOK_SNAPSHOT_MAX_DEPTH];
+    alignas(32) double bid_price[BOOK_SNAPSHOT_MAX_DEPTH];
+    alignas(32) double bid_size[BOOK_SNAPSHOT_MAX_DEPTH];
+    int depth;
+    int padded_depth;
+};
+
+/**
+ * Size-weighted notional and total size over the first padded_depth levels of the snapshot. Runs
+ * four levels per step with AVX, two with SSE2, and falls back to scalar code elsewhere. Inlined
+ * with a constant padded_depth the loop has a fixed trip count and unrolls completely.
+ */
+__attribute__((always_inline)) inline BookSums SumPaddedLevels(const BookSnapshot& book, int padded_depth) {
+    BookSums sums;
+
+#if defined(__AVX__)
+    __m256d ask_notional = _mm256_setzero_pd();
+    __m256d ask_size = _mm256_setzero_pd();
+    __m256d bid_notional = _mm256_setzero_pd();
+    __m256d bid_size = _mm256_setzero_pd();
+
+    for (int i = 0; i < padded_depth; i += 4) {
+        __m256d as = _mm256_load_pd(book.ask_size + i);
+        __m256d bs = _mm256_load_pd(book.bid_size + i);
+        ask_notional = _mm256_add_pd(ask_notional, _mm256_mul_pd(_mm256_load_pd(book.ask_price + i), as));
+        bid_notional = _mm256_add_pd(bid_notional, _mm256_mul_pd(_mm256_load_pd(book.bid_price + i), bs));
+        ask_size = _mm256_add_pd(ask_size, as);
+        bid_size = _mm256_add_pd(bid_size, bs);
+    }
+
+    // reduce [an0 an1 an2 an3] [as0 ...] pairwise so one store yields all four sums
+    __m256d ask_pair = _mm256_hadd_pd(ask_notional, ask_size);   // an0+an1, as0+as1, an2+an3, as2+as3
+    __m256d bid_pair = _mm256_hadd_pd(bid_notional, bid_size);
+    __m128d ask_total = _mm_add_pd(_mm256_castpd256_pd128(ask_pair), _mm256_extractf128_pd(ask_pair, 1));
+    __m128d bid_total = _mm_add_pd(_mm256_castpd256_pd128(bid_pair), _mm256_extractf128_pd(bid_pair, 1));
+    _mm_storel_pd(&sums.ask_notional, ask_total);
+    _mm_storeh_pd(&sums.ask_size, ask_total);
+    _mm_storel_pd(&sums.bid_notional, bid_total);
+    _mm_storeh_pd(&sums.bid_size, bid_total);
+#elif defined(__SSE2__)
+    __m128d ask_notional = _mm_setzero_pd();
+    __m128d ask_size = _mm_setzero_pd();
+    __m128d bid_notional = _mm_setzero_pd();
+    __m128d bid_size = _mm_setzero_pd();
+
+    for (int i = 0; i < padded_depth; i += 2) {
+        __m128d as = _mm_load_pd(book.ask_size + i);
+        __m128d bs = _mm_load_pd(book.bid_size + i);
+        ask_notional = _mm_add_pd(ask_notional, _mm_mul_pd(_mm_load_pd(book.ask_price + i), as));
+        bid_notional = _mm_add_pd(bid_notional, _mm_mul_pd(_mm_load_pd(book.bid_price + i), bs));
+        ask_size = _mm_add_pd(ask_size, as);
+        bid_size = _mm_add_pd(bid_size, bs);
+    }
+
+    // unpack so that lane 0 holds the low halves and lane 1 the high halves, then add them
+    __m128d ask_total = _mm_add_pd(_mm_unpacklo_pd(ask_notional, ask_size), _mm_unpackhi_pd(ask_notional, ask_size));
+    __m128d bid_total = _mm_add_pd(_mm_unpacklo_pd(bid_notional, bid_size), _mm_unpackhi_pd(bid_notional, bid_size));
+    _mm_storel_pd(&sums.ask_notional, ask_total);
+    _mm_storeh_pd(&sums.ask_size, ask_total);
+    _mm_storel_pd(&sums.bid_notional, bid_total);
+    _mm_storeh_pd(&sums.bid_size, bid_total);
+#else
+    sums.ask_notional = sums.ask_size = sums.bid_notional = sums.bid_size = 0;
+    for (int i = 0; i < padded_depth; ++i) {
+        sums.ask_notional += book.ask_price[i] * book.ask_size[i];
+        sums.ask_size += book.ask_size[i];
+        sums.bid_notional += book.bid_price[i] * book.bid_size[i];
+        sums.bid_size += book.bid_size[i];
+    }
+#endif
+
+    return sums;
+}
+
+/**
+ * Weighted sums over however many levels the snapshot captured
+ */
+inline BookSums SumBookLevels(const BookSnapshot& book) {
+    return SumPaddedLevels(book, book.padded_depth);
+}
+
+#endif
@@ -0,0 +1,207 @@
+#pragma once
+
+#ifndef _STRATEGY_STUDIO_LIB_EXAMPLES_SIGNAL_KERNEL_H_
+#define _STRATEGY_STUDIO_LIB_EXAMPLES_SIGNAL_KERNEL_H_
+
+#include "BookSnapshot.h"
+#include "SignedVolume.h"
+
+#include <math.h>
+#include <stddef.h>
+
+#include <vector>
+
+/**
+ * Signed value of one book: how far the size-weighted ask and bid sit from the last trade, each
+ * weighted by the opposite side's size
+ */
+inline double SignedBookValue(const BookSums& sums, double last_trade_price) {
+    double weighted_sell = sums.ask_notional / sums.ask_size;
+    double weighted_buyy = sums.bid_notional / sums.bid_size;
+    return fabs(weighted_sell - last_trade_price) * sums.bid_size - fabs(last_trade_price - weighted_buyy) * sums.ask_size;
+}
+
+/**
+ * The per-quote signal core of SignedVolumeTrade: captures the book, reduces it to a signed value
+ * and pushes that through the instrument's rolling window. One instance holds the windows of every
+ * instrument, addressed by the strategy's dense instrument index.
+ */
+class ISignalKernel {
+public:
+    virtual ~ISignalKernel() {}
+
+    /**
+     * Returns false without touching the window when either side of the book is empty
+     */
+    virtual bool OnQuote(int index, const MarketModels::IAggrOrderBook& book, double last_trade_price, double z_threshold, DesiredPositionSide* side) = 0;
+
+    /**
+     * Pushes the signed value of book sums kept elsewhere, e.g. by a BookFeatureEngine, through the
+     * instrument's window without looking at the book
+     */
+    virtual DesiredPositionSide OnBookSums(int index, const BookSums& sums, double last_trade_price, double z_threshold) = 0;
+
+    virtual bool FullyInitialized(int index) const = 0;
+    virtual void Reset() = 0;
+
+    /**
+     * Copies the instrument's window out for a warm-start snapshot; values needs room for the window
+     */
+    virtual RollingStatsState SaveWindow(int index, double* values) const = 0;
+    virtual void RestoreWindow(int index, const RollingStatsState& state, const double* values) = 0;
+
+    virtual const char* name() const = 0;
+};
+
+/**
+ * Book depth and window length as runtime values; handles every configuration. Each instrument's
+ * ring is allocated here, to the window, when the strategy builds its kernel at registration.
+ */
+class GenericSignalKernel : public ISignalKernel {
+public:
+    GenericSignalKernel(size_t num_instruments, int depth, int window):
+        m_signals(num_instruments, SignedVolume(window)),
+        m_depth(depth)
+    {
+    }
+
+    bool OnQuote(int index, const MarketModels::IAggrOrderBook& book, double last_trade_price, double z_threshold, DesiredPositionSide* side) {
+        m_snapshot.Capture(book, m_depth);
+        if (m_snapshot.depth == 0) {
+            return false;
+        }
+        *side = m_signals[index].Update(SignedBookValue(SumBookLevels(m_snapshot), last_trade_price), z_threshold);
+        return true;
+    }
+
+    DesiredPositionSide OnBookSums(int index, const BookSums& sums, double last_trade_price, double z_threshold) {
+        return m_signals[index].Update(SignedBookValue(sums, last_trade_price), z_threshold);
+    }
+
+    bool FullyInitialized(int index) const { return m_signals[index].FullyInitialized(); }
+
+    void Reset() {
+        for (size_t i = 0; i < m_signals.size(); ++i) {
+            m_signals[i].Reset();
+        }
+    }
+
+    RollingStatsState SaveWindow(int index, double* values) const {
+        m_signals[index].v_Stats.CopyValues(values);
+        return m_signals[index].v_Stats.state();
+    }
+
+    void RestoreWindow(int index, const RollingStatsState& state, const double* values) {
+        m_signals[index].v_Stats.Restore(state, values);
+    }
+
+    const char* name() const { return "generic"; }
+
+private:
+    std::vector<SignedVolume> m_signals;
+    BookSnapshot m_snapshot;
+    int m_depth;
+};
+
+/**
+ * Book depth and window length fixed at compile time. The book loops have constant trip counts and
+ * each instrument's ring holds exactly Window values inline instead of behind a pointer.
+ * Produces the same signal as the generic kernel for the same depth and window.
+ */
+template <int Depth, int Window>
+class FixedSignalKernel : public ISignalKernel {
+public:
+    static const int PADDED_DEPTH = (Depth + BOOK_SNAPSHOT_LANES - 1) / BOOK_SNAPSHOT_LANES * BOOK_SNAPSHOT_LANES;
+
+    explicit FixedSignalKernel(size_t num_instruments):
+        m_signals(num_instruments, BasicSignedVolume<Window>(Window))
+    {
+    }
+
+    bool OnQuote(int index, const MarketModels::IAggrOrderBook& book, double last_trade_price, double z_threshold, DesiredPositionSide* side) {
+        m_snapshot.template CaptureFixed<Depth>(book);
+        if (m_snapshot.depth == 0) {
+            return false;
+        }
+        *side = m_signals[index].Update(SignedBookValue(SumPaddedLevels(m_snapshot, PADDED_DEPTH), last_trade_price), z_threshold);
+        return true;
+    }
+
+    DesiredPositionSide OnBookSums(int index, const BookSums& sums, double last_trade_price, double z_threshold) {
+        return m_signals[index].Update(SignedBookValue(sums, last_trade_price), z_threshold);
+    }
+
+    bool FullyInitialized(int index) const { return m_signals[index].FullyInitialized(); }
+
+    void Reset() {
+        for (size_t i = 0; i < m_signals.size(); ++i) {
+            m_signals[i].Reset();
+        }
+    }
+
+    RollingStatsState SaveWindow(int index, double* values) const {
+        m_signals[index].v_Stats.CopyValues(values);
+        return m_signals[index].v_Stats.state();
+    }
+
+    void RestoreWindow(int index, const RollingStatsState& state, const double* values) {
+        m_signals[index].v_Stats.Restore(state, values);
+    }
+
+    const char* name() const { return "fixed"; }
+
+private:
+    std::vector<BasicSignedVolume<Window> > m_signals;
+    BookSnapshot m_snapshot;
+};
+
+template <int Depth, int Window>
+ISignalKernel* MakeFixedSignalKernel(size_t num_instruments) {
+    return new FixedSignalKernel<Depth, Window>(num_instruments);
+}
+
+struct SignalKernelSpecialization {
+    int depth;
+    int window;
+    ISignalKernel* (*make)(size_t num_instruments);
+};
+
+/**
+ * The precompiled depth and window combinations
+ */
+const SignalKernelSpecialization SIGNAL_KERNEL_SPECIALIZATIONS[] = {
+    {1, 20, &MakeFixedSignalKernel<1, 20>},
+    {1, 50, &MakeFixedSignalKernel<1, 50>},
+    {1, 100, &MakeFixedSignalKernel<1, 100>},
+    {1, 200, &MakeFixedSignalKernel<1, 200>},
+    {3, 20, &MakeFixedSignalKernel<3, 20>},
+    {3, 50, &MakeFixedSignalKernel<3, 50>},
+    {3, 100, &MakeFixedSignalKernel<3, 100>},
+    {3, 200, &MakeFixedSignalKernel<3, 200>},
+    {5, 20, &MakeFixedSignalKernel<5, 20>},
+    {5, 50, &MakeFixedSignalKernel<5, 50>},
+    {5, 100, &MakeFixedSignalKernel<5, 100>},
+    {5, 200, &MakeFixedSignalKernel<5, 200>},
+    {10, 20, &MakeFixedSignalKernel<10, 20>},
+    {10, 50, &MakeFixedSignalKernel<10, 50>},
+    {10, 100, &MakeFixedSignalKernel<10, 100>},
+    {10, 200, &MakeFixedSignalKernel<10, 200>},
+};
+
+/**
+ * The specialization for depth and window if one was compiled in and specialized is set, otherwise
+ * the generic kernel. The caller owns the result.
+ */
+inline ISignalKernel* CreateSignalKernel(size_t num_instruments, int depth, int window, bool specialized) {
+    if (specialized) {
+        for (size_t i = 0; i < sizeof(SIGNAL_KERNEL_SPECIALIZATIONS) / sizeof(SIGNAL_KERNEL_SPECIALIZATIONS[0]); ++i) {
+            const SignalKernelSpecialization& s = SIGNAL_KERNEL_SPECIALIZATIONS[i];
+            if (s.depth == depth && s.window == window) {
+                return s.make(num_instruments);
+            }
+        }
+    }
+    return new GenericSignalKernel(num_instruments, depth, window);
+}
+
+#endif
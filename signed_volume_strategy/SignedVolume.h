@@ -0,0 +1,72 @@
+#pragma once
+
+#ifndef _STRATEGY_STUDIO_LIB_EXAMPLES_SIGNED_VOLUME_H_
+#define _STRATEGY_STUDIO_LIB_EXAMPLES_SIGNED_VOLUME_H_
+
+#include "../common/RollingStats.h"
+
+/**
+ * Largest super_long_window_size accepted; longer windows are refused when the param is set.
+ * Each instrument's ring is only as long as the configured window.
+ */
+#ifndef SIGNED_VOLUME_WINDOW_CAPACITY
+    #define SIGNED_VOLUME_WINDOW_CAPACITY 4096
+#endif
+
+enum DesiredPositionSide {
+    DESIRED_POSITION_SIDE_SHORT=-1,
+    DESIRED_POSITION_SIDE_FLAT=0,
+    DESIRED_POSITION_SIDE_LONG=1
+};
+
+/**
+ * Signed-volume signal over a rolling window of at most Capacity values. The strategy's generic path
+ * uses ROLLING_STATS_DYNAMIC, which allocates each instrument's ring to the window when the kernel is
+ * built; specialized kernels instantiate it with Capacity equal to the window and keep it inline.
+ */
+template <int Capacity>
+class BasicSignedVolume {
+    public:
+        typedef RollingStats<Capacity> Stats;
+
+    public:
+        BasicSignedVolume(int super_long_window = 20) : v_Stats(super_long_window) {
+
+        }
+
+        void Reset() {
+            v_Stats.Reset();
+        }
+
+        /**
+         * Adds the latest signed value. With a zero threshold the side follows the sign of the value;
+         * otherwise it follows the value's z-score against the window, flat inside +/- z_threshold.
+         */
+        DesiredPositionSide Update(double val, double z_threshold = 0) {
+            v_Stats.Push(val);
+
+            double signal = (z_threshold > 0) ? v_Stats.zscore(val) : val;
+
+            if (signal > z_threshold) {
+                return DESIRED_POSITION_SIDE_LONG;
+            } else if (signal < -z_threshold) {
+                return DESIRED_POSITION_SIDE_SHORT;
+            }
+            return DESIRED_POSITION_SIDE_FLAT;
+        }
+
+        bool FullyInitialized() const { 
+            return (v_Stats.full()); 
+        }
+
+        double Mean() const { return v_Stats.mean(); }
+        double StdDev() const { return v_Stats.stddev(); }
+        double ZScore() const { return v_Stats.zscore(v_Stats.last()); }
+        double Ewma() const { return v_Stats.ewma(); }
+        
+        Stats v_Stats;
+};
+
+typedef BasicSignedVolume<ROLLING_STATS_DYNAMIC> SignedVolume;
+
+#endif
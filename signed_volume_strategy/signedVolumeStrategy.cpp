@@ -11,6 +11,8 @@
 #include <Utilities/utils.h>
 
 #include <math.h>
+#include <stdio.h>
+#include <limits>
 #include <vector>
 #include <iostream>
 #include <cassert>
@@ -23,16 +25,32 @@ using namespace std;
 
 SignedVolumeTrade::SignedVolumeTrade(StrategyID strategyID, const std::string& strategyName, const std::string& groupName):
     Strategy(strategyID, strategyName, groupName),
-    volume_map(),
-    m_instrument_order_id_map(),
-
-    v_signedVolume(0),
-    m_aggressiveness(0.01),
-    m_position_size(100),
-    m_debug_on(false),
-    m_super_long_window_size(20)
-
+    m_instrument_states(),
+    m_instrument_index(),
+    m_book_features(),
+    m_journal(),
+    m_latency(),
+    m_order_coalescer(),
+    m_bars(),
+    m_reprice_bucket(),
+    m_reprice_batch(),
+    m_warm_start(),
+    m_warm_start_values(),
+    m_journal_path(),
+    m_warm_start_path(),
+    m_last_snapshot_time(0),
+    m_warm_start_due(std::numeric_limits<int64_t>::max()),
+    m_risk_gate(),
+    m_config(),
+    m_super_long_window_size(20),
+    m_book_depth(3),
+    m_coalesce_orders(true),
+    m_specialized_kernels(true),
+    m_depth_features(false),
+    m_warm_start_seconds(60)
 {
+    m_risk_gate.set_limits(&m_config.get().risk_limits);
+    m_order_coalescer.Attach(this, &m_risk_gate);
     //this->set_enabled_pre_open_data_flag(true);
     //this->set_enabled_pre_open_trade_flag(true);
     //this->set_enabled_post_close_data_flag(true);
@@ -45,27 +63,86 @@ SignedVolumeTrade::~SignedVolumeTrade() {
 
 
 void SignedVolumeTrade::OnResetStrategyState() {
-    volume_map.clear();
-    m_instrument_order_id_map.clear();
-    m_instrument_map.clear();
-    v_signedVolume = 0;
-    m_price_map.clear();
-    m_size_map.clear();
+    for (InstrumentStatesIter it = m_instrument_states.begin(); it != m_instrument_states.end(); ++it) {
+        it->Reset();
+    }
+    if (m_signal_kernel) {
+        m_signal_kernel->Reset();
+    }
 }
 
 
 void SignedVolumeTrade::DefineStrategyParams() {
-    CreateStrategyParamArgs arg1("aggressiveness", STRATEGY_PARAM_TYPE_RUNTIME, VALUE_TYPE_DOUBLE, m_aggressiveness);
+    const SignedVolumeConfig& config = m_config.get();
+
+    CreateStrategyParamArgs arg1("aggressiveness", STRATEGY_PARAM_TYPE_RUNTIME, VALUE_TYPE_DOUBLE, config.aggressiveness);
     params().CreateParam(arg1);
 
-    CreateStrategyParamArgs arg2("position_size", STRATEGY_PARAM_TYPE_RUNTIME, VALUE_TYPE_INT, m_position_size);
+    CreateStrategyParamArgs arg2("position_size", STRATEGY_PARAM_TYPE_RUNTIME, VALUE_TYPE_INT, config.position_size);
     params().CreateParam(arg2);
 
     CreateStrategyParamArgs arg3("super_long_window_size", STRATEGY_PARAM_TYPE_STARTUP, VALUE_TYPE_INT, m_super_long_window_size);
     params().CreateParam(arg3);
     
-    CreateStrategyParamArgs arg4("debug", STRATEGY_PARAM_TYPE_RUNTIME, VALUE_TYPE_BOOL, m_debug_on);
+    CreateStrategyParamArgs arg4("debug", STRATEGY_PARAM_TYPE_RUNTIME, VALUE_TYPE_BOOL, config.debug_on);
     params().CreateParam(arg4);
+
+    CreateStrategyParamArgs arg5("book_depth", STRATEGY_PARAM_TYPE_STARTUP, VALUE_TYPE_INT, m_book_depth);
+    params().CreateParam(arg5);
+
+    // 0 trades on the sign of the signed value; above 0 only on a z-score beyond the threshold
+    CreateStrategyParamArgs arg6("z_threshold", STRATEGY_PARAM_TYPE_RUNTIME, VALUE_TYPE_DOUBLE, config.z_threshold);
+    params().CreateParam(arg6);
+
+    // empty, the default, disables the journal; instances sharing a path would share one file
+    CreateStrategyParamArgs arg7("journal_path", STRATEGY_PARAM_TYPE_STARTUP, VALUE_TYPE_STRING, m_journal_path);
+    params().CreateParam(arg7);
+
+    // false sends a fresh order on every trade instead of keeping one working order per instrument
+    CreateStrategyParamArgs arg8("coalesce_orders", STRATEGY_PARAM_TYPE_STARTUP, VALUE_TYPE_BOOL, m_coalesce_orders);
+    params().CreateParam(arg8);
+
+    // use a precompiled kernel for the book_depth/super_long_window_size pair when there is one
+    CreateStrategyParamArgs arg9("specialized_kernels", STRATEGY_PARAM_TYPE_STARTUP, VALUE_TYPE_BOOL, m_specialized_kernels);
+    params().CreateParam(arg9);
+
+    // pre-trade risk limits checked in front of every new order; 0 disables a limit
+    CreateStrategyParamArgs arg10("max_order_size", STRATEGY_PARAM_TYPE_RUNTIME, VALUE_TYPE_INT, config.risk_limits.max_order_size);
+    params().CreateParam(arg10);
+
+    CreateStrategyParamArgs arg11("max_instrument_notional", STRATEGY_PARAM_TYPE_RUNTIME, VALUE_TYPE_DOUBLE, config.risk_limits.max_instrument_notional);
+    params().CreateParam(arg11);
+
+    CreateStrategyParamArgs arg12("max_strategy_notional", STRATEGY_PARAM_TYPE_RUNTIME, VALUE_TYPE_DOUBLE, config.risk_limits.max_strategy_notional);
+    params().CreateParam(arg12);
+
+    CreateStrategyParamArgs arg13("max_orders_per_second", STRATEGY_PARAM_TYPE_RUNTIME, VALUE_TYPE_INT, config.risk_limits.max_orders_per_second);
+    params().CreateParam(arg13);
+
+    // keep each book's features current from depth deltas instead of re-reading the book every quote;
+    // tests/BookFeaturesReplayTest.cpp checks that it leaves the order actions unchanged. Off by default:
+    // bench/BookFeaturesBench.cpp has the mirror paying for itself only from about 5 levels, and book_depth is 3
+    CreateStrategyParamArgs arg14("depth_features", STRATEGY_PARAM_TYPE_STARTUP, VALUE_TYPE_BOOL, m_depth_features);
+    params().CreateParam(arg14);
+
+    // reprice an instrument's working orders to the new touch whenever its top of book moves
+    CreateStrategyParamArgs arg15("auto_reprice", STRATEGY_PARAM_TYPE_RUNTIME, VALUE_TYPE_BOOL, config.auto_reprice);
+    params().CreateParam(arg15);
+
+    // replaces per second, and the burst allowed above it, that repricing may send; 0 is unlimited
+    CreateStrategyParamArgs arg16("reprice_rate", STRATEGY_PARAM_TYPE_RUNTIME, VALUE_TYPE_DOUBLE, config.reprice_rate);
+    params().CreateParam(arg16);
+
+    CreateStrategyParamArgs arg17("reprice_burst", STRATEGY_PARAM_TYPE_RUNTIME, VALUE_TYPE_INT, config.reprice_burst);
+    params().CreateParam(arg17);
+
+    // snapshot the signal windows here every warm_start_seconds of event time, and start from the
+    // last snapshot instead of a cold window; empty disables warm start
+    CreateStrategyParamArgs arg18("warm_start_path", STRATEGY_PARAM_TYPE_STARTUP, VALUE_TYPE_STRING, m_warm_start_path);
+    params().CreateParam(arg18);
+
+    CreateStrategyParamArgs arg19("warm_start_seconds", STRATEGY_PARAM_TYPE_STARTUP, VALUE_TYPE_INT, m_warm_start_seconds);
+    params().CreateParam(arg19);
 }
 
 
@@ -75,200 +152,437 @@ void SignedVolumeTrade::DefineStrategyCommands() {
 
     StrategyCommand command2(2, "Cancel All Orders");
     commands().AddCommand(command2);
+
+    StrategyCommand command3(3, "Dump Latency Histograms");
+    commands().AddCommand(command3);
+
+    StrategyCommand command4(4, "Reset Latency Histograms");
+    commands().AddCommand(command4);
 }
 
 
 void SignedVolumeTrade::RegisterForStrategyEvents(StrategyEventRegister* eventRegister, DateType currDate) {    
+    if (!m_journal.is_open() && !m_journal_path.empty()) {
+        m_journal.Open(m_journal_path, "account.txt");
+    }
+
+    // the state table is sized once here so the slots never move while events are flowing
+    m_instrument_states.clear();
+    m_instrument_states.reserve(std::distance(symbols_begin(), symbols_end()));
+    m_instrument_index.Reset(m_instrument_states.capacity());
+
     for (SymbolSetConstIter it = symbols_begin(); it != symbols_end(); ++it) {
-        eventRegister->RegisterForBars(*it, BAR_TYPE_TIME, 600);
         EventInstrumentPair retVal = eventRegister->RegisterForMarketData(*it);
-        m_instrument_map[*it] = retVal.second;
+        if (retVal.second == NULL) {
+            continue;
+        }
+        m_instrument_index.Insert(retVal.second, static_cast<int>(m_instrument_states.size()));
+        m_instrument_states.push_back(InstrumentState(retVal.second));
+        m_instrument_states.back().order_slot.index = static_cast<int>(m_instrument_states.size()) - 1;
+    }
+    m_risk_gate.Reset(m_instrument_states.size());
+
+    // coalesced, a reprice pass finds at most one order per instrument; uncoalesced the batch grows to the
+    // most orders ever working at once and keeps that capacity
+    m_reprice_batch.clear();
+    m_reprice_batch.reserve(m_instrument_states.size());
+
+    // the snapshot bars come from the trades and quotes already subscribed, not a bar subscription
+    m_bars.ClearIntervals();
+    m_bars.AddInterval(SNAPSHOT_BAR_SECONDS * 1000000LL);
+    m_bars.Reset(m_instrument_states.size());
+
+    // startup params are final by now, so this is where the signal core is chosen
+    m_book_features.Reset(m_instrument_states.size(), m_book_depth);
+    m_signal_kernel.reset(CreateSignalKernel(m_instrument_states.size(), m_book_depth, m_super_long_window_size, m_specialized_kernels));
+    logger().LogToClient(LOGLEVEL_DEBUG, std::string("SignedVolumeTrade using the ") + m_signal_kernel->name() + " signal kernel");
+
+    // the snapshot buffer is sized for every instrument's full window, so taking one never allocates
+    m_warm_start.Close();
+    m_warm_start_due = std::numeric_limits<int64_t>::max();
+    if (!m_warm_start_path.empty()) {
+        RestoreWarmStart();
+        m_warm_start_values.assign(m_super_long_window_size, 0);
+        size_t entry_bytes = sizeof(WarmStartEntry) + sizeof(InstrumentWarmState) + sizeof(RollingStatsState) +
+            m_super_long_window_size * sizeof(double) + 8;
+        m_warm_start.Open(m_warm_start_path, GetType(), (m_instrument_states.size() + 1) * entry_bytes);
+        m_warm_start_due = 0;
     }
 }
 
 
 void SignedVolumeTrade::OnTrade(const TradeDataEventMsg& msg) {
-    const SymbolTag& symbol = msg.instrument().symbol();
-    m_price_map[symbol] = msg.trade().price();
-    SendOrder(&msg.instrument(), m_size_map[symbol]);
+    m_latency.Begin();
+    InstrumentState* state = FindState(&msg.instrument());
+    if (state == NULL) {
+        return;
+    }
+    m_latency.Signal();
+    const SignedVolumeConfig& config = m_config.get();
+    state->last_trade_price = msg.trade().price();
+    int64_t now = JournalTime(msg.event_time());
+    if (config.risk_limits.max_orders_per_second > 0) {
+        m_risk_gate.set_time(now);
+    }
+    MaybeSaveWarmStart(now);
+    m_bars.OnTrade(StateIndex(state), now, msg.trade().price(), msg.trade().size(),
+        [this](int, int, const LocalBar& bar) { OnSnapshotBar(bar); });
+    SendOrder(*state, state->desired_size, config);
 }
 
 
 void SignedVolumeTrade::OnQuote(const QuoteEventMsg& msg) {
-    const SymbolTag& symbol = msg.instrument().symbol();
-    const IAggrOrderBook& orderBook = m_instrument_map[symbol]->aggregate_order_book();
-
-    VolumeMapIterator iter = volume_map.find(&msg.instrument());
+    m_latency.Begin();
+    InstrumentState* state = FindState(&msg.instrument());
+    if (state == NULL) {
+        return;
+    }
+    const SignedVolumeConfig& config = m_config.get();
+    bool top_moved = (msg.quote().bid() != state->bid || msg.quote().ask() != state->ask);
+    state->bid = msg.quote().bid();
+    state->ask = msg.quote().ask();
+    int index = StateIndex(state);
+    int64_t now = JournalTime(msg.event_time());
+    m_bars.OnQuote(index, now, msg.quote().mid_price(),
+        [this](int, int, const LocalBar& bar) { OnSnapshotBar(bar); });
+    MaybeSaveWarmStart(now);
+
+    if (top_moved && config.auto_reprice) {
+        // only this instrument's orders can have gone stale, so only they are looked at
+        CollectReprices(state, config.aggressiveness);
+        SendReprices(config, now);
+    }
 
-    if (iter != volume_map.end()) {
-        v_signedVolume = &iter->second;
-    } else {
-        v_signedVolume = &volume_map.insert(make_pair(&msg.instrument(), SignedVolume(m_super_long_window_size))).first->second;
+    DesiredPositionSide side;
+    if (m_depth_features) {
+        // the book sums are already current, so the signal is a division and a window update
+        m_book_features.OnQuote(index, state->instrument->aggregate_order_book());
+        BookSums sums;
+        if (!m_book_features.sums(index, &sums)) {
+            return;
+        }
+        side = m_signal_kernel->OnBookSums(index, sums, state->last_trade_price, config.z_threshold);
+    } else if (!m_signal_kernel->OnQuote(index, state->instrument->aggregate_order_book(), state->last_trade_price, config.z_threshold, &side)) {
+        // one pass over the book into flat arrays, a SIMD reduction and a constant-time window update
+        return;
     }
+    m_latency.Signal();
 
-    double ask1 = 0;
-    double bid1 = 0;
+    if (m_signal_kernel->FullyInitialized(index)) {
+        state->desired_size = config.position_size * side;
+    }
+}
 
-    double ask2 = 0;
-    double bid2 = 0;
 
-    double ask3 = 0;
-    double bid3 = 0;
+void SignedVolumeTrade::OnDepth(const MarketDepthEventMsg& msg) {
+    if (!m_depth_features) {
+        return;
+    }
+    InstrumentState* state = FindState(&msg.instrument());
+    if (state == NULL) {
+        return;
+    }
+    m_book_features.OnDepth(StateIndex(state), state->instrument->aggregate_order_book(), msg.is_bid(), msg.update_type(),
+        msg.level(), msg.price(), msg.size());
+}
 
-    int ask_vol1 = 0;
-    int bid_vol1 = 0;
 
-    int ask_vol2 = 0;
-    int bid_vol2 = 0;
-    
-    int ask_vol3 = 0;
-    int bid_vol3 = 0;
+void SignedVolumeTrade::OnOrderUpdate(const OrderUpdateEventMsg& msg) {    
+	// std::cout << "OnOrderUpdate(): " << msg.update_time() << msg.name() << std::endl;
+    InstrumentState* state = FindState(msg.order().instrument());
+    if (state == NULL) {
+        return;
+    }
 
-    if (orderBook.AskPriceLevelAtLevel(0)!= NULL && orderBook.BidPriceLevelAtLevel(0)!= NULL) {
-        ask1 = orderBook.AskPriceLevelAtLevel(0)->price();
-        bid1 = orderBook.BidPriceLevelAtLevel(0)->price();
+    if (msg.fill_occurred()) {
+        m_risk_gate.OnFill(state->order_slot.index, msg.fill()->fill_size(), msg.fill()->fill_price());
+    }
+    if (m_config.get().risk_limits.max_orders_per_second > 0) {
+        m_risk_gate.set_time(JournalTime(msg.event_time()));
+    }
 
-        ask_vol1 = orderBook.AskPriceLevelAtLevel(0)->size();
-        bid_vol1 = orderBook.BidPriceLevelAtLevel(0)->size();
+    // settling the in-flight message may release the next one for the latest intent
+    m_latency.Begin();
+    unsigned long long sent = m_order_coalescer.counters().messages();
+    m_order_coalescer.OnOrderUpdate(state->order_slot, msg);
+    if (m_order_coalescer.counters().messages() != sent) {
+        m_latency.OrderSent();
     }
+}
 
-    if (orderBook.AskPriceLevelAtLevel(1)!= NULL && orderBook.BidPriceLevelAtLevel(1)!= NULL) {
-        ask2 = orderBook.AskPriceLevelAtLevel(1)->price();
-        bid2 = orderBook.BidPriceLevelAtLevel(1)->price();
 
-        ask_vol2 = orderBook.AskPriceLevelAtLevel(1)->size();
-        bid_vol2 = orderBook.BidPriceLevelAtLevel(1)->size();
+void SignedVolumeTrade::AdjustPortfolio(InstrumentState& state, int desired_position, double current_price, const SignedVolumeConfig& config) {
+    // the notional cap that used to be hardcoded here is now max_instrument_notional in the risk gate
+    int trade_size = desired_position;
+    if (trade_size != 0) {
+        SetOrderIntent(state, trade_size, state.OrderPrice(trade_size, config.aggressiveness));
     }
+}
 
-    if (orderBook.AskPriceLevelAtLevel(2)!= NULL && orderBook.BidPriceLevelAtLevel(2)!= NULL) {
-        ask3 = orderBook.AskPriceLevelAtLevel(2)->price();
-        bid3 = orderBook.BidPriceLevelAtLevel(2)->price();
 
-        ask_vol3 = orderBook.AskPriceLevelAtLevel(2)->size();
-        bid_vol3 = orderBook.BidPriceLevelAtLevel(2)->size();
+void SignedVolumeTrade::FlashSale(InstrumentState& state, int trade_size, const SignedVolumeConfig& config) {
+    // a market order; the touch price only feeds the risk check, so no aggressiveness is added
+    if (trade_size == 0) {
+        return;
     }
+    double price = state.OrderPrice(trade_size, 0.0);
 
-    double midway = m_price_map[symbol];
+    if (!PassesRiskChecks(state, trade_size, price, config)) {
+        return;
+    }
+    if (trade_actions()->SendNewOrder(state.market_orders.Patch(trade_size, price)) == TRADE_ACTION_RESULT_SUCCESSFUL) {
+        m_risk_gate.OnOrderSent();
+        m_latency.OrderSent();
+    }
+}
 
-    double weighted_sell = (ask1 * ask_vol1 + ask2 * ask_vol2 + ask3 * ask_vol3) / (ask_vol1 + ask_vol2 + ask_vol3);
-    double weighted_buyy = (bid1 * bid_vol1 + bid2 * bid_vol2 + bid3 * bid_vol3) / (bid_vol1 + bid_vol2 + bid_vol3);
-    
-    double signed_value = abs(weighted_sell - midway) * (bid_vol1 + bid_vol2 + bid_vol3) - abs(midway - weighted_buyy) * (ask_vol1 + ask_vol2 + ask_vol3);
-    DesiredPositionSide side = v_signedVolume->Update(signed_value);
 
-    if (v_signedVolume->FullyInitialized()) {
-        m_size_map[symbol] = m_position_size * side;
+void SignedVolumeTrade::SendOrder(InstrumentState& state, int trade_size, const SignedVolumeConfig& config) {
+    double price = state.OrderPrice(trade_size, config.aggressiveness);
+
+    if (m_coalesce_orders) {
+        SetOrderIntent(state, trade_size, price);
+        return;
+    }
+
+    // nothing to trade; the exchange would only reject a zero-size order
+    if (trade_size == 0) {
+        return;
+    }
+    if (!PassesRiskChecks(state, trade_size, price, config)) {
+        return;
+    }
+    // std::cout << "SendOrder(): about to send new order for " << trade_size << " at $" << price << std::endl;
+    if (trade_actions()->SendNewOrder(state.order_slot.order_template.Patch(trade_size, price)) == TRADE_ACTION_RESULT_SUCCESSFUL) {
+        m_risk_gate.OnOrderSent();
+        m_latency.OrderSent();
+        // std::cout << "SendOrder(): Sending new order successful!" << std::endl;
     }
 }
 
 
-void SignedVolumeTrade::OnOrderUpdate(const OrderUpdateEventMsg& msg) {    
-	// std::cout << "OnOrderUpdate(): " << msg.update_time() << msg.name() << std::endl;
-    if (msg.completes_order()) {
-		m_instrument_order_id_map[msg.order().instrument()] = 0;
-		// std::cout << "OnOrderUpdate(): order is complete; " << std::endl;
+bool SignedVolumeTrade::PassesRiskChecks(const InstrumentState& state, int trade_size, double price, const SignedVolumeConfig& config) {
+    RiskCheckResult result = m_risk_gate.Check(state.order_slot.index, trade_size, price);
+    if (result != RISK_CHECK_OK && config.debug_on) {
+        // formatted on the stack: refusals come in bursts, and the hot path does not allocate
+        char message[128];
+        snprintf(message, sizeof(message), "Order for %s refused: %s", state.instrument->symbol().c_str(), RiskCheckName(result));
+        logger().LogToClient(LOGLEVEL_DEBUG, message);
     }
+    return result == RISK_CHECK_OK;
 }
 
 
-void SignedVolumeTrade::AdjustPortfolio(const Instrument* instrument, int desired_position, double current_price) {
-    int trade_size = 0;
-    if (abs(desired_position + portfolio().position(instrument)) * current_price >= 500000){
-        trade_size = 0;
-    } else {
-        trade_size = desired_position;
-    }
-    if (trade_size != 0) {
-        OrderID order_id = m_instrument_order_id_map[instrument];
-        if (order_id == 0) {
-            SendOrder(instrument, trade_size);
-        } else {  
-            const Order* order = orders().find_working(order_id);
-            if (order && ((IsBuySide(order->order_side()) && trade_size < 0) || ((IsSellSide(order->order_side()) && trade_size > 0)))) {
-                trade_actions()->SendCancelOrder(order_id);
-            }
-        }
+bool SignedVolumeTrade::SetOrderIntent(InstrumentState& state, int trade_size, double price) {
+    // the coalescer sends at most one new, replace or cancel, and nothing when the intent is unchanged
+    unsigned long long sent = m_order_coalescer.counters().messages();
+    m_order_coalescer.SetIntent(state.order_slot, trade_size, price);
+    if (m_order_coalescer.counters().messages() == sent) {
+        return false;
     }
+    m_latency.OrderSent();
+    return true;
 }
 
 
-void SignedVolumeTrade::FlashSale(const Instrument* instrument, int trade_size) {
-    m_aggressiveness = 0.00;
-    double price = trade_size > 0 ? instrument->top_quote().bid() + m_aggressiveness : instrument->top_quote().ask() - m_aggressiveness;
+void SignedVolumeTrade::OnBar(const BarEventMsg& msg) {
+    // no server bars are subscribed; snapshot bars are built locally in m_bars
+}
 
-    OrderParams params(*instrument, 
-        abs(trade_size),
-        price, 
-        (instrument->type() == INSTRUMENT_TYPE_EQUITY) ? MARKET_CENTER_ID_NASDAQ : ((instrument->type() == INSTRUMENT_TYPE_OPTION) ? MARKET_CENTER_ID_CBOE_OPTIONS : MARKET_CENTER_ID_CME_GLOBEX),
-        (trade_size > 0) ? ORDER_SIDE_BUY : ORDER_SIDE_SELL,
-        ORDER_TIF_DAY,
-        ORDER_TYPE_MARKET);
 
-    if (trade_actions()->SendNewOrder(params) == TRADE_ACTION_RESULT_SUCCESSFUL) {
-        m_instrument_order_id_map[instrument] = params.order_id;
+void SignedVolumeTrade::OnMarketState(const MarketStateEventMsg& msg) {
+    // no later event will close the session's last bars, so the snapshot is taken here
+    m_bars.Flush([this](int, int, const LocalBar& bar) { OnSnapshotBar(bar); });
+    if (m_warm_start.is_open()) {
+        SaveWarmStart(JournalTime(msg.event_time()));
     }
 }
 
 
-void SignedVolumeTrade::SendOrder(const Instrument* instrument, int trade_size) {
-    m_aggressiveness = 0.01;
-    double price = trade_size > 0 ? instrument->top_quote().bid() + m_aggressiveness : instrument->top_quote().ask() - m_aggressiveness;
+void SignedVolumeTrade::OnSnapshotBar(const LocalBar& bar) {
+    // one portfolio snapshot per bar interval, taken on the first instrument's bar; the journal's
+    // writer thread formats it and refreshes account.txt, so nothing here blocks on I/O
+    int64_t bar_time = bar.close_time;
+    if (bar_time == m_last_snapshot_time) {
+        return;
+    }
+    m_last_snapshot_time = bar_time;
 
-    OrderParams params(*instrument, 
-        abs(trade_size),
-        price, 
-        (instrument->type() == INSTRUMENT_TYPE_EQUITY) ? MARKET_CENTER_ID_NASDAQ : ((instrument->type() == INSTRUMENT_TYPE_OPTION) ? MARKET_CENTER_ID_CBOE_OPTIONS : MARKET_CENTER_ID_CME_GLOBEX),
-        (trade_size > 0) ? ORDER_SIDE_BUY : ORDER_SIDE_SELL,
-        ORDER_TIF_DAY,
-        ORDER_TYPE_LIMIT);
+    m_journal.LogPnl(bar_time, portfolio().total_pnl());
+    for (InstrumentStatesConstIter it = m_instrument_states.begin(); it != m_instrument_states.end(); ++it) {
+        m_journal.LogPosition(bar_time, it->instrument->symbol(), portfolio().position(it->instrument));
+    }
+}
 
-    // std::cout << "SendOrder(): about to send new order for " << trade_size << " at $" << price << std::endl;
-    if (trade_actions()->SendNewOrder(params) == TRADE_ACTION_RESULT_SUCCESSFUL) {
-        m_instrument_order_id_map[instrument] = params.order_id;
-        // std::cout << "SendOrder(): Sending new order successful!" << std::endl;
+
+void SignedVolumeTrade::SaveWarmStart(int64_t now) {
+    // a copy of each window into the preallocated buffer; the writer thread does the checksum and the I/O
+    if (!m_warm_start.Begin(now)) {
+        return;
+    }
+    m_warm_start.BeginEntry("");
+    m_warm_start.Put(static_cast<int32_t>(m_book_depth));
+    for (size_t i = 0; i < m_instrument_states.size(); ++i) {
+        const InstrumentState& state = m_instrument_states[i];
+        InstrumentWarmState warm;
+        warm.bid = state.bid;
+        warm.ask = state.ask;
+        warm.last_trade_price = state.last_trade_price;
+        warm.desired_size = state.desired_size;
+        warm.reserved = 0;
+        RollingStatsState window = m_signal_kernel->SaveWindow(static_cast<int>(i), &m_warm_start_values[0]);
+        m_warm_start.BeginEntry(state.instrument->symbol());
+        m_warm_start.Put(warm);
+        m_warm_start.Put(window);
+        m_warm_start.PutArray(&m_warm_start_values[0], window.size);
     }
+    m_warm_start.Commit();
 }
 
 
-void SignedVolumeTrade::OnBar(const BarEventMsg& msg) {
-    std::cout<<"______________Porfolio Information snapshot every hour_______________________"<<std::endl;    
-    std::cout<< "Time "<<msg.bar_time()<<std::endl;
-    std::cout<<" PnL "<<portfolio().total_pnl()<<std::endl;
-    for (SymbolSetConstIter it = symbols_begin(); it != symbols_end(); ++it) {
-        std::cout<<"Symbol "<<*it <<"   Position "<<portfolio().position(m_instrument_map[*it])<<std::endl;
+void SignedVolumeTrade::RestoreWarmStart() {
+    WarmStartReader reader;
+    if (!reader.Open(m_warm_start_path, GetType())) {
+        return;
+    }
+    // windows of signed values taken at another book depth measure something else, so only the quotes are kept
+    WarmStartCursor cursor;
+    int32_t depth = 0;
+    bool windows = reader.Find("", &cursor) && cursor.Get(&depth) && depth == m_book_depth;
+
+    std::vector<double> values(SIGNED_VOLUME_WINDOW_CAPACITY);
+    int restored = 0;
+    for (size_t i = 0; i < m_instrument_states.size(); ++i) {
+        InstrumentState& state = m_instrument_states[i];
+        InstrumentWarmState warm;
+        if (!reader.Find(state.instrument->symbol(), &cursor) || !cursor.Get(&warm)) {
+            continue;
+        }
+        state.bid = warm.bid;
+        state.ask = warm.ask;
+        state.last_trade_price = warm.last_trade_price;
+        state.desired_size = warm.desired_size;
+        RollingStatsState window;
+        if (windows && cursor.Get(&window) && window.size >= 0 && window.size <= SIGNED_VOLUME_WINDOW_CAPACITY &&
+            cursor.GetArray(&values[0], window.size)) {
+            m_signal_kernel->RestoreWindow(static_cast<int>(i), window, &values[0]);
+        }
+        ++restored;
     }
 
-    std::stringstream ss;
-	ss << msg.bar_time();
-    std::ofstream outFile;
-    outFile.open("account.txt");
-    outFile << ss.str();
-    outFile << portfolio().total_pnl();
+    std::ostringstream ss;
+    ss << "SignedVolumeTrade warm start restored " << restored << " of " << m_instrument_states.size() << " instruments from "
+       << m_warm_start_path << (windows ? "" : " without their windows (book_depth changed)");
+    logger().LogToClient(LOGLEVEL_INFO, ss.str());
+}
+
+
+void SignedVolumeTrade::RepriceAll(const SignedVolumeConfig& config, int64_t now) {
+    size_t examined = CollectReprices(NULL, config.aggressiveness);
+    size_t stale = m_reprice_batch.size();
+    RepriceCounts counts = SendReprices(config, now);
+    if (config.debug_on) {
+        std::ostringstream ss;
+        ss << "Repriced " << counts.sent << " of " << examined << " repriceable orders; " << (examined - stale) << " already at their price, "
+           << counts.in_flight << " riding on a message in flight, " << counts.held_back << " held back by reprice_rate";
+        logger().LogToClient(LOGLEVEL_DEBUG, ss.str());
+    }
 }
 
 
-void SignedVolumeTrade::RepriceAll() {
+size_t SignedVolumeTrade::CollectReprices(const InstrumentState* only, double aggressiveness) {
+    // first pass: the target price of every working order off the cached top of book, keeping only
+    // the orders whose price would actually change
+    m_reprice_batch.clear();
+    size_t examined = 0;
+    if (only != NULL && m_coalesce_orders) {
+        // coalesced, an instrument works at most its slot's order, so there is nothing to scan
+        const OrderSlot& slot = only->order_slot;
+        if (slot.state != ORDER_SLOT_IDLE && slot.desired_quantity != 0) {
+            ++examined;
+            double target = only->OrderPrice(slot.desired_quantity, aggressiveness);
+            if (fabs(target - slot.desired_price) >= 1e-9) {
+                m_reprice_batch.push_back(RepriceTarget(NULL, const_cast<InstrumentState*>(only), target));
+            }
+        }
+        return examined;
+    }
+
     for (IOrderTracker::WorkingOrdersConstIter ordit = orders().working_orders_begin(); ordit != orders().working_orders_end(); ++ordit) {
-        Reprice(*ordit);
+        Order* order = *ordit;
+        InstrumentState* state = FindState(order->instrument());
+        if (state == NULL || (only != NULL && state != only) || order->order_type() != ORDER_TYPE_LIMIT) {
+            continue;
+        }
+        bool slot_order = (order->order_id() == state->order_slot.order_id);
+        if (slot_order && state->order_slot.desired_quantity == 0) {
+            // the slot is cancelling it
+            continue;
+        }
+        ++examined;
+        // the slot prices its order for the side it wants, which after a flip is not yet the working order's
+        int side = slot_order ? state->order_slot.desired_quantity : (IsBuySide(order->order_side()) ? 1 : -1);
+        double target = state->OrderPrice(side, aggressiveness);
+        double current = slot_order ? state->order_slot.desired_price : order->price();
+        if (fabs(target - current) < 1e-9) {
+            continue;
+        }
+        m_reprice_batch.push_back(RepriceTarget(slot_order ? NULL : order, state, target));
     }
+    return examined;
 }
 
 
-void SignedVolumeTrade::Reprice(Order* order) {
-    OrderParams params = order->params();
-    params.price = (order->order_side() == ORDER_SIDE_BUY) ? order->instrument()->top_quote().bid() + m_aggressiveness : order->instrument()->top_quote().ask() - m_aggressiveness;
-    trade_actions()->SendCancelReplaceOrder(order->order_id(), params);
+RepriceCounts SignedVolumeTrade::SendReprices(const SignedVolumeConfig& config, int64_t now) {
+    // second pass: one replace per stale order for as long as the token bucket allows; what it holds
+    // back stays stale until the next pass finds it again
+    RepriceCounts counts;
+    for (size_t i = 0; i < m_reprice_batch.size(); ++i) {
+        const RepriceTarget& target = m_reprice_batch[i];
+        OrderSlot& slot = target.state->order_slot;
+        if (target.order == NULL && slot.state != ORDER_SLOT_WORKING) {
+            // a message is already in flight for the slot; the new price rides on its follow-up
+            SetOrderIntent(*target.state, slot.desired_quantity, target.price);
+            ++counts.in_flight;
+            continue;
+        }
+        if (!m_reprice_bucket.TryTake(now, config.reprice_rate, config.reprice_burst)) {
+            counts.held_back = static_cast<int>(m_reprice_batch.size() - i);
+            break;
+        }
+        bool sent;
+        if (target.order == NULL) {
+            sent = SetOrderIntent(*target.state, slot.desired_quantity, target.price);
+        } else {
+            OrderParams params = target.order->params();
+            params.price = target.price;
+            sent = trade_actions()->SendCancelReplaceOrder(target.order->order_id(), params) == TRADE_ACTION_RESULT_SUCCESSFUL;
+        }
+        if (sent) {
+            ++counts.sent;
+        }
+    }
+    return counts;
 }
 
 
 void SignedVolumeTrade::OnStrategyCommand(const StrategyCommandEventMsg& msg) {
     switch (msg.command_id()) {
         case 1:
-            RepriceAll();
+            RepriceAll(m_config.get(), JournalTime(msg.event_time()));
             break;
         case 2:
             trade_actions()->SendCancelAll();
             break;
+        case 3: {
+            std::ostringstream ss;
+            m_latency.Dump(ss);
+            logger().LogToClient(LOGLEVEL_INFO, ss.str());
+            break;
+        }
+        case 4:
+            m_latency.Reset();
+            break;
         default:
             logger().LogToClient(LOGLEVEL_DEBUG, "Unknown strategy command received");
             break;
@@ -277,5 +591,80 @@ void SignedVolumeTrade::OnStrategyCommand(const StrategyCommandEventMsg& msg) {
 
 
 void SignedVolumeTrade::OnParamChanged(StrategyParam& param) {
-    
+    if (param.param_name() == "book_depth") {
+        if (!param.Get(&m_book_depth))
+            throw StrategyStudioException("Could not get book depth");
+        m_book_depth = max(1, min(m_book_depth, BOOK_SNAPSHOT_MAX_DEPTH));
+    } else if (param.param_name() == "super_long_window_size") {
+        if (!param.Get(&m_super_long_window_size))
+            throw StrategyStudioException("Could not get super long window size");
+        if (m_super_long_window_size < 1 || m_super_long_window_size > SIGNED_VOLUME_WINDOW_CAPACITY)
+            throw StrategyStudioException("super_long_window_size must be between 1 and " + std::to_string(SIGNED_VOLUME_WINDOW_CAPACITY));
+    } else if (param.param_name() == "journal_path") {
+        if (!param.Get(&m_journal_path))
+            throw StrategyStudioException("Could not get journal path");
+    } else if (param.param_name() == "coalesce_orders") {
+        if (!param.Get(&m_coalesce_orders))
+            throw StrategyStudioException("Could not get coalesce orders");
+    } else if (param.param_name() == "specialized_kernels") {
+        if (!param.Get(&m_specialized_kernels))
+            throw StrategyStudioException("Could not get specialized kernels");
+    } else if (param.param_name() == "depth_features") {
+        if (!param.Get(&m_depth_features))
+            throw StrategyStudioException("Could not get depth features");
+    } else if (param.param_name() == "warm_start_path") {
+        if (!param.Get(&m_warm_start_path))
+            throw StrategyStudioException("Could not get warm start path");
+    } else if (param.param_name() == "warm_start_seconds") {
+        if (!param.Get(&m_warm_start_seconds))
+            throw StrategyStudioException("Could not get warm start seconds");
+        m_warm_start_seconds = max(1, m_warm_start_seconds);
+    } else {
+        SetRuntimeParam(param);
+    }
+}
+
+
+void SignedVolumeTrade::SetRuntimeParam(StrategyParam& param) {
+    // edit a copy of the current config and publish it whole; callbacks never see a partial change
+    SignedVolumeConfig config = m_config.get();
+    if (param.param_name() == "aggressiveness") {
+        if (!param.Get(&config.aggressiveness))
+            throw StrategyStudioException("Could not get aggressiveness");
+    } else if (param.param_name() == "position_size") {
+        if (!param.Get(&config.position_size))
+            throw StrategyStudioException("Could not get position size");
+    } else if (param.param_name() == "debug") {
+        if (!param.Get(&config.debug_on))
+            throw StrategyStudioException("Could not get debug");
+    } else if (param.param_name() == "z_threshold") {
+        if (!param.Get(&config.z_threshold))
+            throw StrategyStudioException("Could not get z threshold");
+    } else if (param.param_name() == "max_order_size") {
+        if (!param.Get(&config.risk_limits.max_order_size))
+            throw StrategyStudioException("Could not get max order size");
+    } else if (param.param_name() == "max_instrument_notional") {
+        if (!param.Get(&config.risk_limits.max_instrument_notional))
+            throw StrategyStudioException("Could not get max instrument notional");
+    } else if (param.param_name() == "max_strategy_notional") {
+        if (!param.Get(&config.risk_limits.max_strategy_notional))
+            throw StrategyStudioException("Could not get max strategy notional");
+    } else if (param.param_name() == "max_orders_per_second") {
+        if (!param.Get(&config.risk_limits.max_orders_per_second))
+            throw StrategyStudioException("Could not get max orders per second");
+    } else if (param.param_name() == "auto_reprice") {
+        if (!param.Get(&config.auto_reprice))
+            throw StrategyStudioException("Could not get auto reprice");
+    } else if (param.param_name() == "reprice_rate") {
+        if (!param.Get(&config.reprice_rate))
+            throw StrategyStudioException("Could not get reprice rate");
+    } else if (param.param_name() == "reprice_burst") {
+        if (!param.Get(&config.reprice_burst))
+            throw StrategyStudioException("Could not get reprice burst");
+    } else {
+        return;
+    }
+    if (!m_config.Publish(config))
+        throw StrategyStudioException("Could not publish params from outside the strategy thread");
+    m_risk_gate.set_limits(&m_config.get().risk_limits);
 }
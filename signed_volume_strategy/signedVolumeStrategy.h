@@ -18,60 +18,143 @@
 #include <MarketModels/Instrument.h>
 #include <Utilities/ParseConfig.h>
 
+#include "BookFeatures.h"
+#include "SignalKernel.h"
+#include "../common/AsyncJournal.h"
+#include "../common/BarBuilder.h"
+#include "../common/ConfigSnapshot.h"
+#include "../common/InstrumentIndex.h"
+#include "../common/LatencyHistogram.h"
+#include "../common/OrderCoalescer.h"
+#include "../common/OrderTemplate.h"
+#include "../common/RiskGate.h"
+#include "../common/TokenBucket.h"
+#include "../common/WarmStart.h"
+
 #include <vector>
 #include <map>
+#include <memory>
 #include <iostream>
 
 using namespace RCM::StrategyStudio;
 
-enum DesiredPositionSide {
-    DESIRED_POSITION_SIDE_SHORT=-1,
-    DESIRED_POSITION_SIDE_FLAT=0,
-    DESIRED_POSITION_SIDE_LONG=1
+/**
+ * Interval of the locally built bars the portfolio snapshots are taken on
+ */
+const int SNAPSHOT_BAR_SECONDS = 600;
+
+/**
+ * Everything the strategy keeps per instrument, in one cache-line-aligned slot addressed by the
+ * index assigned in RegisterForStrategyEvents. The fields read on every event come first; the
+ * instrument's rolling window lives in the signal kernel under the same index. The order slot's
+ * limit template and market_orders are built here once, so sending only patches price and size.
+ */
+struct alignas(64) InstrumentState {
+    explicit InstrumentState(const Instrument* inst):
+        instrument(inst),
+        bid(0),
+        ask(0),
+        last_trade_price(0),
+        desired_size(0),
+        order_slot(),
+        market_orders(*inst, ORDER_TYPE_MARKET)
+    {
+        order_slot.order_template.Build(*inst, ORDER_TYPE_LIMIT);
+    }
+
+    void Reset() {
+        // bid and ask track the market rather than the strategy, so they survive a reset
+        order_slot.Reset();
+        last_trade_price = 0;
+        desired_size = 0;
+    }
+
+    /**
+     * The price an order of this size works at, off the last top quote this slot saw
+     */
+    double OrderPrice(int trade_size, double aggressiveness) const {
+        return trade_size > 0 ? bid + aggressiveness : ask - aggressiveness;
+    }
+
+    const Instrument* instrument;
+    double bid;
+    double ask;
+    double last_trade_price;
+    int desired_size;
+    OrderSlot order_slot;
+    OrderTemplate market_orders;
 };
 
-class SignedVolume {
-    public:
-        SignedVolume(int super_long_window = 20) : v_Window(super_long_window) {
 
-        }
+/**
+ * What a warm-start snapshot keeps of an instrument besides its signal window. Working orders are
+ * not kept: they do not outlive the strategy instance that sent them.
+ */
+struct InstrumentWarmState {
+    double bid;
+    double ask;
+    double last_trade_price;
+    int32_t desired_size;
+    int32_t reserved;
+};
 
-        void Reset() {
-            v_Window.clear();
-        }
 
-        DesiredPositionSide Update(double val) {
-            bool longer = false;
-            bool shorter = false;
+/**
+ * SignedVolumeTrade's runtime params, published as one snapshot by OnParamChanged. Each callback
+ * reads a single snapshot and hands it down, so every decision in it sees the same values.
+ */
+struct SignedVolumeConfig {
+    SignedVolumeConfig():
+        risk_limits(),
+        aggressiveness(0.01),
+        z_threshold(0),
+        reprice_rate(0),
+        position_size(100),
+        reprice_burst(10),
+        debug_on(false),
+        auto_reprice(false)
+    {
+        risk_limits.max_instrument_notional = 500000;
+    }
+
+    RiskLimits risk_limits;
+    double aggressiveness;      // how far inside the touch limit orders work
+    double z_threshold;
+    double reprice_rate;        // replaces per second of event time a reprice pass may send; 0 is unlimited
+    int position_size;
+    int reprice_burst;
+    bool debug_on;
+    bool auto_reprice;          // reprice an instrument's working orders whenever its top of book moves
+};
 
-            if (val > 0) {
-                longer = true;
-            } else if (val < 0) {
-                shorter = true;
-            }
+/**
+ * A working order a reprice pass will move, and where to
+ */
+struct RepriceTarget {
+    RepriceTarget(Order* o, InstrumentState* s, double p): order(o), state(s), price(p) {}
 
-            v_Window.push_back(val);
-        
-            if (longer) {
-                return DESIRED_POSITION_SIDE_LONG;
-            } else if (shorter){
-                return DESIRED_POSITION_SIDE_SHORT;
-            } 
-        }
+    Order* order;
+    InstrumentState* state;
+    double price;
+};
 
+/**
+ * What a reprice pass did with the stale orders it found
+ */
+struct RepriceCounts {
+    RepriceCounts(): sent(0), in_flight(0), held_back(0) {}
 
-        bool FullyInitialized() { 
-            return (v_Window.full()); 
-        }
-        
-        Analytics::ScalarRollingWindow<double> v_Window;
+    int sent;           // replaces actually sent
+    int in_flight;      // slots with a message already out; the new price rides on its follow-up
+    int held_back;      // left stale by reprice_rate until the next pass
 };
 
 
 class SignedVolumeTrade : public Strategy {
     public:
-        typedef boost::unordered_map<const Instrument*, SignedVolume> VolumeMap; 
-        typedef VolumeMap::iterator VolumeMapIterator;
+        typedef std::vector<InstrumentState> InstrumentStates;
+        typedef InstrumentStates::iterator InstrumentStatesIter;
+        typedef InstrumentStates::const_iterator InstrumentStatesConstIter;
 
     public:
         SignedVolumeTrade(StrategyID strategyID, const std::string& strategyName, const std::string& groupName);
@@ -106,7 +189,7 @@ class SignedVolumeTrade : public Strategy {
          * This event triggers whenever a order book message arrives. This will be the first thing that
          * triggers if an order book entry impacts the exchange's DirectQuote or Strategy Studio's TopQuote calculation.
          */ 
-        virtual void OnDepth(const MarketDepthEventMsg& msg){}
+        virtual void OnDepth(const MarketDepthEventMsg& msg);
 
         /**
          * This event triggers whenever a Bar interval completes for an instrument
@@ -116,7 +199,7 @@ class SignedVolumeTrade : public Strategy {
         /**
          * This event contains alerts about the state of the market
          */
-        virtual void OnMarketState(const MarketStateEventMsg& msg){}
+        virtual void OnMarketState(const MarketStateEventMsg& msg);
 
         /**
          * This event triggers whenever new information arrives about a strategy's orders
@@ -153,11 +236,36 @@ class SignedVolumeTrade : public Strategy {
         void OnParamChanged(StrategyParam& param);
 
     private: // Helper functions specific to this strategy
-        void AdjustPortfolio(const Instrument* instrument, int desired_position, double current_price);
-        void SendOrder(const Instrument* instrument, int trade_size);
-        void FlashSale(const Instrument* instrument, int trade_size);
-        void RepriceAll();
-        void Reprice(Order* order);
+        InstrumentState* FindState(const Instrument* instrument) {
+            int index = m_instrument_index.Find(instrument);
+            return (index >= 0) ? &m_instrument_states[index] : NULL;
+        }
+
+        int StateIndex(const InstrumentState* state) const {
+            return static_cast<int>(state - &m_instrument_states[0]);
+        }
+
+        void OnSnapshotBar(const LocalBar& bar);
+
+        void SetRuntimeParam(StrategyParam& param);
+
+        void AdjustPortfolio(InstrumentState& state, int desired_position, double current_price, const SignedVolumeConfig& config);
+        void SendOrder(InstrumentState& state, int trade_size, const SignedVolumeConfig& config);
+        bool SetOrderIntent(InstrumentState& state, int trade_size, double price);
+        bool PassesRiskChecks(const InstrumentState& state, int trade_size, double price, const SignedVolumeConfig& config);
+        void FlashSale(InstrumentState& state, int trade_size, const SignedVolumeConfig& config);
+        void RepriceAll(const SignedVolumeConfig& config, int64_t now);
+        size_t CollectReprices(const InstrumentState* only, double aggressiveness);
+        RepriceCounts SendReprices(const SignedVolumeConfig& config, int64_t now);
+        void SaveWarmStart(int64_t now);
+        void RestoreWarmStart();
+
+        void MaybeSaveWarmStart(int64_t now) {
+            if (now >= m_warm_start_due) {
+                m_warm_start_due = now + m_warm_start_seconds * 1000000LL;
+                SaveWarmStart(now);
+            }
+        }
 
     private: /* from Strategy */
         
@@ -174,18 +282,31 @@ class SignedVolumeTrade : public Strategy {
         virtual void DefineStrategyCommands();
 
     private:
-        boost::unordered_map<const Instrument*, SignedVolume> volume_map;
-        boost::unordered_map<const Instrument*, OrderID> m_instrument_order_id_map;
-        std::map<const SymbolTag, const Instrument*> m_instrument_map;
-        std::map<const SymbolTag, double> m_price_map;
-        std::map<const SymbolTag, int> m_size_map;
-        SignedVolume* v_signedVolume;
-
-        double m_max_notional;
-        double m_aggressiveness;
-        int m_position_size;
+        InstrumentStates m_instrument_states;
+        InstrumentIndex m_instrument_index;
+        std::unique_ptr<ISignalKernel> m_signal_kernel;
+        BookFeatureEngine m_book_features;
+        AsyncJournal m_journal;
+        LatencyTracker m_latency;
+        OrderCoalescer m_order_coalescer;
+        BarBuilder m_bars;
+        TokenBucket m_reprice_bucket;
+        std::vector<RepriceTarget> m_reprice_batch;
+        WarmStartWriter m_warm_start;
+        std::vector<double> m_warm_start_values;
+        std::string m_journal_path;
+        std::string m_warm_start_path;
+        int64_t m_last_snapshot_time;
+        int64_t m_warm_start_due;
+
+        RiskGate m_risk_gate;
+        ConfigSnapshot<SignedVolumeConfig> m_config;
         int m_super_long_window_size;
-        bool m_debug_on;
+        int m_book_depth;
+        bool m_coalesce_orders;
+        bool m_specialized_kernels;
+        bool m_depth_features;
+        int m_warm_start_seconds;
 };
 
 
@@ -0,0 +1,168 @@
+/**
+ * SignedVolumeTrade must take the same order actions with depth_features on as with it off: the mirrored book
+ * is an optimization, not a different signal.
+ *
+ * Builds a day of depth deltas that inserts, updates and deletes levels at random on three books, with sizes drawn
+ * from a few round lots so that books often balance and the signed value lands exactly on zero, where any rounding
+ * difference between the two ways of summing the book would flip the side. Prices are quoted in 1/128ths, finer
+ * than any fixed price grid the sums could be rounded to. Replays it once with depth_features off
+ * as the golden log and once with it on, at z_threshold 0, and diffs the order actions.
+ *
+ *   g++ -O2 -fPIC -shared -pthread -Ireplay/sdk signed_volume_strategy/signedVolumeStrategy.cpp -o libSignedVolumeTrade.so
+ *   g++ -O2 -std=c++17 -Ireplay/sdk tests/BookFeaturesReplayTest.cpp replay/ReplayHost.cpp replay/SimExchange.cpp \
+ *       replay/EventLog.cpp replay/AllocationCounter.cpp -o book_features_replay_test -ldl
+ *   ./book_features_replay_test ./libSignedVolumeTrade.so [events]
+ */
+
+#include "../bench/SyntheticTicks.h"
+#include "../replay/EventLog.h"
+#include "../replay/ReplayHost.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <exception>
+#include <iostream>
+#include <vector>
+
+using namespace Replay;
+
+namespace {
+
+const int NUM_SYMBOLS = 3;
+const int MAX_LEVELS = 14;
+const int TOUCHED_LEVELS = 6;
+const double TICKS_PER_UNIT = 128;
+
+struct Level {
+    int64_t ticks;  // 1/128ths
+    uint32_t size;
+};
+
+uint32_t RoundLot(uint64_t* rng) {
+    return 100 * (1 + SyntheticRandom(rng) % 3);
+}
+
+void AddDepth(TickStream* stream, int64_t now, uint32_t instrument, bool bid, uint8_t action, int level, const Level& entry) {
+    TickRecord record = TickRecord();
+    record.timestamp = now;
+    record.instrument = instrument;
+    record.type = TICK_TYPE_DEPTH;
+    record.side = bid ? TICK_SIDE_BID : TICK_SIDE_ASK;
+    record.action = action;
+    record.level = static_cast<uint8_t>(level);
+    record.price[0] = entry.ticks / TICKS_PER_UNIT;
+    record.size[0] = entry.size;
+    stream->records.push_back(record);
+}
+
+/**
+ * Books that stay crossed-free and sorted while levels come and go, with trades at the touch in between
+ */
+void GenerateBookDeltas(size_t num_events, TickStream* stream) {
+    uint64_t rng = 88172645463325252ULL;
+    std::vector<Level> books[NUM_SYMBOLS][2];   // [instrument][0 bid, 1 ask]
+    int64_t now = 1500000000LL * 1000000000LL + 14LL * 3600 * 1000000000LL;
+
+    for (int i = 0; i < NUM_SYMBOLS; ++i) {
+        char symbol[16];
+        snprintf(symbol, sizeof(symbol), "SYM%d", i);
+        stream->symbols.push_back(symbol);
+        for (int side = 0; side < 2; ++side) {
+            for (int level = 0; level < 8; ++level) {
+                Level entry = {10000 + 2000 * i + (side ? 1 + level : -1 - level), RoundLot(&rng)};
+                books[i][side].push_back(entry);
+                AddDepth(stream, now += 1000, i, side == 0, TICK_DEPTH_INSERT, level, entry);
+            }
+        }
+    }
+
+    while (stream->records.size() < num_events) {
+        now += 500 + static_cast<int64_t>(SyntheticRandom(&rng) % 20000);
+        uint32_t instrument = static_cast<uint32_t>(SyntheticRandom(&rng) % NUM_SYMBOLS);
+        unsigned kind = SyntheticRandom(&rng) % 20;
+        if (kind < 3) {
+            TickRecord record = TickRecord();
+            record.timestamp = now;
+            record.instrument = instrument;
+            record.type = TICK_TYPE_TRADE;
+            record.price[0] = books[instrument][SyntheticRandom(&rng) & 1][0].ticks / TICKS_PER_UNIT;
+            record.size[0] = 1 + SyntheticRandom(&rng) % 500;
+            stream->records.push_back(record);
+            continue;
+        }
+
+        int side = SyntheticRandom(&rng) & 1;
+        int64_t away = side ? 1 : -1;
+        std::vector<Level>& levels = books[instrument][side];
+        int touched = std::min(static_cast<int>(levels.size()), TOUCHED_LEVELS);
+        if (kind < 9 && levels.size() > 2) {
+            int level = static_cast<int>(SyntheticRandom(&rng) % touched);
+            levels.erase(levels.begin() + level);
+            AddDepth(stream, now, instrument, side == 0, TICK_DEPTH_DELETE, level, Level());
+        } else if (kind < 15 && levels.size() < MAX_LEVELS) {
+            int level = static_cast<int>(SyntheticRandom(&rng) % (touched + 1));
+            Level entry = {0, RoundLot(&rng)};
+            if (level == 0) {
+                // improve the touch only while the spread stays open
+                entry.ticks = levels[0].ticks - away;
+                if (entry.ticks == books[instrument][1 - side][0].ticks) {
+                    continue;
+                }
+            } else if (level == static_cast<int>(levels.size())) {
+                entry.ticks = levels.back().ticks + away;
+            } else if (llabs(levels[level].ticks - levels[level - 1].ticks) > 1) {
+                entry.ticks = levels[level - 1].ticks + away;
+            } else {
+                continue;
+            }
+            levels.insert(levels.begin() + level, entry);
+            AddDepth(stream, now, instrument, side == 0, TICK_DEPTH_INSERT, level, entry);
+        } else {
+            int level = static_cast<int>(SyntheticRandom(&rng) % touched);
+            levels[level].size = RoundLot(&rng);
+            AddDepth(stream, now, instrument, side == 0, TICK_DEPTH_UPDATE, level, levels[level]);
+        }
+    }
+}
+
+void RunReplay(const StrategyLibrary& library, const TickStream& stream, bool depth_features, EventRecorder* recorder) {
+    ReplayOptions options;
+    options.timing = false;
+    options.recorder = recorder;
+    options.date = TimeFromNanos(stream.records.front().timestamp).date();
+    options.params.push_back(std::make_pair(std::string("z_threshold"), std::string("0")));
+    options.params.push_back(std::make_pair(std::string("depth_features"), std::string(depth_features ? "true" : "false")));
+
+    ReplayHost host(library.Create(library.type(), 1, library.type(), "test"), stream.symbols, options);
+    host.Run(stream.records.data(), stream.records.data() + stream.records.size());
+    host.Finish();
+}
+
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: book_features_replay_test <libSignedVolumeTrade.so> [events]\n");
+        return 2;
+    }
+
+    try {
+        StrategyLibrary library(argv[1]);
+        TickStream stream;
+        GenerateBookDeltas((argc > 2) ? strtoull(argv[2], NULL, 10) : 400000, &stream);
+
+        EventRecorder golden;
+        EventRecorder current;
+        RunReplay(library, stream, false, &golden);
+        RunReplay(library, stream, true, &current);
+
+        size_t differences = DiffOrderActions(golden.log(), current.log(), std::cout, 10);
+        printf("%zu events, %zu order actions differ with depth_features on\n", stream.records.size(), differences);
+        return differences == 0 ? 0 : 1;
+    } catch (const std::exception& e) {
+        fprintf(stderr, "book_features_replay_test: %s\n", e.what());
+        return 1;
+    }
+}
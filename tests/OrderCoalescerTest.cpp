@@ -0,0 +1,320 @@
+/**
+ * Drives every OrderCoalescer state transition against the simulated exchange, with its fault mode supplying the
+ * replace rejects, cancel rejects and partial fills a clean replay never produces. Updates are delivered by hand
+ * after each action, as the host would after the callback returns.
+ *
+ *   g++ -O2 -std=c++17 -Ireplay/sdk tests/OrderCoalescerTest.cpp replay/SimExchange.cpp replay/AllocationCounter.cpp \
+ *       -o order_coalescer_test
+ *   ./order_coalescer_test
+ *
+ * Prints each failed check and exits 1 if there were any.
+ */
+
+#include "../common/OrderCoalescer.h"
+#include "../replay/SimExchange.h"
+
+#include <stdio.h>
+
+#include <vector>
+
+using namespace Replay;
+
+namespace {
+
+int g_failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            ++g_failures; \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        } \
+    } while (0)
+
+class TestStrategy : public Strategy {
+public:
+    TestStrategy(): Strategy(1, "OrderCoalescerTest", "test") {}
+
+    void RegisterForStrategyEvents(StrategyEventRegister*, DateType) {}
+};
+
+/**
+ * One instrument quoted 99.99 / 100.01, its slot and a coalescer wired to a simulated exchange
+ */
+struct Fixture {
+    Fixture(): instrument(SymbolTag("TEST")), exchange(strategy.orders(), strategy.portfolio()) {
+        strategy.Initialize(&exchange, SymbolSet(1, "TEST"));
+        instrument.mutable_top_quote().set(99.99, 500, 100.01, 500);
+        slot.index = 0;
+        slot.order_template.Build(instrument, ORDER_TYPE_LIMIT);
+        coalescer.Attach(&strategy);
+    }
+
+    /**
+     * Hands the oldest queued update to the coalescer and returns its type; the follow-up it sends
+     * stays queued
+     */
+    OrderUpdateType DeliverOne() {
+        SimExchange::PendingUpdate update;
+        if (!exchange.PopUpdate(&update)) {
+            return static_cast<OrderUpdateType>(-1);
+        }
+        coalescer.OnOrderUpdate(slot, OrderUpdateEventMsg(*update.order, update.type, update.fill, TimeFromNanos(0)));
+        return update.type;
+    }
+
+    /**
+     * Hands every queued update to the coalescer, follow-ups included, and returns their types in order
+     */
+    std::vector<OrderUpdateType> Deliver() {
+        std::vector<OrderUpdateType> types;
+        SimExchange::PendingUpdate update;
+        while (exchange.PopUpdate(&update)) {
+            types.push_back(update.type);
+            coalescer.OnOrderUpdate(slot, OrderUpdateEventMsg(*update.order, update.type, update.fill, TimeFromNanos(0)));
+        }
+        return types;
+    }
+
+    void SetFaults(unsigned reject_replace_every, unsigned reject_cancel_every, bool partial_fills) {
+        SimExchange::Faults faults;
+        faults.rejectReplaceEvery = reject_replace_every;
+        faults.rejectCancelEvery = reject_cancel_every;
+        faults.partialFills = partial_fills;
+        exchange.set_faults(faults);
+    }
+
+    /**
+     * A trade through the slot's price, which fills a resting buy below the touch
+     */
+    void TradeThrough(double price) {
+        exchange.OnTrade(&instrument, price);
+    }
+
+    TestStrategy strategy;
+    Instrument instrument;
+    SimExchange exchange;
+    OrderSlot slot;
+    OrderCoalescer coalescer;
+};
+
+/**
+ * IDLE -> PENDING_NEW -> WORKING, intents coalesced while the new order is in flight, then
+ * WORKING -> PENDING_REPLACE -> WORKING on the ack
+ */
+void TestNewAndReplace() {
+    Fixture f;
+    f.coalescer.SetIntent(f.slot, 0, 99.90);
+    CHECK(f.slot.state == ORDER_SLOT_IDLE);
+    CHECK(f.coalescer.counters().messages() == 0);
+
+    f.coalescer.SetIntent(f.slot, 100, 99.90);
+    CHECK(f.slot.state == ORDER_SLOT_PENDING_NEW);
+    CHECK(f.slot.working_quantity == 100);
+
+    // in flight: only the intent changes
+    f.coalescer.SetIntent(f.slot, 100, 99.95);
+    f.coalescer.SetIntent(f.slot, 100, 99.92);
+    CHECK(f.coalescer.counters().messages() == 1);
+
+    // the ack settles the new order and the follow-up replaces it to the latest intent
+    CHECK(f.DeliverOne() == ORDER_UPDATE_TYPE_NEW);
+    CHECK(f.slot.state == ORDER_SLOT_PENDING_REPLACE);
+    CHECK(f.coalescer.counters().replaces == 1);
+    CHECK(f.slot.working_price == 99.90);
+    CHECK(f.slot.pending_price == 99.92);
+
+    std::vector<OrderUpdateType> types = f.Deliver();
+    CHECK(types.size() == 1 && types[0] == ORDER_UPDATE_TYPE_MODIFY);
+    CHECK(f.slot.state == ORDER_SLOT_WORKING);
+    CHECK(f.slot.working_price == 99.92);
+    CHECK(f.slot.working_quantity == 100);
+
+    // an unchanged intent sends nothing
+    f.coalescer.SetIntent(f.slot, 100, 99.92);
+    CHECK(f.slot.state == ORDER_SLOT_WORKING);
+    CHECK(f.coalescer.counters().messages() == 2);
+}
+
+/**
+ * PENDING_REPLACE -> WORKING on a replace reject: the old price and size stand, nothing is resent,
+ * and the next changed intent replaces again
+ */
+void TestReplaceReject() {
+    Fixture f;
+    f.SetFaults(1, 0, false);
+    f.coalescer.SetIntent(f.slot, 100, 99.90);
+    f.Deliver();
+    CHECK(f.slot.state == ORDER_SLOT_WORKING);
+
+    f.coalescer.SetIntent(f.slot, 200, 99.95);
+    CHECK(f.slot.state == ORDER_SLOT_PENDING_REPLACE);
+    std::vector<OrderUpdateType> types = f.Deliver();
+    CHECK(types.size() == 1 && types[0] == ORDER_UPDATE_TYPE_REPLACE_REJECT);
+    CHECK(f.slot.state == ORDER_SLOT_WORKING);
+    CHECK(f.slot.working_quantity == 100);
+    CHECK(f.slot.working_price == 99.90);
+    CHECK(f.slot.desired_quantity == 100);
+    CHECK(f.slot.desired_price == 99.90);
+    CHECK(f.coalescer.counters().replaces == 1);
+
+    f.SetFaults(0, 0, false);
+    f.coalescer.SetIntent(f.slot, 200, 99.95);
+    CHECK(f.slot.state == ORDER_SLOT_PENDING_REPLACE);
+    f.Deliver();
+    CHECK(f.slot.state == ORDER_SLOT_WORKING);
+    CHECK(f.slot.working_quantity == 200);
+    CHECK(f.slot.working_price == 99.95);
+}
+
+/**
+ * WORKING -> PENDING_CANCEL -> WORKING on a cancel reject, with no retry from the reject, then
+ * PENDING_CANCEL -> IDLE once the next intent cancels again
+ */
+void TestCancelReject() {
+    Fixture f;
+    f.SetFaults(0, 1, false);
+    f.coalescer.SetIntent(f.slot, 100, 99.90);
+    f.Deliver();
+
+    f.coalescer.SetIntent(f.slot, 0, 99.90);
+    CHECK(f.slot.state == ORDER_SLOT_PENDING_CANCEL);
+    CHECK(f.coalescer.counters().cancels == 1);
+    std::vector<OrderUpdateType> types = f.Deliver();
+    CHECK(types.size() == 1 && types[0] == ORDER_UPDATE_TYPE_CANCEL_REJECT);
+    CHECK(f.slot.state == ORDER_SLOT_WORKING);
+    CHECK(f.coalescer.counters().cancels == 1);
+    CHECK(f.exchange.counters().cancels == 1);
+
+    f.SetFaults(0, 0, false);
+    f.coalescer.SetIntent(f.slot, 0, 99.90);
+    CHECK(f.slot.state == ORDER_SLOT_PENDING_CANCEL);
+    types = f.Deliver();
+    CHECK(types.size() == 1 && types[0] == ORDER_UPDATE_TYPE_CANCEL);
+    CHECK(f.slot.state == ORDER_SLOT_IDLE);
+    CHECK(f.slot.order_id == 0);
+}
+
+/**
+ * WORKING -> PENDING_CANCEL -> IDLE -> PENDING_NEW when the intent flips side
+ */
+void TestFlip() {
+    Fixture f;
+    f.coalescer.SetIntent(f.slot, 100, 99.90);
+    f.Deliver();
+
+    f.coalescer.SetIntent(f.slot, -100, 100.10);
+    CHECK(f.slot.state == ORDER_SLOT_PENDING_CANCEL);
+    CHECK(f.DeliverOne() == ORDER_UPDATE_TYPE_CANCEL);
+    CHECK(f.slot.state == ORDER_SLOT_PENDING_NEW);
+    CHECK(f.slot.working_quantity == -100);
+    CHECK(f.DeliverOne() == ORDER_UPDATE_TYPE_NEW);
+    CHECK(f.slot.state == ORDER_SLOT_WORKING);
+    CHECK(f.coalescer.counters().new_orders == 2);
+    CHECK(f.coalescer.counters().cancels == 1);
+}
+
+/**
+ * Partial fills keep the slot WORKING and use up the intent; the last fill takes it to IDLE. A
+ * partial fill while a replace is in flight comes off the pending size too.
+ */
+void TestPartialFills() {
+    Fixture f;
+    f.SetFaults(0, 0, true);
+    f.coalescer.SetIntent(f.slot, 100, 99.90);
+    f.Deliver();
+
+    f.TradeThrough(99.80);
+    std::vector<OrderUpdateType> types = f.Deliver();
+    CHECK(types.size() == 1 && types[0] == ORDER_UPDATE_TYPE_PARTIAL_FILL);
+    CHECK(f.slot.state == ORDER_SLOT_WORKING);
+    CHECK(f.slot.working_quantity == 50);
+    CHECK(f.slot.desired_quantity == 50);
+    CHECK(f.slot.filled_quantity == 50);
+
+    // a replace restates the total size, what already filled included
+    f.coalescer.SetIntent(f.slot, 50, 99.85);
+    CHECK(f.slot.state == ORDER_SLOT_PENDING_REPLACE);
+    f.slot.pending_quantity -= 0;
+    f.TradeThrough(99.80);
+    types = f.Deliver();
+    CHECK(types.size() == 2 && types[0] == ORDER_UPDATE_TYPE_MODIFY && types[1] == ORDER_UPDATE_TYPE_PARTIAL_FILL);
+    CHECK(f.slot.state == ORDER_SLOT_WORKING);
+    CHECK(f.slot.working_quantity == 25);
+    CHECK(f.slot.working_price == 99.85);
+
+    while (f.slot.state == ORDER_SLOT_WORKING && f.exchange.counters().fills < 16) {
+        f.TradeThrough(99.80);
+        f.Deliver();
+    }
+    CHECK(f.slot.state == ORDER_SLOT_IDLE);
+    CHECK(f.slot.desired_quantity == 0);
+    CHECK(f.strategy.portfolio().position(&f.instrument) == 100);
+}
+
+/**
+ * A fill that lands while the replace is still unacknowledged comes off the pending size as well
+ */
+void TestFillBeforeReplaceAck() {
+    Fixture f;
+    f.coalescer.SetIntent(f.slot, 100, 99.90);
+    f.Deliver();
+    f.coalescer.SetIntent(f.slot, 100, 99.95);
+    CHECK(f.slot.state == ORDER_SLOT_PENDING_REPLACE);
+
+    // the exchange's own updates come ack first, so deliver a fill ahead of it by hand
+    Order& order = *f.strategy.orders().working_orders_begin()[0];
+    f.coalescer.OnOrderUpdate(f.slot, OrderUpdateEventMsg(order, ORDER_UPDATE_TYPE_PARTIAL_FILL,
+        FillInfo(order.order_id(), 99.90, 40), TimeFromNanos(0)));
+    CHECK(f.slot.state == ORDER_SLOT_PENDING_REPLACE);
+    CHECK(f.slot.working_quantity == 60);
+    CHECK(f.slot.pending_quantity == 60);
+
+    f.Deliver();
+    CHECK(f.slot.state == ORDER_SLOT_WORKING);
+    CHECK(f.slot.working_quantity == 60);
+    CHECK(f.slot.working_price == 99.95);
+}
+
+/**
+ * PENDING_NEW -> IDLE on a fill on arrival and on a reject; a rejected order is not resubmitted
+ */
+void TestCompletions() {
+    Fixture f;
+    f.coalescer.SetIntent(f.slot, 100, 100.01);
+    CHECK(f.slot.state == ORDER_SLOT_PENDING_NEW);
+    std::vector<OrderUpdateType> types = f.Deliver();
+    CHECK(types.size() == 2 && types[1] == ORDER_UPDATE_TYPE_FILL);
+    CHECK(f.slot.state == ORDER_SLOT_IDLE);
+    CHECK(f.slot.desired_quantity == 0);
+
+    Fixture m;
+    m.slot.order_template.Build(m.instrument, ORDER_TYPE_MARKET);
+    m.instrument.mutable_top_quote().set(0, 0, 0, 0);
+    m.coalescer.SetIntent(m.slot, 100, 100.00);
+    CHECK(m.slot.state == ORDER_SLOT_PENDING_NEW);
+    types = m.Deliver();
+    CHECK(types.size() == 2 && types[1] == ORDER_UPDATE_TYPE_REJECT);
+    CHECK(m.slot.state == ORDER_SLOT_IDLE);
+    CHECK(m.slot.desired_quantity == 0);
+    CHECK(m.coalescer.counters().new_orders == 1);
+}
+
+}
+
+int main() {
+    TestNewAndReplace();
+    TestReplaceReject();
+    TestCancelReject();
+    TestFlip();
+    TestPartialFills();
+    TestFillBeforeReplaceAck();
+    TestCompletions();
+
+    if (g_failures != 0) {
+        printf("%d checks failed\n", g_failures);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}